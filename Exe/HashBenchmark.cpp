@@ -0,0 +1,122 @@
+//
+// Created by bruns on 16/10/2026.
+//
+
+#include <meta/StringKernels.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace core;
+
+/**
+ * Checks that StringKernels::hash gives the same result as the serial
+ * h*31+c loop on each path (AVX2, SSE2 and scalar), on random latin1 and
+ * utf16 inputs with random seeds, then prints the time taken to hash long
+ * strings by each path and by the serial loop.
+ *
+ * Usage: HashBenchmark [seed]
+ */
+
+static misc::__uint64_t state;
+
+static misc::__uint32_t nextRandom()
+{
+    // xorshift64*
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return (misc::__uint32_t) ((state * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+template<class T>
+static gint serialHash(T const *src, gint count, gint hash)
+{
+    misc::__uint32_t h = (misc::__uint32_t) hash;
+    for (gint i = 0; i < count; ++i) {
+        h = h * 31U + (misc::__uint32_t) (src[i] & (sizeof(T) == 1 ? 0xFF : 0xFFFF));
+    }
+    return (gint) h;
+}
+
+template<class T>
+static gbool check(StringKernels::Features features, gint iterations, gint maxLength)
+{
+    StringKernels::restrictFeatures(features);
+    std::vector< T > chars((misc::__memory_size_t) maxLength + 1);
+    for (gint n = 0; n < iterations; ++n) {
+        gint count = (gint) (nextRandom() % (misc::__uint32_t) (maxLength + 1));
+        gint offset = (gint) (nextRandom() & 1);
+        gint seed = (gint) nextRandom();
+        for (gint i = 0; i < count; ++i) {
+            chars[i] = (T) nextRandom();
+        }
+        T *src = chars.data() + (count < maxLength ? offset : 0);
+        gint expected = serialHash(src, count, seed);
+        gint actual = StringKernels::hash(src, count, seed);
+        if (actual != expected) {
+            printf("mismatch: path %d, %d bytes per char, length %d, seed %d: %d instead of %d\n",
+                   (int) features, (int) sizeof(T), count, seed, actual, expected);
+            return false;
+        }
+    }
+    return true;
+}
+
+template<class T>
+static double timeOf(StringKernels::Features features, T *src, gint count, gint repeat, gbool serial)
+{
+    StringKernels::restrictFeatures(features);
+    gint sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (gint n = 0; n < repeat; ++n) {
+        sink += serial ? serialHash(src, count, sink) : StringKernels::hash(src, count, sink);
+    }
+    auto end = std::chrono::steady_clock::now();
+    if (sink == 42) {
+        // keeps the result alive
+        printf(" ");
+    }
+    return std::chrono::duration< double, std::micro >(end - start).count() / repeat;
+}
+
+template<class T>
+static void benchmark(char const *name, gint count, gint repeat)
+{
+    std::vector< T > chars((misc::__memory_size_t) count);
+    for (gint i = 0; i < count; ++i) {
+        chars[i] = (T) nextRandom();
+    }
+    printf("%s, %d characters: serial %.2fus, scalar %.2fus, sse2 %.2fus, avx2 %.2fus\n", name, count,
+           timeOf(StringKernels::SCALAR, chars.data(), count, repeat, true),
+           timeOf(StringKernels::SCALAR, chars.data(), count, repeat, false),
+           timeOf(StringKernels::SSE2, chars.data(), count, repeat, false),
+           timeOf(StringKernels::AVX2, chars.data(), count, repeat, false));
+}
+
+int main(int argc, char *argv[])
+{
+    misc::__uint64_t seed = argc > 1 ? (misc::__uint64_t) strtoull(argv[1], nullptr, 10)
+                                     : (misc::__uint64_t) std::chrono::steady_clock::now().time_since_epoch().count();
+    state = seed != 0 ? seed : 1;
+    printf("seed %llu, detected path %d\n", (unsigned long long) seed, (int) StringKernels::features());
+
+    gbool ok = true;
+    StringKernels::Features const paths[] = {StringKernels::SCALAR, StringKernels::SSE2, StringKernels::AVX2};
+    for (StringKernels::Features features: paths) {
+        // the paths not supported by the processor fall back to the best supported one
+        ok = check< gbyte >(features, 100000, 300) && ok;
+        ok = check< gchar >(features, 100000, 300) && ok;
+        ok = check< gchar >(features, 1000, 70000) && ok;
+    }
+    printf(ok ? "all the paths are bit-identical to the serial loop\n" : "FAILED\n");
+
+    benchmark< gbyte >("latin1", 64, 1000000);
+    benchmark< gbyte >("latin1", 65536, 2000);
+    benchmark< gchar >("utf16", 64, 1000000);
+    benchmark< gchar >("utf16", 65536, 2000);
+    StringKernels::restrictFeatures(StringKernels::AVX2);
+    return ok ? 0 : 1;
+}
@@ -7,9 +7,12 @@
 #include <core/OutOfMemoryError.h>
 #include <core/misc/Precondition.h>
 #include <core/misc/Foreign.h>
+#include <core/misc/Allocator.h>
 
 namespace core
 {
+    using misc::Allocator;
+
     CharArray::CharArray(gint length)
     {
         if (length < 0) {
@@ -19,7 +22,7 @@ namespace core
             OutOfMemoryError("Array size exceed SOFT_MAX_LENGTH"_S).throws($ftrace(""_S));
         }
         if (length > 0) {
-            value = new gchar[length];
+            value = CORE_CAST(ARRAY, Allocator::allocateBlock(length * (glong) Class< gchar >::MEMORY_SIZE));
             count = length;
             for (int i = 0; i < length; ++i) {
                 value[i] = u'\0';
@@ -36,7 +39,7 @@ namespace core
             OutOfMemoryError("Array size exceed SOFT_MAX_LENGTH"_S).throws($ftrace(""_S));
         }
         if (length > 0) {
-            value = new gchar[length];
+            value = CORE_CAST(ARRAY, Allocator::allocateBlock(length * (glong) Class< gchar >::MEMORY_SIZE));
             count = length;
             for (int i = 0; i < length; ++i) {
                 value[i] = initialValue;
@@ -48,7 +51,7 @@ namespace core
     {
         gint length = array.length();
         if (length > 0) {
-            value = new gchar[length];
+            value = CORE_CAST(ARRAY, Allocator::allocateBlock(length * (glong) Class< gchar >::MEMORY_SIZE));
             count = length;
             for (int i = 0; i < length; ++i) {
                 value[i] = array.value[i];
@@ -116,8 +119,8 @@ namespace core
     CharArray::~CharArray()
     {
         if (count > 0) {
+            Allocator::releaseBlock(value, count * (glong) Class< gchar >::MEMORY_SIZE);
             count = 0;
-            delete[] value;
             value = null;
         }
     }
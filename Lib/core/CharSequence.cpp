@@ -3,6 +3,9 @@
 //
 
 #include "CharSequence.h"
+#include <core/String.h>
+#include <core/IndexOutOfBoundsException.h>
+#include <core/misc/Foreign.h>
 
 namespace core
 {
@@ -10,4 +13,26 @@ namespace core
     {
         return length() == 0;
     }
+
+    void CharSequence::getChars(gint startIndex, gint endIndex, gchar dst[]) const
+    {
+        if (startIndex < 0 || startIndex > endIndex || endIndex > length()) {
+            IndexOutOfBoundsException("Range ["_S + String::valueOf(startIndex) + ", "_S + String::valueOf(endIndex)
+                                      + ") out of bounds for length "_S + String::valueOf(length()))
+                    .throws($ftrace(""_S));
+        }
+        for (gint i = startIndex; i < endIndex; ++i) {
+            dst[i - startIndex] = charAt(i);
+        }
+    }
+
+    gbyte const *CharSequence::latin1Span() const
+    {
+        return null;
+    }
+
+    gchar const *CharSequence::utf16Span() const
+    {
+        return null;
+    }
 } // core
\ No newline at end of file
@@ -71,6 +71,60 @@ namespace core
          *                or if @c startIndex is greater than @c endIndex
          */
          virtual CharSequence &subSequence(gint startIndex, gint endIndex) const = 0;
+
+        /**
+         * Copies the characters of the specified range of this sequence to the
+         * given buffer, that must hold @c endIndex-startIndex characters.
+         * The default implementation calls @c charAt for each character, the
+         * sequences that have a storage copy the characters by blocks.
+         *
+         * @param startIndex   the start index, inclusive
+         * @param endIndex     the end index, exclusive
+         * @param dst          the buffer receiving the characters
+         *
+         * @throws  IndexOutOfBoundsException if @c startIndex or @c endIndex are negative,
+         *                if @c endIndex is greater than @c length(),
+         *                or if @c startIndex is greater than @c endIndex
+         */
+        virtual void getChars(gint startIndex, gint endIndex, gchar dst[]) const;
+
+        /**
+         * Returns the address of the characters of this sequence when they are
+         * stored contiguously as latin1 bytes, or @c null otherwise. The character
+         * at index @a k is at @c latin1Span()[k]. The address is only valid until
+         * the next modification of this sequence.
+         *
+         * @note The default implementation returns @c null.
+         */
+        virtual gbyte const *latin1Span() const;
+
+        /**
+         * Returns the address of the characters of this sequence when they are
+         * stored contiguously as utf16 characters, or @c null otherwise.
+         *
+         * @note The default implementation returns @c null.
+         * @see latin1Span()
+         */
+        virtual gchar const *utf16Span() const;
+
+        /**
+         * Returns the character at the given index of the given sequence, read from
+         * the given span when one of them is not @c null (the spans returned by
+         * @c latin1Span and @c utf16Span, or a copy obtained with @c getChars),
+         * or with @c charAt otherwise. The parsers use it to avoid a virtual call
+         * per character.
+         *
+         * @param s the sequence
+         * @param latin1 the latin1 span of the sequence, or @c null
+         * @param utf16 the utf16 span of the sequence, or @c null
+         * @param index the index of the character on the span, or on the sequence
+         *          if the two spans are @c null
+         */
+        static gchar spanCharAt(CharSequence const &s, gbyte const *latin1, gchar const *utf16, gint index)
+        {
+            return latin1 != null ? (gchar) (latin1[index] & 0xFF)
+                                  : utf16 != null ? utf16[index] : s.charAt(index);
+        }
     };
 } // core
 
@@ -54,7 +54,7 @@ namespace core
 
     String Character::toString(gchar c)
     {
-        return String(CharArray::of(c));
+        return String::valueOf(c);
     }
 
     String Character::toString(gint codePoint)
@@ -8,9 +8,12 @@
 #include <core/OutOfMemoryError.h>
 #include <core/misc/Precondition.h>
 #include <core/misc/Foreign.h>
+#include <core/misc/Allocator.h>
 
 namespace core
 {
+    using misc::Allocator;
+
     DoubleArray::DoubleArray(gint length)
     {
         if (length < 0) {
@@ -20,7 +23,7 @@ namespace core
             OutOfMemoryError("Array size exceed SOFT_MAX_LENGTH"_S).throws($ftrace(""_S));
         }
         if (length > 0) {
-            value = new gdouble[length];
+            value = CORE_CAST(ARRAY, Allocator::allocateBlock(length * (glong) Class< gdouble >::MEMORY_SIZE));
             count = length;
             for (int i = 0; i < length; ++i) {
                 value[i] = .0;
@@ -37,7 +40,7 @@ namespace core
             OutOfMemoryError("Array size exceed SOFT_MAX_LENGTH"_S).throws($ftrace(""_S));
         }
         if (length > 0) {
-            value = new gdouble[length];
+            value = CORE_CAST(ARRAY, Allocator::allocateBlock(length * (glong) Class< gdouble >::MEMORY_SIZE));
             count = length;
             for (int i = 0; i < length; ++i) {
                 value[i] = initialValue;
@@ -49,7 +52,7 @@ namespace core
     {
         gint length = array.length();
         if (length > 0) {
-            value = new gdouble[length];
+            value = CORE_CAST(ARRAY, Allocator::allocateBlock(length * (glong) Class< gdouble >::MEMORY_SIZE));
             count = length;
             for (int i = 0; i < length; ++i) {
                 value[i] = array.value[i];
@@ -117,8 +120,8 @@ namespace core
     DoubleArray::~DoubleArray()
     {
         if (count > 0) {
+            Allocator::releaseBlock(value, count * (glong) Class< gdouble >::MEMORY_SIZE);
             count = 0;
-            delete[] value;
             value = null;
         }
     }
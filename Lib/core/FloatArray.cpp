@@ -9,9 +9,12 @@
 #include <core/OutOfMemoryError.h>
 #include <core/misc/Precondition.h>
 #include <core/misc/Foreign.h>
+#include <core/misc/Allocator.h>
 
 namespace core
 {
+    using misc::Allocator;
+
     FloatArray::FloatArray(gint length)
     {
         if (length < 0) {
@@ -21,7 +24,7 @@ namespace core
             OutOfMemoryError("Array size exceed SOFT_MAX_LENGTH"_S).throws($ftrace(""_S));
         }
         if (length > 0) {
-            value = new gfloat[length];
+            value = CORE_CAST(ARRAY, Allocator::allocateBlock(length * (glong) Class< gfloat >::MEMORY_SIZE));
             count = length;
             for (int i = 0; i < length; ++i) {
                 value[i] = .0F;
@@ -38,7 +41,7 @@ namespace core
             OutOfMemoryError("Array size exceed SOFT_MAX_LENGTH"_S).throws($ftrace(""_S));
         }
         if (length > 0) {
-            value = new gfloat[length];
+            value = CORE_CAST(ARRAY, Allocator::allocateBlock(length * (glong) Class< gfloat >::MEMORY_SIZE));
             count = length;
             for (int i = 0; i < length; ++i) {
                 value[i] = initialValue;
@@ -50,7 +53,7 @@ namespace core
     {
         gint length = array.length();
         if (length > 0) {
-            value = new gfloat[length];
+            value = CORE_CAST(ARRAY, Allocator::allocateBlock(length * (glong) Class< gfloat >::MEMORY_SIZE));
             count = length;
             for (int i = 0; i < length; ++i) {
                 value[i] = array.value[i];
@@ -118,8 +121,8 @@ namespace core
     FloatArray::~FloatArray()
     {
         if (count > 0) {
+            Allocator::releaseBlock(value, count * (glong) Class< gfloat >::MEMORY_SIZE);
             count = 0;
-            delete[] value;
             value = null;
         }
     }
@@ -7,9 +7,12 @@
 #include <core/OutOfMemoryError.h>
 #include <core/misc/Precondition.h>
 #include <core/misc/Foreign.h>
+#include <core/misc/Allocator.h>
 
 namespace core
 {
+    using misc::Allocator;
+
     IntArray::IntArray(gint length)
     {
         if (length < 0) {
@@ -19,7 +22,7 @@ namespace core
             OutOfMemoryError("Array size exceed SOFT_MAX_LENGTH"_S).throws($ftrace(""_S));
         }
         if (length > 0) {
-            value = new gint[length];
+            value = CORE_CAST(ARRAY, Allocator::allocateBlock(length * (glong) Class< gint >::MEMORY_SIZE));
             count = length;
             for (int i = 0; i < length; ++i) {
                 value[i] = 0;
@@ -37,7 +40,7 @@ namespace core
             OutOfMemoryError("Array size exceed SOFT_MAX_LENGTH"_S).throws($ftrace(""_S));
         }
         if (length > 0) {
-            value = new gint[length];
+            value = CORE_CAST(ARRAY, Allocator::allocateBlock(length * (glong) Class< gint >::MEMORY_SIZE));
             count = length;
             for (int i = 0; i < length; ++i) {
                 value[i] = initialValue;
@@ -49,7 +52,7 @@ namespace core
     {
         gint length = array.length();
         if (length > 0) {
-            value = new gint[length];
+            value = CORE_CAST(ARRAY, Allocator::allocateBlock(length * (glong) Class< gint >::MEMORY_SIZE));
             count = length;
             for (int i = 0; i < length; ++i) {
                 value[i] = array.value[i];
@@ -117,8 +120,8 @@ namespace core
     IntArray::~IntArray()
     {
         if (count > 0) {
+            Allocator::releaseBlock(value, count * (glong) Class< gint >::MEMORY_SIZE);
             count = 0;
-            delete[] value;
             value = null;
         }
     }
@@ -329,11 +332,11 @@ namespace core
         if(this != &array) {
             gint count1 = length();
             gint count2 = array.length();
-            ARRAY a = new gint [count2];
+            ARRAY a = CORE_CAST(ARRAY, Allocator::allocateBlock(count2 * (glong) Class< gint >::MEMORY_SIZE));
             for (int i = 0; i < count2; ++i) {
                 a[i] = array.value[i];
             }
-            delete [] value;
+            Allocator::releaseBlock(value, count1 * (glong) Class< gint >::MEMORY_SIZE);
             value = a;
             count = count2;
         }
@@ -346,7 +349,7 @@ namespace core
             ARRAY a = array.value;
             gint c = array.count;
             array.value = value;
-            array.count = c;
+            array.count = count;
 
             value = a;
             count = c;
@@ -197,12 +197,31 @@ GetChars:
             NumberFormatException($errorTooHighRadix(radix)).throws($trace(""_S));
         }
 
+        if (beginIndex < 0 || beginIndex > endIndex || endIndex > s.length()) {
+            IndexOutOfBoundsException("Range index ["_S
+                                      + String::valueOf(beginIndex) + ", "_S
+                                      + String::valueOf(endIndex) + " out of bounds for length "_S
+                                      + String::valueOf(s.length())).throws($ftrace(""_S));
+        }
+
+        // The characters are read from the storage of the sequence, or from a copy
+        // of the range when it is short, instead of a virtual call per character.
+        gbyte const *latin1 = s.latin1Span();
+        gchar const *utf16 = s.utf16Span();
+        gchar buffer[64];
+        gint base = 0;
+        if (latin1 == null && utf16 == null && endIndex - beginIndex <= 64) {
+            s.getChars(beginIndex, endIndex, buffer);
+            utf16 = buffer;
+            base = beginIndex;
+        }
+
         gbool negative = false;
         gint i = beginIndex;
         gint limit = -Integer::MAX_VALUE;
 
         if (i < endIndex) {
-            gchar firstChar = s.charAt(i);
+            gchar firstChar = CharSequence::spanCharAt(s, latin1, utf16, i - base);
             if (firstChar < '0') { // Possible leading "+" or "-"
                 if (firstChar == '-') {
                     negative = true;
@@ -220,7 +239,7 @@ GetChars:
             gint result = 0;
             while (i < endIndex) {
                 // Accumulating negatively avoids surprises near MAX_VALUE
-                gint digit = Character::digit(s.charAt(i), radix);
+                gint digit = Character::digit(CharSequence::spanCharAt(s, latin1, utf16, i - base), radix);
                 if (digit < 0 || result < multmin) {
                     NumberFormatException($errorSequence(beginIndex, endIndex, i, s)).throws($ftrace(""_S));
                 }
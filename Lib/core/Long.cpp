@@ -6,6 +6,7 @@
 #include <core/Integer.h>
 #include <core/String.h>
 #include <core/NumberFormatException.h>
+#include <core/IndexOutOfBoundsException.h>
 #include <core/Character.h>
 #include <core/misc/Foreign.h>
 #include <core/Math.h>
@@ -259,12 +260,31 @@ CopyChars:
             NumberFormatException($errorTooHighRadix(radix)).throws($ftrace(""_S));
         }
 
+        if (beginIndex < 0 || beginIndex > endIndex || endIndex > s.length()) {
+            IndexOutOfBoundsException("Range index ["_S
+                                      + String::valueOf(beginIndex) + ", "_S
+                                      + String::valueOf(endIndex) + " out of bounds for length "_S
+                                      + String::valueOf(s.length())).throws($ftrace(""_S));
+        }
+
+        // The characters are read from the storage of the sequence, or from a copy
+        // of the range when it is short, instead of a virtual call per character.
+        gbyte const *latin1 = s.latin1Span();
+        gchar const *utf16 = s.utf16Span();
+        gchar buffer[64];
+        gint base = 0;
+        if (latin1 == null && utf16 == null && endIndex - beginIndex <= 64) {
+            s.getChars(beginIndex, endIndex, buffer);
+            utf16 = buffer;
+            base = beginIndex;
+        }
+
         gbool negative = false;
         gint i = beginIndex;
         glong limit = -Long::MAX_VALUE;
 
         if (i < endIndex) {
-            gchar firstChar = s.charAt(i);
+            gchar firstChar = CharSequence::spanCharAt(s, latin1, utf16, i - base);
             if (firstChar < '0') { // Possible leading "+" or "-"
                 if (firstChar == '-') {
                     negative = true;
@@ -282,7 +302,7 @@ CopyChars:
             glong result = 0;
             while (i < endIndex) {
                 // Accumulating negatively avoids surprises near MAX_VALUE
-                gint digit = Character::digit(s.charAt(i), radix);
+                gint digit = Character::digit(CharSequence::spanCharAt(s, latin1, utf16, i - base), radix);
                 if (digit < 0 || result < multmin) {
                     NumberFormatException($errorSequence(beginIndex, endIndex, i, s)).throws($ftrace(""_S));
                 }
@@ -0,0 +1,293 @@
+//
+// Created by bruns on 24/06/2024.
+//
+
+#include <core/SegmentedXString.h>
+#include <meta/StringUtils.h>
+#include <meta/StringKernels.h>
+#include <core/Math.h>
+#include <core/Integer.h>
+#include <core/IllegalArgumentException.h>
+#include <core/IndexOutOfBoundsException.h>
+#include <core/OutOfMemoryError.h>
+#include <core/misc/Foreign.h>
+
+namespace core
+{
+    SegmentedXString::SegmentedXString() : SegmentedXString(SEGMENT_LENGTH)
+    {
+    }
+
+    SegmentedXString::SegmentedXString(gint segmentLength)
+    {
+        if (segmentLength < 0) {
+            IllegalArgumentException("Negative segment length."_S).throws($ftrace(""_S));
+        }
+        SegmentedXString::segmentLength = Math::max(segmentLength, 256);
+    }
+
+    SegmentedXString::~SegmentedXString()
+    {
+        release();
+    }
+
+    void SegmentedXString::release()
+    {
+        delete[] segments;
+        segments = null;
+        size = 0;
+        limit = 0;
+        count = 0;
+    }
+
+    gint SegmentedXString::length() const
+    {
+        return count;
+    }
+
+    gchar SegmentedXString::charAt(gint index) const
+    {
+        if (index < 0 || index >= count) {
+            IndexOutOfBoundsException("Index "_S + String::valueOf(index) + " out of bounds for length "_S
+                                      + String::valueOf(count)).throws($ftrace(""_S));
+        }
+        String const &segment = segments[index / segmentLength];
+        index %= segmentLength;
+        return segment.coding() == String::LATIN1
+               ? StringUtils::readLatin1CharAt(segment.value, index)
+               : StringUtils::readUTF16CharAt(segment.value, index);
+    }
+
+    String SegmentedXString::subString(gint start, gint end) const
+    {
+        if (start < 0 || start > end || end > count) {
+            IndexOutOfBoundsException("Range ["_S + String::valueOf(start) + ", "_S + String::valueOf(end)
+                                      + ") out of bounds for length "_S + String::valueOf(count))
+                    .throws($ftrace(""_S));
+        }
+        // the characters are copied once, from the segments that contain the range
+        String str;
+        flatten(str, start, end);
+        return str;
+    }
+
+    CharSequence &SegmentedXString::subSequence(gint start, gint end) const
+    {
+        try {
+            return *new String(subString(start, end));
+        }
+        catch (Throwable const &ex) {
+            ex.throws($ftrace(""_S));
+        }
+    }
+
+    String &SegmentedXString::lastSegment()
+    {
+        if (size > 0 && segments[size - 1].length() < segmentLength) {
+            return segments[size - 1];
+        }
+        if (size == limit) {
+            // only the segments objects are moved, never their characters
+            gint newLimit = limit == 0 ? 16 : limit + (limit >> 1);
+            String *newSegments = new String[newLimit];
+            for (gint i = 0; i < size; ++i) {
+                newSegments[i] = CORE_CAST(String &&, segments[i]);
+            }
+            delete[] segments;
+            segments = newSegments;
+            limit = newLimit;
+        }
+        String &segment = segments[size++];
+        segment.allocate(String::COMPACT_STRINGS ? String::LATIN1 : String::UTF16, segmentLength);
+        segment.count = 0;
+        return segment;
+    }
+
+    void SegmentedXString::inflate(String &segment) const
+    {
+        gint n = segment.length();
+        String str;
+        str.allocate(String::UTF16, segmentLength);
+        StringUtils::copyLatin1ToUTF16(segment.value, 0, str.value, 0, n);
+        str.count = n;
+        segment = CORE_CAST(String &&, str);
+    }
+
+    void SegmentedXString::grow(gint n)
+    {
+        if (n > Integer::MAX_VALUE - 8 - count) {
+            OutOfMemoryError("Overflow: Required String length exceeds implementation limit"_S)
+                    .throws($ftrace(""_S));
+        }
+    }
+
+    void SegmentedXString::getChars(gint startIndex, gint endIndex, gchar dst[]) const
+    {
+        if (startIndex < 0 || startIndex > endIndex || endIndex > count) {
+            IndexOutOfBoundsException("Range ["_S + String::valueOf(startIndex) + ", "_S + String::valueOf(endIndex)
+                                      + ") out of bounds for length "_S + String::valueOf(count))
+                    .throws($ftrace(""_S));
+        }
+        gint i = startIndex;
+        while (i < endIndex) {
+            String const &segment = segments[i / segmentLength];
+            gint offset = i % segmentLength;
+            gint n = Math::min(endIndex - i, segment.length() - offset);
+            segment.getChars(offset, offset + n, dst + (i - startIndex));
+            i += n;
+        }
+    }
+
+    gbyte const *SegmentedXString::latin1Span() const
+    {
+        return size == 1 ? segments[0].latin1Span() : null;
+    }
+
+    gchar const *SegmentedXString::utf16Span() const
+    {
+        return size == 1 ? segments[0].utf16Span() : null;
+    }
+
+    SegmentedXString &SegmentedXString::append(String const &str)
+    {
+        gint length = str.length();
+        grow(length);
+        Coder coder = str.coding();
+        gint i = 0;
+        while (i < length) {
+            String &segment = lastSegment();
+            gint offset = segment.length();
+            gint n = Math::min(length - i, segmentLength - offset);
+            if (coder == String::LATIN1) {
+                segment.coding() == String::LATIN1
+                ? StringUtils::copyLatin1(str.value, i, segment.value, offset, n)
+                : StringUtils::copyLatin1ToUTF16(str.value, i, segment.value, offset, n);
+            }
+            else if (segment.coding() == String::UTF16) {
+                StringUtils::copyUTF16(str.value, i, segment.value, offset, n);
+            }
+            else {
+                CHARS chars = CORE_FCAST(CHARS, str.value);
+                gint k = StringKernels::compressUTF16(chars + i, segment.value + offset, n);
+                if (k < n) {
+                    // the first character above 0xFF inflates this segment only
+                    segment.count = offset + k;
+                    inflate(segment);
+                    StringUtils::copyUTF16(str.value, i + k, segment.value, offset + k, n - k);
+                }
+            }
+            segment.count = offset + n;
+            count += n;
+            i += n;
+        }
+        return *this;
+    }
+
+    SegmentedXString &SegmentedXString::append(CharSequence const &s)
+    {
+        if (Class< String >::hasInstance(s)) {
+            return append(CORE_XCAST(String const, s));
+        }
+        return append(s.toString());
+    }
+
+    SegmentedXString &SegmentedXString::append(Object const &obj)
+    {
+        return append(String::valueOf(obj));
+    }
+
+    SegmentedXString &SegmentedXString::append(gchar c)
+    {
+        grow(1);
+        String &segment = lastSegment();
+        gint offset = segment.length();
+        if (segment.coding() == String::LATIN1 && !StringUtils::isLatin1(c)) {
+            inflate(segment);
+        }
+        segment.coding() == String::LATIN1
+        ? StringUtils::writeLatin1CharAt(segment.value, offset, c)
+        : StringUtils::writeUTF16CharAt(segment.value, offset, c);
+        segment.count = offset + 1;
+        count += 1;
+        return *this;
+    }
+
+    SegmentedXString &SegmentedXString::append(gbool b)
+    {
+        return append(String::valueOf(b));
+    }
+
+    SegmentedXString &SegmentedXString::append(gint i)
+    {
+        return append(String::valueOf(i));
+    }
+
+    SegmentedXString &SegmentedXString::append(glong l)
+    {
+        return append(String::valueOf(l));
+    }
+
+    SegmentedXString &SegmentedXString::append(gfloat f)
+    {
+        return append(String::valueOf(f));
+    }
+
+    SegmentedXString &SegmentedXString::append(gdouble d)
+    {
+        return append(String::valueOf(d));
+    }
+
+    void SegmentedXString::flatten(String &str, gint start, gint end) const
+    {
+        gint first = start / segmentLength;
+        gint last = end > start ? (end - 1) / segmentLength : first - 1;
+        Coder coder = String::LATIN1;
+        for (gint i = first; i <= last; ++i) {
+            if (segments[i].coding() == String::UTF16) {
+                coder = String::UTF16;
+            }
+        }
+        str.allocate(coder, end - start);
+        gint offset = 0;
+        while (start < end) {
+            String const &segment = segments[start / segmentLength];
+            gint index = start % segmentLength;
+            gint n = Math::min(end - start, segment.length() - index);
+            if (segment.coding() == coder) {
+                coder == String::LATIN1
+                ? StringUtils::copyLatin1(segment.value, index, str.value, offset, n)
+                : StringUtils::copyUTF16(segment.value, index, str.value, offset, n);
+            }
+            else {
+                StringUtils::copyLatin1ToUTF16(segment.value, index, str.value, offset, n);
+            }
+            offset += n;
+            start += n;
+        }
+    }
+
+    String SegmentedXString::toString() const
+    {
+        String str;
+        flatten(str, 0, count);
+        return str;
+    }
+
+    String SegmentedXString::build()
+    {
+        String str;
+        if (size == 1 && count >= (String::EMBEDDED_LENGTH >> segments[0].coding())
+            && segmentLength - count <= (count >> 2)) {
+            // the storage of the single segment is given to the string, when
+            // it is mostly used. Otherwise, the characters are moved to a
+            // buffer of their size
+            str = CORE_CAST(String &&, segments[0]);
+        }
+        else {
+            flatten(str, 0, count);
+        }
+        release();
+        return str;
+    }
+
+} // core
@@ -0,0 +1,232 @@
+//
+// Created by bruns on 24/06/2024.
+//
+
+#ifndef CORE24_SEGMENTEDXSTRING_H
+#define CORE24_SEGMENTEDXSTRING_H
+
+#include <core/String.h>
+
+namespace core
+{
+    /**
+     * The class @c SegmentedXString is an append-only sequence of characters
+     * intended for very large outputs. Unlike @c XString, it never reallocates
+     * the characters already appended: they are stored in segments of a fixed
+     * number of characters, and a new segment is allocated when the last one is
+     * full. Each segment is encoded in latin1 until a character above 0xFF is
+     * appended to it, so only this segment is inflated to utf16.
+     * <p>
+     * The characters are either flattened once at the end with @c build() or
+     * @c toString(), or given segment by segment to a sink with @c drain(), that
+     * never allocates the whole output.
+     *
+     * @see XString
+     */
+    class SegmentedXString final : public virtual CharSequence
+    {
+        CORE_ALIAS(ARRAY, Class< gbyte >::Pointer);
+        CORE_ALIAS(BYTES, Class< gbyte >::Pointer);
+        CORE_ALIAS(CHARS, Class< gchar >::Pointer);
+
+        CORE_ALIAS(StringUtils, String::StringUtils);
+        CORE_ALIAS(Coder, String::Coder);
+
+    private:
+        /**
+         * The segments, each one is a String owning its storage. All the
+         * segments are full, except the last one.
+         */
+        String *segments = null;
+
+        /**
+         * The number of segments.
+         */
+        gint size = 0;
+
+        /**
+         * The number of slots of the @c segments array.
+         */
+        gint limit = 0;
+
+        /**
+         * The number of 16 bits characters on this sequence.
+         */
+        gint count = 0;
+
+        /**
+         * The number of characters of each segment.
+         */
+        gint segmentLength = 0;
+
+        /**
+         * Return the last segment with room for at least one character,
+         * a new segment is added if the last one is full.
+         */
+        String &lastSegment();
+
+        /**
+         * Convert the given latin1 segment to utf16.
+         */
+        void inflate(String &segment) const;
+
+        /**
+         * Increase the number of characters by the given number.
+         */
+        void grow(gint n);
+
+        /**
+         * Copy the characters of the given range of the segments on the given string
+         * storage, allocated once with the coder of the segments covering this range.
+         */
+        void flatten(String &str, gint start, gint end) const;
+
+        /**
+         * Release all the segments.
+         */
+        void release();
+
+        CORE_EXPLICIT SegmentedXString(SegmentedXString const &);
+
+        SegmentedXString &operator=(SegmentedXString const &);
+
+    public:
+        /**
+         * The default number of characters of the segments.
+         */
+        static CORE_FAST gint SEGMENT_LENGTH = 1 << 16;
+
+        /**
+         * Constructs an empty sequence with segments of @c SEGMENT_LENGTH characters.
+         */
+        CORE_IMPLICIT SegmentedXString();
+
+        /**
+         * Constructs an empty sequence with segments of the given number
+         * of characters (at least 256).
+         *
+         * @param segmentLength the number of characters of the segments
+         * @throws IllegalArgumentException if @c segmentLength is negative
+         */
+        CORE_EXPLICIT SegmentedXString(gint segmentLength);
+
+        ~SegmentedXString() override;
+
+        /**
+         * Returns the number of characters of this sequence.
+         */
+        gint length() const override;
+
+        /**
+         * Returns the character at the given index.
+         *
+         * @throws IndexOutOfBoundsException if @c index is negative or not
+         *          less than the length of this sequence.
+         */
+        gchar charAt(gint index) const override;
+
+        /**
+         * Returns a new string that contains the characters of the given range.
+         *
+         * @throws IndexOutOfBoundsException if @c start or @c end are negative,
+         *          if @c end is greater than @c length(), or if @c start is
+         *          greater than @c end
+         */
+        String subString(gint start, gint end) const;
+
+        CharSequence &subSequence(gint start, gint end) const override;
+
+        /**
+         * Copies the characters of the specified range to the given buffer, segment
+         * by segment. The spans are only given for a sequence of a single segment.
+         *
+         * @see CharSequence::getChars(gint, gint, gchar[])
+         */
+        void getChars(gint startIndex, gint endIndex, gchar dst[]) const override;
+
+        gbyte const *latin1Span() const override;
+
+        gchar const *utf16Span() const override;
+
+
+        /**
+         * Appends the given string to this sequence.
+         *
+         * @param str a string
+         * @return  a reference to this object.
+         */
+        SegmentedXString &append(String const &str);
+
+        /**
+         * Appends the given character sequence to this sequence.
+         *
+         * @param s a character sequence
+         * @return  a reference to this object.
+         */
+        SegmentedXString &append(CharSequence const &s);
+
+        /**
+         * Appends the string representation of the given object.
+         *
+         * @see String::valueOf(Object const &)
+         */
+        SegmentedXString &append(Object const &obj);
+
+        /**
+         * Appends the given character to this sequence.
+         *
+         * @param c a character
+         * @return  a reference to this object.
+         */
+        SegmentedXString &append(gchar c);
+
+        /**
+         * Appends the string representation of the given value.
+         *
+         * @see String::valueOf(gbool)
+         */
+        SegmentedXString &append(gbool b);
+
+        SegmentedXString &append(gint i);
+
+        SegmentedXString &append(glong l);
+
+        SegmentedXString &append(gfloat f);
+
+        SegmentedXString &append(gdouble d);
+
+        /**
+         * Returns a new string that contains the characters of this
+         * sequence. This sequence is not modified.
+         */
+        String toString() const override;
+
+        /**
+         * Returns a string that contains the characters of this sequence, and
+         * leaves this sequence empty. A sequence of a single segment that uses
+         * at least three quarters of it gives its storage to the string without
+         * copy. The other ones are flattened in the storage of the string.
+         */
+        String build();
+
+        /**
+         * Gives the segments of this sequence to the given sink, in order, and
+         * leaves this sequence empty. The sink is called with a @c String holding
+         * the characters of each segment (without copy), so the whole output is
+         * never allocated.
+         *
+         * @param sink a callable object accepting a @c String const &
+         */
+        template<class Sink>
+        void drain(Sink &&sink)
+        {
+            for (gint i = 0; i < size; ++i) {
+                sink(CORE_CAST(String const &, segments[i]));
+            }
+            release();
+        }
+    };
+
+} // core
+
+#endif // CORE24_SEGMENTEDXSTRING_H
@@ -4,6 +4,8 @@
 
 #include <core/String.h>
 #include <meta/StringUtils.h>
+#include <meta/StringTable.h>
+#include <meta/StringKernels.h>
 #include <meta/CharacterDataLatin1.h>
 #include <core/misc/Precondition.h>
 #include <core/misc/Foreign.h>
@@ -12,6 +14,7 @@
 #include <core/OutOfMemoryError.h>
 #include <core/ArithmeticException.h>
 #include <core/IllegalArgumentException.h>
+#include <core/IndexOutOfBoundsException.h>
 #include <core/XString.h>
 #include <core/Boolean.h>
 #include <core/Integer.h>
@@ -38,25 +41,130 @@ namespace core
         hashIsZero = false;
     }
 
+    gbool String::isEmbedded() const
+    {
+        return value == CORE_CAST(BYTES, embedded);
+    }
+
+    void String::allocate(Coder coder, gint count)
+    {
+        if (count < (EMBEDDED_LENGTH >> coder)) {
+            embedded[0] = embedded[1] = 0;
+            value = CORE_CAST(BYTES, embedded);
+        }
+        else {
+            value = coder == LATIN1
+                    ? StringUtils::newLatin1String(count)
+                    : StringUtils::newUTF16String(count);
+        }
+        String::coder = coder;
+        String::count = count;
+    }
+
+    void String::release()
+    {
+        if (isEmbedded()) {
+            embedded[0] = embedded[1] = 0;
+            value = StringUtils::newLatin1String(0);
+        }
+        else if (valueIsStatic) {
+            valueIsStatic = false;
+            value = StringUtils::newLatin1String(0);
+        }
+        else if (value != null) {
+            // Release this owner, the buffer is freed by the last one
+            coding() == LATIN1
+            ? StringUtils::destroyLatin1String(value, count)
+            : StringUtils::destroyUTF16String(value, count);
+        }
+        count = 0;
+        coder = COMPACT_STRINGS ? LATIN1 : UTF16;
+    }
+
+    gbool String::isWritable() const
+    {
+        return isEmbedded() || (!valueIsStatic && !StringUtils::isSharedString(value));
+    }
+
+    gint String::capacity() const
+    {
+        if (isEmbedded()) {
+            // one character is reserved to the terminal null character
+            return (EMBEDDED_LENGTH >> coding()) - 1;
+        }
+        if (valueIsStatic) {
+            return length();
+        }
+        glong capacity = (StringUtils::capacityOfString(value) >> coding()) - 1;
+        return capacity > Integer::MAX_VALUE ? Integer::MAX_VALUE : (gint) capacity;
+    }
+
+    void String::reserve(Coder coder, gint minCapacity)
+    {
+        if (coding() == coder && minCapacity <= capacity() && isWritable()) {
+            return;
+        }
+        gint count = length();
+        gint newCapacity = Math::max(minCapacity, count);
+        if (newCapacity >= (EMBEDDED_LENGTH >> coder)) {
+            // grow by 50% to amortize the successive appends
+            newCapacity = Math::min(newCapacity + (newCapacity >> 1), Integer::MAX_VALUE - 8);
+            newCapacity = Math::max(newCapacity, minCapacity);
+        }
+        String str;
+        str.allocate(coder, newCapacity);
+        if (coding() == coder) {
+            coder == LATIN1
+            ? StringUtils::copyLatin1(value, 0, str.value, 0, count)
+            : StringUtils::copyUTF16(value, 0, str.value, 0, count);
+        }
+        else if (coder == UTF16) {
+            StringUtils::copyLatin1ToUTF16(value, 0, str.value, 0, count);
+        }
+        else {
+            StringUtils::copyUTF16ToLatin1(value, 0, str.value, 0, count);
+        }
+        str.count = count;
+        str.hashValue = hashValue;
+        str.hashIsZero = hashIsZero;
+        *this = CORE_CAST(String &&, str);
+    }
+
     String::String(String const &original) : String()
     {
-        gint length = original.length();
-        if (original.coding() == LATIN1) {
-            value = StringUtils::copyOfLatin1(original.value, 0, length);
-            coder = LATIN1;
+        if (original.isEmbedded()) {
+            embedded[0] = original.embedded[0];
+            embedded[1] = original.embedded[1];
+            value = CORE_CAST(BYTES, embedded);
+        }
+        else if (original.valueIsStatic) {
+            value = original.value;
+            valueIsStatic = true;
         }
         else {
-            value = StringUtils::copyOfUTF16(original.value, 0, length);
-            coder = UTF16;
+            // The buffers are immutable, the copy shares the original one
+            value = StringUtils::shareString(original.value);
         }
-        count = length;
+        coder = original.coding();
+        count = original.length();
         hashValue = original.hashValue;
         hashIsZero = original.hashIsZero;
     }
 
     String::String(String &&original) CORE_NOTHROW: String()
     {
-        value = original.value;
+        if (original.isEmbedded()) {
+            embedded[0] = original.embedded[0];
+            embedded[1] = original.embedded[1];
+            original.embedded[0] = original.embedded[1] = 0;
+            value = CORE_CAST(BYTES, embedded);
+        }
+        else {
+            value = original.value;
+            valueIsStatic = original.valueIsStatic;
+            original.valueIsStatic = false;
+        }
+        coder = original.coder;
         count = original.count;
         hashValue = original.hashValue;
         hashIsZero = original.hashIsZero;
@@ -76,7 +184,19 @@ namespace core
         Precondition::checkIndexFromSize(offset, count, value.length());
 
         if (count > 0) {
-            if (COMPACT_STRINGS) {
+            if (COMPACT_STRINGS && count < EMBEDDED_LENGTH) {
+                gint i = 0;
+                while (i < count && StringUtils::isLatin1(value.value[offset + i])) {
+                    i += 1;
+                }
+                if (i == count) {
+                    allocate(LATIN1, count);
+                    StringUtils::copyUTF16ToLatin1(value.value, offset, String::value, 0, count);
+                }
+                else
+                    goto UTF16_STRING;
+            }
+            else if (COMPACT_STRINGS) {
                 BYTES bytes = StringUtils::inflateUTF16ToLatin1(value.value, offset, count);
                 if (bytes != null) {
                     String::value = bytes;
@@ -88,9 +208,8 @@ namespace core
             }
             else {
 UTF16_STRING:
-                String::value = StringUtils::copyOfUTF16(value.value, offset, count);
-                String::count = count;
-                String::coder = UTF16;
+                allocate(UTF16, count);
+                StringUtils::copyUTF16(value.value, offset, String::value, 0, count);
             }
         }
     }
@@ -100,21 +219,9 @@ UTF16_STRING:
         Precondition::checkIndexFromSize(offset, count, codePoints.length());
 
         if (count > 0) {
-            if (COMPACT_STRINGS) {
-                BYTES bytes = StringUtils::inflateUTF32ToLatin1(codePoints.value, offset, count);
-                if (bytes != null) {
-                    String::value = bytes;
-                    String::count = count;
-                    String::coder = LATIN1;
-                }
-                else
-                    goto UTF16_STRING;
-            }
-            else {
-UTF16_STRING:
-                String::value = StringUtils::copyOfUTF32ToUTF16(codePoints.value, offset, count, String::count);
-                String::coder = UTF16;
-            }
+            Coder coder = LATIN1;
+            String::value = StringUtils::copyOfUTF32(codePoints.value, offset, count, coder, String::count);
+            String::coder = coder;
         }
     }
 
@@ -124,17 +231,15 @@ UTF16_STRING:
 
         if (count > 0) {
             if (COMPACT_STRINGS && hibyte == 0) {
-                value = StringUtils::copyOfLatin1(ascii.value, offset, count);
-                String::coder = LATIN1;
+                allocate(LATIN1, count);
+                StringUtils::copyLatin1(ascii.value, offset, value, 0, count);
             }
             else {
-                value = StringUtils::newUTF16String(count);
-                String::coder = UTF16;
+                allocate(UTF16, count);
                 for (int i = 0; i < count; ++i) {
-                    StringUtils::writeUTF16CharAt(value, i, (gbyte) (hibyte & 0xff), ascii.value[i]);
+                    StringUtils::writeUTF16CharAt(value, i, (gbyte) (hibyte & 0xff), ascii.value[offset + i]);
                 }
             }
-            String::count = count;
         }
     }
 
@@ -145,19 +250,53 @@ UTF16_STRING:
     String &String::operator=(String const &other)
     {
         if (this != &other) {
-            gint length = other.count;
-            BYTES bytes = other.coding() == LATIN1
-                          ? StringUtils::copyOfLatin1(other.value, 0, length)
-                          : StringUtils::copyOfUTF16(other.value, 0, length);
-            coder == LATIN1
-            ? StringUtils::destroyLatin1String(value, count)
-            : StringUtils::destroyUTF16String(value, count);
-            count = 0;
+            release();
+            if (other.isEmbedded()) {
+                embedded[0] = other.embedded[0];
+                embedded[1] = other.embedded[1];
+                value = CORE_CAST(BYTES, embedded);
+            }
+            else if (other.valueIsStatic) {
+                value = other.value;
+                valueIsStatic = true;
+            }
+            else {
+                value = StringUtils::shareString(other.value);
+            }
+            coder = other.coding();
+            count = other.length();
+            hashIsZero = other.hashIsZero;
+            hashValue = other.hashValue;
+        }
+        return *this;
+    }
 
-            value = bytes;
-            count = length;
+    String &String::operator=(String &&other) CORE_NOTHROW
+    {
+        if (this != &other) {
+            release();
+            if (other.isEmbedded()) {
+                embedded[0] = other.embedded[0];
+                embedded[1] = other.embedded[1];
+                value = CORE_CAST(BYTES, embedded);
+            }
+            else {
+                // The storage is transferred, no reference is added
+                value = other.value;
+                valueIsStatic = other.valueIsStatic;
+            }
+            coder = other.coder;
+            count = other.count;
             hashIsZero = other.hashIsZero;
             hashValue = other.hashValue;
+
+            other.embedded[0] = other.embedded[1] = 0;
+            other.valueIsStatic = false;
+            other.value = StringUtils::newLatin1String(0);
+            other.count = 0;
+            other.coder = COMPACT_STRINGS ? LATIN1 : UTF16;
+            other.hashValue = 0;
+            other.hashIsZero = true;
         }
         return *this;
     }
@@ -195,18 +334,63 @@ UTF16_STRING:
             return endIndex - beginIndex;
         }
         else {
-            gint n = 0;
-            for (int i = beginIndex; i <= endIndex; ++i) {
-                gchar c = StringUtils::readLatin1CodePointAt(value, i);
-                if (StringUtils::isSupplementary(c)) {
-                    n += 2;
-                    i += 1;
-                }
-                else {
-                    n += 1;
+            return StringUtils::numberOfUTF16CodePoints(value, beginIndex, endIndex - beginIndex);
+        }
+    }
+
+    gint String::offsetByCodePoints(gint index, gint codePointOffset) const
+    {
+        gint count = length();
+        if (index < 0 || index > count) {
+            IndexOutOfBoundsException("Index "_S + String::valueOf(index) + " out of bounds for length "_S
+                                      + String::valueOf(count)).throws($ftrace(""_S));
+        }
+        gint x = index;
+        gbool outOfBounds;
+        if (coding() == LATIN1) {
+            // compared to the remaining lengths, index + codePointOffset may overflow
+            outOfBounds = codePointOffset > count - index || codePointOffset < -index;
+            if (!outOfBounds) {
+                x = index + codePointOffset;
+            }
+        }
+        else if (codePointOffset >= 0) {
+            CHARS chars = CORE_FCAST(CHARS, value);
+            gint n = StringKernels::skipCodePoints(chars + index, count - index, codePointOffset);
+            outOfBounds = n < 0;
+            x = index + n;
+        }
+        else {
+            CHARS chars = CORE_FCAST(CHARS, value);
+            gint i;
+            for (i = codePointOffset; x > 0 && i < 0; i++) {
+                if (Character::isLowSurrogate(chars[--x]) && x > 0 && Character::isHighSurrogate(chars[x - 1])) {
+                    x--;
                 }
             }
-            return n;
+            outOfBounds = i < 0;
+        }
+        if (outOfBounds) {
+            IndexOutOfBoundsException("Offset "_S + String::valueOf(codePointOffset) + " from index "_S
+                                      + String::valueOf(index) + " out of bounds for length "_S
+                                      + String::valueOf(count)).throws($ftrace(""_S));
+        }
+        return x;
+    }
+
+    IntArray String::toCodePoints() const
+    {
+        gint count = length();
+        if (coding() == LATIN1) {
+            IntArray codePoints = IntArray(count);
+            StringKernels::toCodePoints(value, count, codePoints.value);
+            return codePoints;
+        }
+        else {
+            CHARS chars = CORE_FCAST(CHARS, value);
+            IntArray codePoints = IntArray(StringKernels::codePointCount(chars, count));
+            StringKernels::toCodePoints(chars, count, codePoints.value);
+            return codePoints;
         }
     }
 
@@ -230,6 +414,45 @@ UTF16_STRING:
         : StringUtils::copyUTF16ToLatin1(value, beginIndex, dest.value, offset, endIndex - beginIndex);
     }
 
+    glong String::utf8Length() const
+    {
+        return coding() == LATIN1
+               ? StringKernels::utf8Length(value, length())
+               : StringKernels::utf8Length(CORE_FCAST(CHARS, value), length());
+    }
+
+    ByteArray String::toUtf8() const
+    {
+        glong size = utf8Length();
+        if (size > Integer::MAX_VALUE - 8) {
+            OutOfMemoryError("Overflow: Required array length exceeds implementation limit"_S).throws($ftrace(""_S));
+        }
+        ByteArray bytes = ByteArray((gint) size);
+        coding() == LATIN1
+        ? StringKernels::encodeUTF8(value, length(), bytes.value)
+        : StringKernels::encodeUTF8(CORE_FCAST(CHARS, value), length(), bytes.value);
+        return bytes;
+    }
+
+    gint String::encodeUtf8Into(ByteArray &dest, gint offset) const
+    {
+        return encodeUtf8Into(dest.value, offset, dest.length());
+    }
+
+    gint String::encodeUtf8Into(gbyte dest[], gint offset, gint capacity) const
+    {
+        glong size = utf8Length();
+        if (offset < 0 || offset > capacity || size > capacity - offset) {
+            IndexOutOfBoundsException("Range ["_S + String::valueOf(offset) + ", "_S + String::valueOf(offset) + " + "_S
+                                      + String::valueOf(size) + ") out of bounds for length "_S
+                                      + String::valueOf(capacity)).throws($ftrace(""_S));
+        }
+        coding() == LATIN1
+        ? StringKernels::encodeUTF8(value, length(), dest + offset)
+        : StringKernels::encodeUTF8(CORE_FCAST(CHARS, value), length(), dest + offset);
+        return (gint) size;
+    }
+
     gbool String::equals(Object const &obj) const
     {
         if (this == &obj)
@@ -245,9 +468,20 @@ UTF16_STRING:
                 return false;
             }
 
-            return coder == LATIN1
-                   ? StringUtils::compareToLatin1(value, 0, other.value, 0, count)
-                   : StringUtils::compareToUTF16(value, 0, other.value, 0, count);
+            if (value == other.value) {
+                // Same shared buffer (copies and interned strings)
+                return true;
+            }
+
+            gint hash1 = 0;
+            gint hash2 = 0;
+            if (cachedHash(hash1) && other.cachedHash(hash2) && hash1 != hash2) {
+                return false;
+            }
+
+            return (coder == LATIN1
+                    ? StringUtils::compareToLatin1(value, 0, other.value, 0, count)
+                    : StringUtils::compareToUTF16(value, 0, other.value, 0, count)) == 0;
         }
     }
 
@@ -267,75 +501,136 @@ UTF16_STRING:
                      ? StringUtils::compareLatin1ToUTF16(value, 0, other.value, 0, count)
                      : StringUtils::compareUTF16ToLatin1(value, 0, other.value, 0, count);
 
-        return count1 == count2
-               ? res
-               : count1 > count2
-                 ? coder == LATIN1
-                   ? StringUtils::readLatin1CharAt(value, count)
-                   : StringUtils::readUTF16CharAt(value, count)
-                 : other.coding() == LATIN1
-                   ? -StringUtils::readLatin1CharAt(other.value, count)
-                   : -StringUtils::readUTF16CharAt(other.value, count);
+        return res != 0 ? res : count1 - count2;
     }
 
-    String::~String()
+    gbool String::equalsIgnoreCase(String const &anotherString) const
+    {
+        return this == &anotherString
+               || (length() == anotherString.length()
+                   && regionMatches(true, 0, anotherString, 0, length()));
+    }
+
+    gint String::compareToIgnoreCase(String const &str) const
     {
-        gint count = length();
         Coder coder = coding();
-        if (count > 0) {
+        gint count1 = length();
+        gint count2 = str.length();
+
+        gint count = count1 < count2 ? count1 : count2;
+
+        gint res = coder == str.coding()
+                   ? coder == LATIN1
+                     ? StringUtils::compareToIgnoreCaseLatin1(value, 0, str.value, 0, count)
+                     : StringUtils::compareToIgnoreCaseUTF16(value, 0, str.value, 0, count)
+                   : coder == LATIN1
+                     ? StringUtils::compareLatin1ToUTF16IgnoreCase(value, 0, str.value, 0, count)
+                     : StringUtils::compareUTF16ToLatin1IgnoreCase(value, 0, str.value, 0, count);
+
+        return res != 0 ? res : count1 - count2;
+    }
+
+    String String::intern() const
+    {
+        if (isEmbedded() || length() == 0) {
+            // Short strings are already compared by value
+            return *this;
+        }
+        return StringTable::intern(*this);
+    }
+
+    String String::sensitive() const
+    {
+        if (length() == 0) {
+            return *this;
+        }
+        if (isEmbedded() || valueIsStatic) {
+            // Only the heap buffers have the header carrying the flag
+            Coder coder = coding();
+            gint count = length();
+            String str;
+            str.value = coder == LATIN1
+                        ? StringUtils::newLatin1String(count)
+                        : StringUtils::newUTF16String(count);
             coder == LATIN1
-            ? StringUtils::destroyLatin1String(value, count)
-            : StringUtils::destroyUTF16String(value, count);
-            String::count = 0;
-            String::value = StringUtils::newLatin1String(0);
-            String::coder = COMPACT_STRINGS ? LATIN1 : UTF16;
+            ? StringUtils::copyLatin1(value, 0, str.value, 0, count)
+            : StringUtils::copyUTF16(value, 0, str.value, 0, count);
+            str.coder = coder;
+            str.count = count;
+            str.hashValue = hashValue;
+            str.hashIsZero = hashIsZero;
+            StringUtils::markSensitiveString(str.value);
+            return str;
         }
+        StringUtils::markSensitiveString(value);
+        return *this;
+    }
+
+    void String::setSecureWipe(gbool enabled)
+    {
+        StringUtils::enableSecureWipe(enabled);
+    }
+
+    gbool String::isSecureWipe()
+    {
+        return StringUtils::isSecureWipeEnabled();
+    }
+
+    String::~String()
+    {
+        release();
     }
 
     gbool String::startsWith(String const &prefix, gint toffset) const
     {
-        if (toffset < 0 || toffset > length() - prefix.length()) {
+        return regionMatches(toffset, prefix, 0, prefix.length());
+    }
+
+    gbool String::regionMatches(gint toffset, String const &other, gint ooffset, gint len) const
+    {
+        if (ooffset < 0 || toffset < 0
+            || toffset > (glong) length() - len
+            || ooffset > (glong) other.length() - len) {
             return false;
         }
+        if (len <= 0) {
+            return true;
+        }
 
         Coder coder = coding();
-        gint count = prefix.length();
+        gint res = coder == other.coding()
+                   ? coder == LATIN1
+                     ? StringUtils::compareToLatin1(value, toffset, other.value, ooffset, len)
+                     : StringUtils::compareToUTF16(value, toffset, other.value, ooffset, len)
+                   : coder == LATIN1
+                     ? StringUtils::compareLatin1ToUTF16(value, toffset, other.value, ooffset, len)
+                     : StringUtils::compareUTF16ToLatin1(value, toffset, other.value, ooffset, len);
+        return res == 0;
+    }
 
-        if (coder == prefix.coding()) {
-            if (coder == LATIN1) {
-                for (int i = 0; i < count; ++i) {
-                    gchar c1 = StringUtils::readLatin1CharAt(value, i + toffset);
-                    gchar c2 = StringUtils::readLatin1CharAt(prefix.value, i);
-                    if (c1 != c2) {
-                        return false;
-                    }
-                }
-            }
-            else {
-                for (int i = 0; i < count; ++i) {
-                    gchar c1 = StringUtils::readUTF16CharAt(value, i + toffset);
-                    gchar c2 = StringUtils::readUTF16CharAt(prefix.value, i);
-                    if (c1 != c2) {
-                        return false;
-                    }
-                }
-            }
+    gbool String::regionMatches(gbool ignoreCase, gint toffset, String const &other, gint ooffset, gint len) const
+    {
+        if (!ignoreCase) {
+            return regionMatches(toffset, other, ooffset, len);
         }
-        else {
-            if (coder == LATIN1) {
-                return false;
-            }
-            else {
-                for (int i = 0; i < count; ++i) {
-                    gchar c1 = StringUtils::readUTF16CharAt(value, i + toffset);
-                    gchar c2 = StringUtils::readLatin1CharAt(prefix.value, i);
-                    if (c1 != c2) {
-                        return false;
-                    }
-                }
-            }
+        if (ooffset < 0 || toffset < 0
+            || toffset > (glong) length() - len
+            || ooffset > (glong) other.length() - len) {
+            return false;
+        }
+        if (len <= 0) {
+            return true;
         }
-        return true;
+
+        Coder coder = coding();
+        gint res = coder == other.coding()
+                   ? coder == LATIN1
+                     ? StringUtils::compareToIgnoreCaseLatin1(value, toffset, other.value, ooffset, len)
+                     : StringUtils::compareToIgnoreCaseUTF16(value, toffset, other.value, ooffset, len)
+                   : coder == LATIN1
+                     ? StringUtils::compareLatin1ToUTF16IgnoreCase(value, toffset, other.value, ooffset, len)
+                     : StringUtils::compareUTF16ToLatin1IgnoreCase(value, toffset, other.value, ooffset, len);
+        return res == 0;
     }
 
     gbool String::startsWith(String const &prefix) const
@@ -361,16 +656,9 @@ UTF16_STRING:
         gint hash = hashValue;
         if (hash == 0 && !hashIsZero) {
             gint count = length();
-            if (coding() == LATIN1) {
-                for (int i = 0; i < count; ++i) {
-                    hash = hash * 31 + StringUtils::readLatin1CharAt(value, i);
-                }
-            }
-            else {
-                for (int i = 0; i < count; ++i) {
-                    hash = hash * 31 + StringUtils::readUTF16CharAt(value, i);
-                }
-            }
+            hash = coding() == LATIN1
+                   ? StringUtils::hashLatin1String(value, 0, count)
+                   : StringUtils::hashUTF16String(value, 0, count);
             hashIsZero = (hashValue = hash) == 0;
         }
         return hash;
@@ -388,27 +676,9 @@ UTF16_STRING:
         if (fromIndex >= count) {
             return -1;
         }
-        if (coding() == LATIN1) {
-            if (Character::isValidCodePoint(ch) && StringUtils::isLatin1(ch)) {
-                for (int i = 0; i < count; ++i) {
-                    gbyte c = (gbyte) StringUtils::readLatin1CharAt(value, i);
-                    if (c == (gbyte) ch) {
-                        return i;
-                    }
-                }
-            }
-        }
-        else {
-            if (Character::isValidCodePoint(ch) && StringUtils::isLatin1(ch)) {
-                for (int i = 0; i < count; ++i) {
-                    gbyte c = (gbyte) StringUtils::readUTF16CharAt(value, i);
-                    if (c == (gbyte) ch) {
-                        return i;
-                    }
-                }
-            }
-        }
-        return -1;
+        return coding() == LATIN1
+               ? StringUtils::indexOfLatin1(value, fromIndex, ch, count - fromIndex)
+               : StringUtils::indexOfUTF16(value, fromIndex, ch, count - fromIndex);
     }
 
     gint String::lastIndexOf(gint ch) const
@@ -418,32 +688,41 @@ UTF16_STRING:
 
     gint String::lastIndexOf(gint ch, gint fromIndex) const
     {
-        fromIndex = Math::max(fromIndex, 0);
         gint count = length();
-        if (fromIndex >= count) {
+        if (fromIndex < 0 || count == 0) {
             return -1;
         }
-        if (coding() == LATIN1) {
-            if (Character::isValidCodePoint(ch) && StringUtils::isLatin1(ch)) {
-                for (int i = count - 1; i >= 0; --i) {
-                    gbyte c = (gbyte) StringUtils::readLatin1CharAt(value, i);
-                    if (c == (gbyte) ch) {
-                        return i;
-                    }
-                }
-            }
+        // The occurrences start at most at fromIndex, a surrogate pair may end just after
+        fromIndex = Math::min(fromIndex, count - 1);
+        gint end = Math::min(Character::isBmpCodePoint(ch) ? fromIndex + 1 : fromIndex + 2, count);
+        return coding() == LATIN1
+               ? StringUtils::lastIndexOfLatin1(value, 0, ch, end)
+               : StringUtils::lastIndexOfUTF16(value, 0, ch, end);
+    }
+
+    gint String::indexOfAny(String const &chars) const
+    {
+        return indexOfAny(chars, 0);
+    }
+
+    gint String::indexOfAny(String const &chars, gint fromIndex) const
+    {
+        fromIndex = Math::max(fromIndex, 0);
+        gint count1 = length();
+        gint count2 = chars.length();
+        if (fromIndex >= count1 || count2 == 0) {
+            return -1;
         }
-        else {
-            if (Character::isValidCodePoint(ch) && StringUtils::isLatin1(ch)) {
-                for (int i = count - 1; i >= 0; --i) {
-                    gbyte c = (gbyte) StringUtils::readUTF16CharAt(value, i);
-                    if (c == (gbyte) ch) {
-                        return i;
-                    }
-                }
-            }
+        Coder coder1 = coding();
+        Coder coder2 = chars.coding();
+        if (coder1 == LATIN1) {
+            return coder2 == LATIN1
+                   ? StringUtils::indexOfAnyLatin1(value, fromIndex, chars.value, 0, count1 - fromIndex, count2)
+                   : StringUtils::indexOfAnyUTF16$Latin1(value, fromIndex, chars.value, 0, count1 - fromIndex, count2);
         }
-        return -1;
+        return coder2 == LATIN1
+               ? StringUtils::indexOfAnyLatin1$UTF16(value, fromIndex, chars.value, 0, count1 - fromIndex, count2)
+               : StringUtils::indexOfAnyUTF16(value, fromIndex, chars.value, 0, count1 - fromIndex, count2);
     }
 
     gint String::indexOf(String const &str) const
@@ -467,85 +746,15 @@ UTF16_STRING:
 
         Coder coder = coding();
         if (coder == str.coding()) {
-            if (coder == LATIN1) {
-                gchar f = StringUtils::readLatin1CharAt(str.value, 0);
-                gint count = count1 - count2;
-                for (int i = fromIndex; i < count; ++i) {
-                    gchar c1 = StringUtils::readLatin1CharAt(value, i);
-                    // Look for first character.
-                    if (c1 != f) {
-                        continue;
-                    }
-                    // Found first character, now look at the rest of value
-                    gint j = i + 1;
-                    for (int k = 1; k < count2; ++k, ++j) {
-                        c1 = StringUtils::readLatin1CharAt(value, j);
-                        gchar c2 = StringUtils::readLatin1CharAt(str.value, k);
-                        if (c1 != c2) {
-                            break;
-                        }
-                    }
-                    if (j == i + count2) {
-                        // Found whole string.
-                        return i;
-                    }
-                }
-            }
-            else {
-                gchar f = StringUtils::readUTF16CharAt(str.value, 0);
-                gint count = count1 - count2;
-                for (int i = fromIndex; i < count; ++i) {
-                    gchar c1 = StringUtils::readUTF16CharAt(value, i);
-                    // Look for first character.
-                    if (c1 != f) {
-                        continue;
-                    }
-                    // Found first character, now look at the rest of value
-                    gint j = i + 1;
-                    for (int k = 1; k < count2; ++k, ++j) {
-                        c1 = StringUtils::readUTF16CharAt(value, j);
-                        gchar c2 = StringUtils::readUTF16CharAt(str.value, k);
-                        if (c1 != c2) {
-                            break;
-                        }
-                    }
-                    if (j == i + count2) {
-                        // Found whole string.
-                        return i;
-                    }
-                }
-            }
+            return coder == LATIN1
+                   ? StringUtils::indexOfLatin1(value, fromIndex, str.value, 0, count1 - fromIndex, count2)
+                   : StringUtils::indexOfUTF16(value, fromIndex, str.value, 0, count1 - fromIndex, count2);
         }
-        else {
-            if (coder == LATIN1) {
-                return -1;
-            }
-            else {
-                gchar f = StringUtils::readLatin1CharAt(str.value, 0);
-                gint count = count1 - count2;
-                for (int i = fromIndex; i < count; ++i) {
-                    gchar c1 = StringUtils::readUTF16CharAt(value, i);
-                    // Look for first character.
-                    if (c1 != f) {
-                        continue;
-                    }
-                    // Found first character, now look at the rest of value
-                    gint j = i + 1;
-                    for (int k = 1; k < count2; ++k, ++j) {
-                        c1 = StringUtils::readUTF16CharAt(value, j);
-                        gchar c2 = StringUtils::readLatin1CharAt(str.value, k);
-                        if (c1 != c2) {
-                            break;
-                        }
-                    }
-                    if (j == i + count2) {
-                        // Found whole string.
-                        return i;
-                    }
-                }
-            }
+        if (coder == LATIN1) {
+            // The utf16 strings contain at least one character above 0xFF
+            return -1;
         }
-        return -1;
+        return StringUtils::indexOfLatin1$UTF16(value, fromIndex, str.value, 0, count1 - fromIndex, count2);
     }
 
     gint String::lastIndexOf(String const &str) const
@@ -570,87 +779,19 @@ UTF16_STRING:
             return fromIndex;
         }
 
+        // The occurrences start at most at fromIndex
+        gint count = fromIndex + count2;
         Coder coder = coding();
         if (coder == str.coding()) {
-            if (coder == LATIN1) {
-                gchar l = StringUtils::readLatin1CharAt(str.value, count2 - 1);
-                gint count = count1 - count2;
-                for (int i = count1 - 1; i >= count; --i) {
-                    gchar c1 = StringUtils::readLatin1CharAt(value, i);
-                    // Look for last character.
-                    if (c1 != l) {
-                        continue;
-                    }
-                    // Found first character, now look at the rest of value
-                    gint j = i - 1;
-                    for (int k = count2 - 2; k >= 0; --k, --j) {
-                        c1 = StringUtils::readLatin1CharAt(value, j);
-                        gchar c2 = StringUtils::readLatin1CharAt(str.value, k);
-                        if (c1 != c2) {
-                            break;
-                        }
-                    }
-                    if (j <= i - count2) {
-                        // Found whole string.
-                        return j + 1;
-                    }
-                }
-            }
-            else {
-                gchar l = StringUtils::readUTF16CharAt(str.value, count2 - 1);
-                gint count = count1 - count2;
-                for (int i = count1 - 1; i >= count; --i) {
-                    gchar c1 = StringUtils::readUTF16CharAt(value, i);
-                    // Look for last character.
-                    if (c1 != l) {
-                        continue;
-                    }
-                    // Found first character, now look at the rest of value
-                    gint j = i - 1;
-                    for (int k = count2 - 2; k >= 0; --k, --j) {
-                        c1 = StringUtils::readUTF16CharAt(value, j);
-                        gchar c2 = StringUtils::readUTF16CharAt(str.value, k);
-                        if (c1 != c2) {
-                            break;
-                        }
-                    }
-                    if (j <= i - count2) {
-                        // Found whole string.
-                        return j + 1;
-                    }
-                }
-            }
+            return coder == LATIN1
+                   ? StringUtils::lastIndexOfLatin1(value, 0, str.value, 0, count, count2)
+                   : StringUtils::lastIndexOfUTF16(value, 0, str.value, 0, count, count2);
         }
-        else {
-            if (coder == LATIN1) {
-                return -1;
-            }
-            else {
-                gchar l = StringUtils::readLatin1CharAt(str.value, count2 - 1);
-                gint count = count1 - count2;
-                for (int i = count1 - 1; i >= count; --i) {
-                    gchar c1 = StringUtils::readUTF16CharAt(value, i);
-                    // Look for last character.
-                    if (c1 != l) {
-                        continue;
-                    }
-                    // Found first character, now look at the rest of value
-                    gint j = i - 1;
-                    for (int k = count2 - 2; k >= 0; --k, --j) {
-                        c1 = StringUtils::readUTF16CharAt(value, j);
-                        gchar c2 = StringUtils::readLatin1CharAt(str.value, k);
-                        if (c1 != c2) {
-                            break;
-                        }
-                    }
-                    if (j <= i - count2) {
-                        // Found whole string.
-                        return j + 1;
-                    }
-                }
-            }
+        if (coder == LATIN1) {
+            // The utf16 strings contain at least one character above 0xFF
+            return -1;
         }
-        return -1;
+        return StringUtils::lastIndexOfLatin1$UTF16(value, 0, str.value, 0, count, count2);
     }
 
     String String::subString(gint beginIndex) const
@@ -678,15 +819,27 @@ UTF16_STRING:
             Coder coder = coding();
 
             String str;
-            if (coder == LATIN1) {
-                str.coder = LATIN1;
-                str.value = StringUtils::copyOfLatin1(value, beginIndex, count2);
+            if (valueIsStatic) {
+                // Part of a string literal, refer to the same static storage
+                str.coder = coder;
+                str.value = value + (beginIndex << coder);
+                str.valueIsStatic = true;
+                str.count = count2;
+            }
+            else if (beginIndex == 0 && !isEmbedded() && count2 >= (EMBEDDED_LENGTH >> coder)) {
+                // Prefix of this string, share the buffer
+                str.coder = coder;
+                str.value = StringUtils::shareString(value);
+                str.count = count2;
+            }
+            else if (coder == LATIN1) {
+                str.allocate(LATIN1, count2);
+                StringUtils::copyLatin1(value, beginIndex, str.value, 0, count2);
             }
             else {
-                str.coder = UTF16;
-                str.value = StringUtils::copyOfUTF16(value, beginIndex, count2);
+                str.allocate(UTF16, count2);
+                StringUtils::copyUTF16(value, beginIndex, str.value, 0, count2);
             }
-            str.count = count2;
 
             return str;
         }
@@ -705,7 +858,30 @@ UTF16_STRING:
         }
     }
 
-    String String::concat(String const &str) const
+    void String::getChars(gint startIndex, gint endIndex, gchar dst[]) const
+    {
+        gint count = length();
+        if (startIndex < 0 || startIndex > endIndex || endIndex > count) {
+            IndexOutOfBoundsException("Range ["_S + String::valueOf(startIndex) + ", "_S + String::valueOf(endIndex)
+                                      + ") out of bounds for length "_S + String::valueOf(count))
+                    .throws($ftrace(""_S));
+        }
+        coding() == LATIN1
+        ? StringUtils::copyLatin1ToUTF16(value, startIndex, dst, 0, endIndex - startIndex)
+        : StringUtils::copyUTF16(value, startIndex, dst, 0, endIndex - startIndex);
+    }
+
+    gbyte const *String::latin1Span() const
+    {
+        return coding() == LATIN1 ? value : null;
+    }
+
+    gchar const *String::utf16Span() const
+    {
+        return coding() == UTF16 ? CORE_FCAST(CHARS, value) : null;
+    }
+
+    String String::concat(String const &str) const &
     {
         gint count1 = length();
         if (count1 == 0) {
@@ -727,31 +903,80 @@ UTF16_STRING:
         String newStr;
         if (coder == str.coding()) {
             if (coder == LATIN1) {
-                newStr.coder = LATIN1;
-                newStr.value = StringUtils::copyOfLatin1(value, 0, count1, count);
+                newStr.allocate(LATIN1, count);
+                StringUtils::copyLatin1(value, 0, newStr.value, 0, count1);
                 StringUtils::copyLatin1(str.value, 0, newStr.value, count1, count2);
             }
             else {
-                newStr.coder = UTF16;
-                newStr.value = StringUtils::copyOfUTF16(value, 0, count1, count);
+                newStr.allocate(UTF16, count);
+                StringUtils::copyUTF16(value, 0, newStr.value, 0, count1);
                 StringUtils::copyUTF16(str.value, 0, newStr.value, count1, count2);
             }
         }
         else {
-            newStr.coder = UTF16;
+            newStr.allocate(UTF16, count);
             if (coder == LATIN1) {
-                newStr.value = StringUtils::copyOfLatin1ToUTF16(value, 0, count1, count);
+                StringUtils::copyLatin1ToUTF16(value, 0, newStr.value, 0, count1);
                 StringUtils::copyUTF16(str.value, 0, newStr.value, count1, count2);
             }
             else {
-                newStr.value = StringUtils::copyOfUTF16(value, 0, count1, count);
+                StringUtils::copyUTF16(value, 0, newStr.value, 0, count1);
                 StringUtils::copyLatin1ToUTF16(str.value, 0, newStr.value, count1, count2);
             }
         }
+        gint hash1 = 0;
+        gint hash2 = 0;
+        if (cachedHash(hash1) && str.cachedHash(hash2)) {
+            newStr.cacheHash(combineHash(hash1, hash2, count2));
+        }
         return newStr;
     }
 
-    String String::replace(gchar oldChar, gchar newChar) const
+    String String::concat(String const &str) &&
+    {
+        gint count1 = length();
+        gint count2 = str.length();
+        if (count2 == 0) {
+            return CORE_CAST(String &&, *this);
+        }
+        if (count1 == 0 && !isWritable()) {
+            return str;
+        }
+
+        gint count = count1 + count2;
+        if (count < 0) {
+            OutOfMemoryError("Overflow: String length out of range."_S).throws($ftrace(""_S));
+        }
+
+        Coder coder2 = str.coding();
+        Coder coder = coding() == coder2 ? coder2 : UTF16;
+
+        // The hashes are read before this String changes, since it may be the given one
+        gint hash1 = 0;
+        gint hash2 = 0;
+        gbool hashIsKnown = cachedHash(hash1) && str.cachedHash(hash2);
+
+        // The storage of this String grows in place when possible. If the given
+        // String is this String, the reserved storage already contains its characters.
+        reserve(coder, count);
+        if (coder == coder2) {
+            coder == LATIN1
+            ? StringUtils::copyLatin1(str.value, 0, value, count1, count2)
+            : StringUtils::copyUTF16(str.value, 0, value, count1, count2);
+        }
+        else {
+            StringUtils::copyLatin1ToUTF16(str.value, 0, value, count1, count2);
+        }
+        String::count = count;
+        hashValue = 0;
+        hashIsZero = false;
+        if (hashIsKnown) {
+            cacheHash(combineHash(hash1, hash2, count2));
+        }
+        return CORE_CAST(String &&, *this);
+    }
+
+    String String::replace(gchar oldChar, gchar newChar) const &
     {
         gint count = length();
         if (count == 0) {
@@ -829,17 +1054,72 @@ UTF16_STRING:
                 return str;
             }
         }
-        return *this;
+        return *this;
+    }
+
+    String String::replace(gchar oldChar, gchar newChar) &&
+    {
+        gint count = length();
+        Coder coder = coding();
+        if (coder == LATIN1 && !StringUtils::isLatin1(oldChar)) {
+            return CORE_CAST(String &&, *this);
+        }
+        if (!isWritable()
+            || (coder == LATIN1 && !StringUtils::isLatin1(newChar))
+            || (COMPACT_STRINGS && coder == UTF16 && StringUtils::isLatin1(newChar))) {
+            // the coder of the result may be different
+            return replace(oldChar, newChar);
+        }
+        gbool replaced = false;
+        for (int i = 0; i < count; ++i) {
+            if (coder == LATIN1) {
+                if (StringUtils::readLatin1CharAt(value, i) == oldChar) {
+                    StringUtils::writeLatin1CharAt(value, i, newChar);
+                    replaced = true;
+                }
+            }
+            else if (StringUtils::readUTF16CharAt(value, i) == oldChar) {
+                StringUtils::writeUTF16CharAt(value, i, newChar);
+                replaced = true;
+            }
+        }
+        if (replaced) {
+            hashValue = 0;
+            hashIsZero = false;
+        }
+        return CORE_CAST(String &&, *this);
     }
 
     gbool String::contains(CharSequence const &s) const
     {
-        return (Class< String >::hasInstance(s))
-               ? indexOf(CORE_XCAST(String const, s)) >= 0
-               : indexOf(s.toString()) >= 0;
+        if (Class< String >::hasInstance(s)) {
+            return indexOf(CORE_XCAST(String const, s)) >= 0;
+        }
+        gint count1 = length();
+        gint count2 = s.length();
+        if (count2 == 0) {
+            return true;
+        }
+        if (count2 > count1) {
+            return false;
+        }
+        // the characters of the sequence are searched in its storage, without copy
+        Coder coder = coding();
+        BYTES latin1 = CORE_CAST(BYTES, s.latin1Span());
+        if (latin1 != null) {
+            return coder == LATIN1
+                   ? StringUtils::indexOfLatin1(value, 0, latin1, 0, count1, count2) >= 0
+                   : StringUtils::indexOfLatin1$UTF16(value, 0, latin1, 0, count1, count2) >= 0;
+        }
+        CHARS utf16 = CORE_CAST(CHARS, s.utf16Span());
+        if (utf16 != null && coder == UTF16) {
+            return StringUtils::indexOfUTF16(value, 0, CORE_CAST(BYTES, utf16), 0, count1, count2) >= 0;
+        }
+        // the utf16 characters of a sequence may all be latin1
+        return indexOf(s.toString()) >= 0;
     }
 
-    String String::replace(CharSequence const &target, CharSequence const &replacement) const
+    String String::replace(CharSequence const &target, CharSequence const &replacement) const &
     {
         gint count1 = length();
         if (count1 == 0) {
@@ -860,7 +1140,7 @@ UTF16_STRING:
                     str.append(str2).append(charAt(i));
                 }
                 str.append(str2);
-                return str.toString();
+                return str.build();
             }
             else if (count2 == 1 && count3 == 1) {
                 return replace(str1.charAt(0), str2.charAt(0));
@@ -1026,48 +1306,34 @@ UTF16_STRING:
         }
     }
 
-    String String::toLowerCase() const
+    String String::toLowerCase() const &
     {
         gint count = length();
         gint coder = coding();
 
         String str;
         if (coder == LATIN1) {
-            int i = 0;
-            for (; i < count; ++i) {
-                gchar c = StringUtils::readLatin1CharAt(value, i);
-                gchar c2 = CharacterDataLatin1::instance.toLowerCase(c);
-                if (c != c2) {
-                    break;
-                }
-            }
-            if (i == count) {
+            gint i = StringKernels::indexOfUpperCase(value, count);
+            if (i < 0) {
                 return *this;
             }
             str.coder = LATIN1;
             str.value = StringUtils::copyOfLatin1(value, 0, i, count);
-            for (int j = i; j < count; ++j) {
-                gchar c = StringUtils::readLatin1CharAt(value, j);
-                gchar c2 = CharacterDataLatin1::instance.toLowerCase(c);
-                if (!StringUtils::isLatin1(c2)) {
-                    // restart operation
-                    StringUtils::destroyLatin1String(str.value, count);
-                    str.value = StringUtils::copyOfLatin1ToUTF16(value, 0, i);
-                    str.coder = UTF16;
-                    for (int k = i; k < count; ++k) {
-                        gchar c = StringUtils::readLatin1CharAt(value, j);
-                        gchar c2 = CharacterDataLatin1::instance.toLowerCase(c);
-                        StringUtils::writeUTF16CharAt(str.value, k, c2);
-                    }
-                    break;
-                }
-                StringUtils::writeLatin1CharAt(str.value, j, c2);
-            }
+            // the lower case of the latin1 characters is always latin1
+            StringKernels::toLowerCase(value + i, str.value + i, count - i);
             str.count = count;
         }
         else {
+            CHARS chars = CORE_FCAST(CHARS, value);
             int i = 0;
-            for (; i < count;) {
+            while (i < count) {
+                // the latin1 runs are skipped by the kernel
+                gint j = StringKernels::indexOfUpperCase(chars + i, count - i);
+                if (j < 0) {
+                    i = count;
+                    break;
+                }
+                i += j;
                 gint c = StringUtils::readUTF32CharAt(value, i);
                 gint c2 = Character::toLowerCase(c);
                 if (c != c2) {
@@ -1078,70 +1344,130 @@ UTF16_STRING:
             if (i == count) {
                 return *this;
             }
-            str.coder = LATIN1;
+            str.coder = UTF16;
             str.value = StringUtils::copyOfUTF16(value, 0, i, count);
-            gint k = 0;
+            CHARS dst = CORE_FCAST(CHARS, str.value);
+            gint k = i;
+            // the result is compressed when all the characters above 0xFF have a latin1 lower case
+            gbool latin1 = COMPACT_STRINGS;
             for (int j = i; j < count;) {
+                // the latin1 runs are converted by the kernel, the other characters with the tables
+                gint n = StringKernels::toLowerCase(chars + j, dst + k, count - j);
+                j += n;
+                k += n;
+                if (j == count) {
+                    break;
+                }
                 gint c = StringUtils::readUTF32CharAt(value, j);
                 gint c2 = Character::toLowerCase(c);
+                latin1 = latin1 && StringUtils::isLatin1(c2);
                 if (Character::isSupplementary(c2)) {
                     StringUtils::writeUTF16CharAt(str.value, k + 0, Character::highSurrogate(c2));
                     StringUtils::writeUTF16CharAt(str.value, k + 1, Character::lowSurrogate(c2));
                     k += 2;
                 }
                 else {
-                    StringUtils::writeUTF16CharAt(str.value, j + 1, (gchar) c2);
+                    StringUtils::writeUTF16CharAt(str.value, k, (gchar) c2);
                     k += 1;
                 }
                 j += Character::charCount(c);
             }
             str.count = k;
+            if (latin1) {
+                String compact;
+                compact.allocate(LATIN1, k);
+                if (StringKernels::compressUTF16(dst, compact.value, k) == k) {
+                    return compact;
+                }
+            }
         }
         return str;
     }
 
-    String String::toUpperCase() const
+    String String::toLowerCase() &&
     {
         gint count = length();
-        gint coder = coding();
+        Coder coder = coding();
+        if (!isWritable()) {
+            return toLowerCase();
+        }
 
-        String str;
         if (coder == LATIN1) {
-            int i = 0;
-            for (; i < count; ++i) {
-                gchar c = StringUtils::readLatin1CharAt(value, i);
-                gchar c2 = CharacterDataLatin1::instance.toUpperCase(c);
-                if (c != c2) {
-                    break;
+            // the lower case of the latin1 characters is always latin1
+            StringKernels::toLowerCase(value, value, count);
+        }
+        else {
+            // the conversion is made in place only if each character keeps its length,
+            // and the result is not latin1 (the copy compresses the latin1 results)
+            gbool isLatin = COMPACT_STRINGS;
+            for (int i = 0; i < count;) {
+                gint c = StringUtils::readUTF32CharAt(value, i, count);
+                gint c2 = Character::toLowerCase(c);
+                if (Character::charCount(c) != Character::charCount(c2)) {
+                    return toLowerCase();
                 }
+                isLatin = isLatin && StringUtils::isLatin1(c2);
+                i += Character::charCount(c);
             }
-            if (i == count) {
+            if (isLatin) {
+                return toLowerCase();
+            }
+            for (int i = 0; i < count;) {
+                gint c = StringUtils::readUTF32CharAt(value, i, count);
+                gint c2 = Character::toLowerCase(c);
+                if (Character::isSupplementary(c2)) {
+                    StringUtils::writeUTF16CharAt(value, i + 0, Character::highSurrogate(c2));
+                    StringUtils::writeUTF16CharAt(value, i + 1, Character::lowSurrogate(c2));
+                }
+                else {
+                    StringUtils::writeUTF16CharAt(value, i, (gchar) c2);
+                }
+                i += Character::charCount(c);
+            }
+        }
+        hashValue = 0;
+        hashIsZero = false;
+        return CORE_CAST(String &&, *this);
+    }
+
+    String String::toUpperCase() const &
+    {
+        gint count = length();
+        gint coder = coding();
+
+        String str;
+        if (coder == LATIN1) {
+            gint i = StringKernels::indexOfLowerCase(value, count);
+            if (i < 0) {
                 return *this;
             }
             str.coder = LATIN1;
             str.value = StringUtils::copyOfLatin1(value, 0, i, count);
-            for (int j = i; j < count; ++j) {
-                gchar c = StringUtils::readLatin1CharAt(value, j);
-                gchar c2 = CharacterDataLatin1::instance.toUpperCase(c);
-                if (!StringUtils::isLatin1(c2)) {
-                    // restart operation
-                    StringUtils::destroyLatin1String(str.value, count);
-                    str.value = StringUtils::copyOfLatin1ToUTF16(value, 0, i);
-                    str.coder = UTF16;
-                    for (int k = i; k < count; ++k) {
-                        gchar c = StringUtils::readLatin1CharAt(value, j);
-                        gchar c2 = CharacterDataLatin1::instance.toUpperCase(c);
-                        StringUtils::writeUTF16CharAt(str.value, k, c2);
-                    }
-                    break;
+            gint j = i + StringKernels::toUpperCase(value + i, str.value + i, count - i);
+            if (j < count) {
+                // restart operation, 0xB5 and 0xFF have no latin1 upper case
+                StringUtils::destroyLatin1String(str.value, count);
+                str.value = StringUtils::copyOfLatin1ToUTF16(value, 0, i, count);
+                str.coder = UTF16;
+                for (int k = i; k < count; ++k) {
+                    gchar c = StringUtils::readLatin1CharAt(value, k);
+                    gchar c2 = CharacterDataLatin1::instance.toUpperCase(c);
+                    StringUtils::writeUTF16CharAt(str.value, k, c2);
                 }
-                StringUtils::writeLatin1CharAt(str.value, j, c2);
             }
             str.count = count;
         }
         else {
+            CHARS chars = CORE_FCAST(CHARS, value);
             int i = 0;
-            for (; i < count;) {
+            while (i < count) {
+                // the latin1 runs are skipped by the kernel
+                gint j = StringKernels::indexOfLowerCase(chars + i, count - i);
+                if (j < 0) {
+                    i = count;
+                    break;
+                }
+                i += j;
                 gint c = StringUtils::readUTF32CharAt(value, i);
                 gint c2 = Character::toUpperCase(c);
                 if (c != c2) {
@@ -1152,224 +1478,197 @@ UTF16_STRING:
             if (i == count) {
                 return *this;
             }
-            str.coder = LATIN1;
+            str.coder = UTF16;
             str.value = StringUtils::copyOfUTF16(value, 0, i, count);
-            gint k = 0;
+            CHARS dst = CORE_FCAST(CHARS, str.value);
+            gint k = i;
+            // the result is compressed when all the characters above 0xFF have a latin1 upper case
+            gbool latin1 = COMPACT_STRINGS;
             for (int j = i; j < count;) {
+                // the latin1 runs are converted by the kernel, the other characters with the tables
+                gint n = StringKernels::toUpperCase(chars + j, dst + k, count - j);
+                j += n;
+                k += n;
+                if (j == count) {
+                    break;
+                }
                 gint c = StringUtils::readUTF32CharAt(value, j);
                 gint c2 = Character::toUpperCase(c);
+                latin1 = latin1 && StringUtils::isLatin1(c2);
                 if (Character::isSupplementary(c2)) {
                     StringUtils::writeUTF16CharAt(str.value, k + 0, Character::highSurrogate(c2));
                     StringUtils::writeUTF16CharAt(str.value, k + 1, Character::lowSurrogate(c2));
                     k += 2;
                 }
                 else {
-                    StringUtils::writeUTF16CharAt(str.value, j + 1, (gchar) c2);
+                    StringUtils::writeUTF16CharAt(str.value, k, (gchar) c2);
                     k += 1;
                 }
                 j += Character::charCount(c);
             }
             str.count = k;
+            if (latin1) {
+                String compact;
+                compact.allocate(LATIN1, k);
+                if (StringKernels::compressUTF16(dst, compact.value, k) == k) {
+                    return compact;
+                }
+            }
         }
         return str;
     }
 
-    String String::trim() const
+    String String::toUpperCase() &&
     {
         gint count = length();
         Coder coder = coding();
+        if (!isWritable()) {
+            return toUpperCase();
+        }
+
         if (coder == LATIN1) {
-            // skip all leading spaces
-            gint i = 0;
-            for (; i < count; ++i) {
-                gchar c = StringUtils::readLatin1CharAt(value, i);
-                if (c > ' ') {
-                    break;
-                }
-            }
-            // skip all trailing spaces
-            gint j = count;
-            for (; j > i; --j) {
-                gchar c = StringUtils::readLatin1CharAt(value, j - 1);
-                if (c > ' ') {
-                    break;
-                }
+            // the conversion is made in place until the first character whose upper case
+            // is not latin1, the characters already converted keep the same upper case
+            if (StringKernels::toUpperCase(value, value, count) < count) {
+                hashValue = 0;
+                hashIsZero = false;
+                return toUpperCase();
             }
-            String str;
-            str.coder = LATIN1;
-            str.value = StringUtils::copyOfLatin1(value, i, j - i);
-            return str;
         }
         else {
-            // skip all leading spaces
-            gint i = 0;
-            for (; i < count; ++i) {
-                gchar c = StringUtils::readUTF16CharAt(value, i);
-                if (c > ' ') {
-                    break;
+            // the conversion is made in place only if each character keeps its length,
+            // and the result is not latin1 (the copy compresses the latin1 results)
+            gbool isLatin = COMPACT_STRINGS;
+            for (int i = 0; i < count;) {
+                gint c = StringUtils::readUTF32CharAt(value, i, count);
+                gint c2 = Character::toUpperCase(c);
+                if (Character::charCount(c) != Character::charCount(c2)) {
+                    return toUpperCase();
                 }
+                isLatin = isLatin && StringUtils::isLatin1(c2);
+                i += Character::charCount(c);
             }
-            // skip all trailing spaces
-            gint j = count;
-            for (; j > i; --j) {
-                gchar c = StringUtils::readUTF16CharAt(value, j - 1);
-                if (c > ' ') {
-                    break;
+            if (isLatin) {
+                return toUpperCase();
+            }
+            for (int i = 0; i < count;) {
+                gint c = StringUtils::readUTF32CharAt(value, i, count);
+                gint c2 = Character::toUpperCase(c);
+                if (Character::isSupplementary(c2)) {
+                    StringUtils::writeUTF16CharAt(value, i + 0, Character::highSurrogate(c2));
+                    StringUtils::writeUTF16CharAt(value, i + 1, Character::lowSurrogate(c2));
+                }
+                else {
+                    StringUtils::writeUTF16CharAt(value, i, (gchar) c2);
                 }
+                i += Character::charCount(c);
             }
-            String str;
-            str.coder = LATIN1;
-            str.value = StringUtils::copyOfLatin1(value, i, j - i);
-            return str;
         }
+        hashValue = 0;
+        hashIsZero = false;
+        return CORE_CAST(String &&, *this);
     }
 
-    String String::strip() const
+    String String::trim() const &
     {
         gint count = length();
         Coder coder = coding();
-        if (coder == LATIN1) {
-            // skip all leading spaces
-            gint i = 0;
-            for (; i < count; ++i) {
-                gchar c = StringUtils::readLatin1CharAt(value, i);
-                if (c == ' ' || c == '\t' || !CharacterDataLatin1::instance.isWhitespace(c)) {
-                    break;
-                }
-            }
-            // skip all trailing spaces
-            gint j = count;
-            for (; j > i; --j) {
-                gchar c = StringUtils::readLatin1CharAt(value, j - 1);
-                if (c == ' ' || c == '\t' || !CharacterDataLatin1::instance.isWhitespace(c)) {
-                    break;
-                }
-            }
-            String str;
-            str.coder = LATIN1;
-            str.value = StringUtils::copyOfLatin1(value, i, j - i);
-            return str;
+        // skip all leading spaces
+        gint i = coder == LATIN1
+                 ? StringUtils::indexOfNonSpaceLatin1(value, 0, count)
+                 : StringUtils::indexOfNonSpaceUTF16(value, 0, count);
+        if (i < 0) {
+            return count == 0 ? *this : String();
+        }
+        // skip all trailing spaces
+        gint j = 1 + (coder == LATIN1
+                      ? StringUtils::lastIndexOfNonSpaceLatin1(value, i, count - i)
+                      : StringUtils::lastIndexOfNonSpaceUTF16(value, i, count - i));
+        return i == 0 && j == count ? *this : subString(i, j);
+    }
+
+    String String::trim() &&
+    {
+        if (!isWritable()) {
+            return trim();
+        }
+        gint count = length();
+        Coder coder = coding();
+        // skip all leading spaces
+        gint i = coder == LATIN1
+                 ? StringUtils::indexOfNonSpaceLatin1(value, 0, count)
+                 : StringUtils::indexOfNonSpaceUTF16(value, 0, count);
+        // skip all trailing spaces
+        gint j = count;
+        if (i < 0) {
+            i = count;
         }
         else {
-            // skip all leading spaces
-            gint i = 0;
-            for (; i < count; ++i) {
-                gchar c = StringUtils::readUTF16CharAt(value, i);
-                if (c == ' ' || c == '\t' || !Character::isWhitespace(c)) {
-                    break;
-                }
-            }
-            // skip all trailing spaces
-            gint j = count;
-            for (; j > i; --j) {
-                gchar c = StringUtils::readUTF16CharAt(value, j - 1);
-                if (c == ' ' || c == '\t' || !Character::isWhitespace(c)) {
-                    break;
-                }
-            }
-            String str;
-            str.coder = LATIN1;
-            str.value = StringUtils::copyOfLatin1(value, i, j - i);
-            return str;
+            j = 1 + (coder == LATIN1
+                     ? StringUtils::lastIndexOfNonSpaceLatin1(value, i, count - i)
+                     : StringUtils::lastIndexOfNonSpaceUTF16(value, i, count - i));
         }
+        if (i > 0 || j < count) {
+            // the remaining characters are moved to the beginning of the storage
+            coder == LATIN1
+            ? StringUtils::copyLatin1(value, i, value, 0, j - i)
+            : StringUtils::copyUTF16(value, i, value, 0, j - i);
+            coder == LATIN1
+            ? StringUtils::writeLatin1CharAt(value, j - i, 0)
+            : StringUtils::writeUTF16CharAt(value, j - i, 0);
+            String::count = j - i;
+            hashValue = 0;
+            hashIsZero = false;
+        }
+        return CORE_CAST(String &&, *this);
+    }
+
+    String String::strip() const
+    {
+        gint count = length();
+        Coder coder = coding();
+        // skip all leading spaces
+        gint i = coder == LATIN1
+                 ? StringUtils::indexOfNonWhitespaceLatin1(value, 0, count)
+                 : StringUtils::indexOfNonWhitespaceUTF16(value, 0, count);
+        if (i < 0) {
+            return count == 0 ? *this : String();
+        }
+        // skip all trailing spaces
+        gint j = 1 + (coder == LATIN1
+                      ? StringUtils::lastIndexOfNonWhitespaceLatin1(value, i, count - i)
+                      : StringUtils::lastIndexOfNonWhitespaceUTF16(value, i, count - i));
+        return i == 0 && j == count ? *this : subString(i, j);
     }
 
     String String::stripLeading() const
     {
         gint count = length();
         Coder coder = coding();
-        if (coder == LATIN1) {
-            // skip all leading spaces
-            gint i = 0;
-            for (; i < count; ++i) {
-                gchar c = StringUtils::readLatin1CharAt(value, i);
-                if (c == ' ' || c == '\t' || !CharacterDataLatin1::instance.isWhitespace(c)) {
-                    break;
-                }
-            }
-            gint j = count;
-            String str;
-            str.coder = LATIN1;
-            str.value = StringUtils::copyOfLatin1(value, i, j - i);
-            return str;
-        }
-        else {
-            // skip all leading spaces
-            gint i = 0;
-            for (; i < count; ++i) {
-                gchar c = StringUtils::readUTF16CharAt(value, i);
-                if (c == ' ' || c == '\t' || !Character::isWhitespace(c)) {
-                    break;
-                }
-            }
-            gint j = count;
-            String str;
-            str.coder = LATIN1;
-            str.value = StringUtils::copyOfLatin1(value, i, j - i);
-            return str;
-        }
+        // skip all leading spaces
+        gint i = coder == LATIN1
+                 ? StringUtils::indexOfNonWhitespaceLatin1(value, 0, count)
+                 : StringUtils::indexOfNonWhitespaceUTF16(value, 0, count);
+        return i == 0 ? *this : i < 0 ? String() : subString(i);
     }
 
     String String::stripTrailing() const
     {
         gint count = length();
         Coder coder = coding();
-        if (coder == LATIN1) {
-            // skip all leading spaces
-            gint i = 0;
-            // skip all trailing spaces
-            gint j = count;
-            for (; j > i; --j) {
-                gchar c = StringUtils::readLatin1CharAt(value, j - 1);
-                if (c == ' ' || c == '\t' || !CharacterDataLatin1::instance.isWhitespace(c)) {
-                    break;
-                }
-            }
-            String str;
-            str.coder = LATIN1;
-            str.value = StringUtils::copyOfLatin1(value, i, j - i);
-            return str;
-        }
-        else {
-            // skip all leading spaces
-            gint i = 0;
-            // skip all trailing spaces
-            gint j = count;
-            for (; j > i; --j) {
-                gchar c = StringUtils::readUTF16CharAt(value, j - 1);
-                if (c == ' ' || c == '\t' || !Character::isWhitespace(c)) {
-                    break;
-                }
-            }
-            String str;
-            str.coder = LATIN1;
-            str.value = StringUtils::copyOfLatin1(value, i, j - i);
-            return str;
-        }
+        // skip all trailing spaces
+        gint j = 1 + (coder == LATIN1
+                      ? StringUtils::lastIndexOfNonWhitespaceLatin1(value, 0, count)
+                      : StringUtils::lastIndexOfNonWhitespaceUTF16(value, 0, count));
+        return j == count ? *this : subString(0, j);
     }
 
     gbool String::isBlank() const
     {
         gint count = length();
-        Coder coder = coding();
-        gint i = 0;
-        if (coder == LATIN1) {
-            for (; i < count; ++i) {
-                gchar c = StringUtils::readLatin1CharAt(value, i);
-                if (c == ' ' || c == '\t' || !CharacterDataLatin1::instance.isWhitespace(c)) {
-                    break;
-                }
-            }
-        }
-        else {
-            for (; i < count; ++i) {
-                gchar c = StringUtils::readUTF16CharAt(value, i);
-                if (c == ' ' || c == '\t' || !Character::isWhitespace(c)) {
-                    break;
-                }
-            }
-        }
-        return i == count;
+        return (coding() == LATIN1
+                ? StringUtils::indexOfNonWhitespaceLatin1(value, 0, count)
+                : StringUtils::indexOfNonWhitespaceUTF16(value, 0, count)) < 0;
     }
 
     String String::translateEscapes() const
@@ -1468,7 +1767,16 @@ UTF16_STRING:
 
     String String::valueOf(gchar c)
     {
-        return Character::toString(c);
+        String str;
+        if (COMPACT_STRINGS && StringUtils::isLatin1(c)) {
+            str.allocate(LATIN1, 1);
+            StringUtils::writeLatin1CharAt(str.value, 0, c);
+        }
+        else {
+            str.allocate(UTF16, 1);
+            StringUtils::writeUTF16CharAt(str.value, 0, c);
+        }
+        return str;
     }
 
     String String::valueOf(gint i)
@@ -1491,7 +1799,7 @@ UTF16_STRING:
         return Double::toString(d);
     }
 
-    String String::repeat(gint nb) const
+    String String::repeat(gint nb) const &
     {
         if (nb < 0) {
             IllegalArgumentException("Negative number of repetition"_S).throws($ftrace(""_S));
@@ -1533,6 +1841,51 @@ UTF16_STRING:
         }
     }
 
+    String String::repeat(gint nb) &&
+    {
+        if (nb < 0) {
+            IllegalArgumentException("Negative number of repetition"_S).throws($ftrace(""_S));
+        }
+
+        if (nb == 1) {
+            return CORE_CAST(String &&, *this);
+        }
+
+        gint count = length();
+        if (count == 0 || nb == 0) {
+            return ""_S;
+        }
+
+        Coder coder = coding();
+
+        try {
+            gint count2 = Math::multiplyExact(count, nb);
+            if (count2 > capacity() || !isWritable()) {
+                // the final length is known, the storage is allocated exactly (reserve would add a margin)
+                String str;
+                str.allocate(coder, count2);
+                coder == LATIN1
+                ? StringUtils::copyLatin1(value, 0, str.value, 0, count)
+                : StringUtils::copyUTF16(value, 0, str.value, 0, count);
+                *this = CORE_CAST(String &&, str);
+            }
+            // the copied part doubles on each step
+            for (gint n = count; n < count2; n <<= 1) {
+                gint length = Math::min(n, count2 - n);
+                coder == LATIN1
+                ? StringUtils::copyLatin1(value, 0, value, n, length)
+                : StringUtils::copyUTF16(value, 0, value, n, length);
+            }
+            String::count = count2;
+            hashValue = 0;
+            hashIsZero = false;
+            return CORE_CAST(String &&, *this);
+        }
+        catch (ArithmeticException const &ex) {
+            OutOfMemoryError("Overflow: Required String length exceeds implementation limit"_S).throws($ftrace(""_S));
+        }
+    }
+
     String String::valueOf(CharArray const &data)
     {
         return valueOf(data, 0, data.length());
@@ -1564,7 +1917,7 @@ UTF16_STRING:
             if (coder == LATIN1) {
                 str.coder = LATIN1;
                 str.value = StringUtils::copyOfLatin1(value, 0, count1, count);
-                StringUtils::copyLatin1(bytes, 0, str.value, count, count2);
+                StringUtils::copyLatin1(bytes, 0, str.value, count1, count2);
             }
             else {
                 str.coder = UTF16;
@@ -1606,7 +1959,7 @@ UTF16_STRING:
                 str.coder = UTF16;
                 str.value = StringUtils::copyOfUTF16(value, 0, count1, count);
             }
-            StringUtils::copyUTF16(bytes, 0, str.value, count1, count2);
+            StringUtils::copyUTF16(chars, 0, str.value, count1, count2);
             str.count = count;
             return str;
         }
@@ -1680,4 +2033,62 @@ UTF16_STRING:
         }
     }
 
+    String String::newConcatString(glong count, Coder coder)
+    {
+        if (count > Integer::MAX_VALUE) {
+            OutOfMemoryError("Overflow: Required String length exceed implementation limit."_S).throws($ftrace(""_S));
+        }
+        String str;
+        str.allocate(coder, (gint) count);
+        return str;
+    }
+
+    gint String::copyTo(String &dst, gint offset) const
+    {
+        gint count = length();
+        if (coding() == dst.coder) {
+            dst.coder == LATIN1
+            ? StringUtils::copyLatin1(value, 0, dst.value, offset, count)
+            : StringUtils::copyUTF16(value, 0, dst.value, offset, count);
+        }
+        else {
+            StringUtils::copyLatin1ToUTF16(value, 0, dst.value, offset, count);
+        }
+        return offset + count;
+    }
+
+    gbool String::cachedHash(gint &hash) const
+    {
+        if (hashValue != 0 || hashIsZero) {
+            hash = hashValue;
+            return true;
+        }
+        return false;
+    }
+
+    void String::cacheHash(gint hash) const
+    {
+        if (hash == 0) {
+            hashIsZero = true;
+        }
+        else {
+            hashValue = hash;
+        }
+    }
+
+    gint String::combineHash(gint hash1, gint hash2, gint count2)
+    {
+        // 31^count2, by square and multiply
+        misc::__uint32_t power = 1;
+        misc::__uint32_t base = 31;
+        while (count2 > 0) {
+            if ((count2 & 1) != 0) {
+                power *= base;
+            }
+            base *= base;
+            count2 >>= 1;
+        }
+        return (gint) ((misc::__uint32_t) hash1 * power + (misc::__uint32_t) hash2);
+    }
+
 } // core
@@ -22,9 +22,19 @@ namespace core
 
         CORE_ADD_AS_FRIEND(::core::misc::Foreign);
         CORE_ADD_AS_FRIEND(::core::XString);
+        CORE_ADD_AS_FRIEND(::core::StringSlice);
+        CORE_ADD_AS_FRIEND(::core::SegmentedXString);
+        CORE_ADD_AS_FRIEND(String operator ""_S(misc::__literal_chr_t const *, misc::__memory_size_t));
+        CORE_ADD_AS_FRIEND(String operator ""_S(misc::__ucs2_t const *, misc::__memory_size_t));
+        CORE_ADD_AS_FRIEND(String operator ""_S(misc::__ucs4_t const *, misc::__memory_size_t));
+
+        template<class Lhs, class Rhs>
+        friend class StringConcat;
 
         class StringUtils;
 
+        class StringTable;
+
     private:
         /**
          * The array used for characters storage.
@@ -62,9 +72,64 @@ namespace core
          */
         static CORE_FAST gbool COMPACT_STRINGS = CORE_HAS_COMPACT_STRINGS;
 
+        /**
+         * The storage of the short Strings (up to 15 latin1 characters or
+         * 7 utf16 characters followed by a null character). When it is used,
+         * the @c value field points on it.
+         */
+        glong embedded[2] = {};
+
+        /**
+         * The number of bytes of the embedded storage.
+         */
+        static CORE_FAST gint EMBEDDED_LENGTH = 16;
+
+        /**
+         * True if the bytes in the @c value field are in static
+         * storage (string literals). Such bytes are never released.
+         */
+        gbool valueIsStatic = false;
+
 
         Coder coding() const;
 
+        /**
+         * Return true if the bytes in the @c value field are stored
+         * in this String object.
+         */
+        gbool isEmbedded() const;
+
+        /**
+         * Set the storage of this String to hold the given number of characters
+         * encoded with the given coder. The short strings use the embedded storage.
+         * The previous storage must be released before.
+         */
+        void allocate(Coder coder, gint count);
+
+        /**
+         * Release the storage of this String. After this call, this String is empty.
+         */
+        void release();
+
+        /**
+         * Return true if the characters storage of this String is owned only
+         * by this String, and so it may be modified in place.
+         */
+        gbool isWritable() const;
+
+        /**
+         * Return the number of characters that the characters storage
+         * of this String may contain.
+         */
+        gint capacity() const;
+
+        /**
+         * Make the characters storage of this String writable, encoded with
+         * the given coder and large enough to contain the given number of
+         * characters. The current characters are preserved.
+         */
+        void reserve(Coder coder, gint minCapacity);
+
     public:
         /**
          * Initializes a newly created @c String object so that it represents
@@ -194,6 +259,16 @@ namespace core
          */
         String &operator=(String const &other);
 
+        /**
+         * Set this String content with given String. The characters
+         * storage of the given String is transferred to this String and
+         * the given String becomes empty.
+         *
+         * @param other A @c String
+         * @return itself
+         */
+        String &operator=(String &&other) CORE_NOTHROW;
+
         /**
          * Return the length of this String. The length
          * is equals to the number of unicode code unit in this String
@@ -268,6 +343,37 @@ namespace core
          */
         gint codePointCount(gint beginIndex, gint endIndex) const;
 
+        /**
+         * Returns the index within this @c String that is
+         * offset from the given @c index by
+         * @c codePointOffset code points. Unpaired surrogates
+         * within the text range given by @c index and
+         * @c codePointOffset count as one code point each.
+         *
+         * @param index the index to be offset
+         * @param codePointOffset the offset in code points
+         * @return the index within this @c String
+         * @throws IndexOutOfBoundsException if @c index
+         *   is negative or larger then the length of this
+         *   @c String, or if @c codePointOffset is positive
+         *   and the substring starting with @c index has fewer
+         *   than @c codePointOffset code points,
+         *   or if @c codePointOffset is negative and the substring
+         *   before @c index has fewer than the absolute value
+         *   of @c codePointOffset code points.
+         */
+        gint offsetByCodePoints(gint index, gint codePointOffset) const;
+
+        /**
+         * Converts this string to a new array of Unicode code points. Each
+         * surrogate pair gives one supplementary code point, and each unpaired
+         * surrogate gives one code point.
+         *
+         * @return  a newly allocated array whose length is the number of code
+         *          points of this string.
+         */
+        IntArray toCodePoints() const;
+
         /**
          * Copies characters from this string into the destination character
          * array.
@@ -321,6 +427,50 @@ namespace core
          */
         void toBytes(gint beginIndex, gint endIndex, ByteArray &dest, gint offset);
 
+        /**
+         * Returns the number of bytes of this string encoded in utf8, that is the
+         * length of the array returned by @c toUtf8(). The unpaired surrogates
+         * are counted as the single byte @c '?'.
+         *
+         * @return  the length of this string encoded in utf8.
+         */
+        glong utf8Length() const;
+
+        /**
+         * Encodes this string into a new byte array using the utf8 encoding.
+         * Each unpaired surrogate is encoded as @c '?'.
+         *
+         * @return  a newly allocated byte array of length @c utf8Length()
+         * @throws  OutOfMemoryError If the encoded string is too large for an array
+         */
+        ByteArray toUtf8() const;
+
+        /**
+         * Encodes this string using the utf8 encoding into the destination byte
+         * array, starting at index @c offset, and returns the number of written bytes.
+         *
+         * @param  dest The destination array
+         * @param  offset The start offset in the destination array
+         * @return  the number of written bytes, that is @c utf8Length()
+         * @throws  IndexOutOfBoundsException If @c offset is negative or if
+         *            @c offset+utf8Length() is larger than @c dest.length()
+         */
+        gint encodeUtf8Into(ByteArray &dest, gint offset) const;
+
+        /**
+         * Encodes this string using the utf8 encoding into the given buffer,
+         * starting at index @c offset, and returns the number of written bytes.
+         * The buffer is written in place, no intermediate array is allocated.
+         *
+         * @param  dest The destination buffer
+         * @param  offset The start offset in the destination buffer
+         * @param  capacity The number of bytes of the destination buffer
+         * @return  the number of written bytes, that is @c utf8Length()
+         * @throws  IndexOutOfBoundsException If @c offset is negative or if
+         *            @c offset+utf8Length() is larger than @c capacity
+         */
+        gint encodeUtf8Into(gbyte dest[], gint offset, gint capacity) const;
+
         /**
          * Compares this string to the specified object.  The result is @c true
          * if and only if the argument is not @c null and is a @c String object
@@ -374,6 +524,44 @@ namespace core
          */
         gint compareTo(String const &anotherString) const override;
 
+        /**
+         * Compares this @c String to another @c String, ignoring case
+         * considerations.  Two strings are considered equal ignoring case if they
+         * are of the same length and corresponding characters in the two strings
+         * are equal ignoring case.
+         * <p>
+         * Two characters @c c1 and @c c2 are considered the same
+         * ignoring case if at least one of the following is true:
+         * <ul>
+         *   <li> The two characters are the same (as compared by the @c == operator)
+         *   <li> Calling @c Character::toLowerCase(Character::toUpperCase(gint))
+         *        on each character produces the same result
+         * </ul>
+         * <p>
+         * The latin1 letters are compared without building lower case copies of
+         * the strings.
+         *
+         * @param  anotherString The @c String to compare this @c String against
+         * @return  @c true if the argument represents an equivalent @c String
+         *          ignoring case; @c false otherwise
+         */
+        gbool equalsIgnoreCase(String const &anotherString) const;
+
+        /**
+         * Compares two strings lexicographically, ignoring case
+         * differences. This method returns an integer whose sign is that of
+         * calling @c compareTo with case folded versions of the strings
+         * where case differences have been eliminated by calling
+         * @c Character::toLowerCase(Character::toUpperCase(gint)) on
+         * each character.
+         *
+         * @param   str   the @c String to be compared.
+         * @return  a negative integer, zero, or a positive integer as the
+         *          specified String is greater than, equal to, or less
+         *          than this String, ignoring case considerations.
+         */
+        gint compareToIgnoreCase(String const &str) const;
+
         /**
          * Tests if the substring of this string beginning at the
          * specified index starts with the specified prefix.
@@ -420,6 +608,80 @@ namespace core
          */
         gbool endsWith(String const &suffix) const;
 
+        /**
+         * Tests if two string regions are equal.
+         * <p>
+         * A substring of this @c String object is compared to a substring
+         * of the argument other. The result is true if these substrings
+         * represent identical character sequences. The substring of this
+         * @c String object to be compared begins at index @c toffset
+         * and has length @c len. The substring of other to be compared
+         * begins at index @c ooffset and has length @c len. The
+         * result is @c false if and only if at least one of the following
+         * is true:
+         * <ul><li>@c toffset is negative.
+         * <li>@c ooffset is negative.
+         * <li>@c toffset+len is greater than the length of this
+         * @c String object.
+         * <li>@c ooffset+len is greater than the length of the other
+         * argument.
+         * <li>There is some nonnegative integer @a k less than @c len
+         * such that:
+         * @code this.charAt(toffset + k) != other.charAt(ooffset + k) @endcode
+         * </ul>
+         *
+         * @param   toffset   the starting offset of the subregion in this string.
+         * @param   other     the string argument.
+         * @param   ooffset   the starting offset of the subregion in the string
+         *                    argument.
+         * @param   len       the number of characters to compare.
+         * @return  @c true if the specified subregion of this string
+         *          exactly matches the specified subregion of the string argument;
+         *          @c false otherwise.
+         */
+        gbool regionMatches(gint toffset, String const &other, gint ooffset, gint len) const;
+
+        /**
+         * Tests if two string regions are equal.
+         * <p>
+         * A substring of this @c String object is compared to a substring
+         * of the argument @c other. The result is @c true if these
+         * substrings represent character sequences that are the same, ignoring
+         * case if and only if @c ignoreCase is true.
+         * The sequences @c tsequence and @c osequence are compared,
+         * where @c tsequence is the sequence produced as if by calling
+         * @c this.subString(toffset, toffset + len) and @c osequence is
+         * the sequence produced as if by calling
+         * @c other.subString(ooffset, ooffset + len).
+         * The result is @c true if and only if all of the following
+         * are true:
+         * <ul><li>@c toffset is non-negative.
+         *   <li>@c ooffset is non-negative.
+         *   <li>@c toffset+len is less than or equal to the length of this
+         *   @c String object.
+         *   <li>@c ooffset+len is less than or equal to the length of the
+         *   @c other argument.
+         *   <li>if @c ignoreCase is @c false, all pairs of corresponding
+         *   characters are equal; if @c ignoreCase is @c true, all pairs of
+         *   corresponding characters are equal as defined by @c equalsIgnoreCase.
+         * </ul>
+         *
+         * @param   ignoreCase   if @c true, ignore case when comparing
+         *                       characters.
+         * @param   toffset      the starting offset of the subregion in this
+         *                       string.
+         * @param   other        the string argument.
+         * @param   ooffset      the starting offset of the subregion in the string
+         *                       argument.
+         * @param   len          the number of characters to compare.
+         * @return  @c true if the specified subregion of this string
+         *          matches the specified subregion of the string argument;
+         *          @c false otherwise. Whether the matching is exact
+         *          or case insensitive depends on the @c ignoreCase
+         *          argument.
+         */
+        gbool regionMatches(gbool ignoreCase, gint toffset, String const &other, gint ooffset, gint len) const;
+
         /**
          * Returns a hash code for this string. The hash code for a
          * @c String object is computed as
@@ -563,6 +825,30 @@ namespace core
          */
         gint lastIndexOf(gint ch, gint fromIndex) const;
 
+        /**
+         * Returns the index within this string of the first occurrence of
+         * any of the characters of the specified string. The characters are
+         * compared as @c char values (Unicode code units).
+         *
+         * @param   chars   the characters to search for.
+         * @return  the index of the first character of this string that occurs
+         *          in @c chars, or @c -1 if there is no such character.
+         */
+        gint indexOfAny(String const &chars) const;
+
+        /**
+         * Returns the index within this string of the first occurrence of
+         * any of the characters of the specified string, starting the search
+         * at the specified index.
+         *
+         * @param   chars       the characters to search for.
+         * @param   fromIndex   the index to start the search from.
+         * @return  the index of the first character of this string, greater
+         *          than or equal to @c fromIndex, that occurs in @c chars,
+         *          or @c -1 if there is no such character.
+         */
+        gint indexOfAny(String const &chars, gint fromIndex) const;
+
         /**
          * Returns the index within this string of the first occurrence of the
          * specified substring.
@@ -707,6 +993,18 @@ namespace core
          */
         CharSequence &subSequence(gint startIndex, gint endIndex) const override;
 
+        /**
+         * Copies the characters of the specified range to the given buffer, by blocks.
+         *
+         * @see CharSequence::getChars(gint, gint, gchar[])
+         */
+        void getChars(gint startIndex, gint endIndex, gchar dst[]) const override;
+
+        gbyte const *latin1Span() const override;
+
+        gchar const *utf16Span() const override;
+
+
         /**
          * Concatenates the specified string to the end of this string.
          * <p>
@@ -728,7 +1026,14 @@ namespace core
          * @return  a string that represents the concatenation of this object's
          *          characters followed by the string argument's characters.
          */
-        String concat(String const &str) const;
+        String concat(String const &str) const &;
+
+        /**
+         * Same as @c concat(String) but used when this String is a temporary:
+         * the characters of @c str are appended on the characters storage of
+         * this String when it is not shared, the storage grows if needed.
+         */
+        String concat(String const &str) &&;
 
         /**
          * Returns a string resulting from replacing all occurrences of
@@ -759,7 +1064,14 @@ namespace core
          * @return  a string derived from this string by replacing every
          *          occurrence of @c oldChar with @c newChar.
          */
-        String replace(gchar oldChar, gchar newChar) const;
+        String replace(gchar oldChar, gchar newChar) const &;
+
+        /**
+         * Same as @c replace(gchar,gchar) but used when this String is a temporary:
+         * the characters are replaced in place when the characters storage of this
+         * String is not shared.
+         */
+        String replace(gchar oldChar, gchar newChar) &&;
 
         /**
          * Returns true if and only if this string contains the specified
@@ -783,7 +1095,7 @@ namespace core
          * @return  The resulting string
          *
          */
-        String replace(CharSequence const &target, CharSequence const &replacement) const;
+        String replace(CharSequence const &target, CharSequence const &replacement) const &;
 
         /**
          * Converts all of the characters in this @c String to lower
@@ -803,7 +1115,14 @@ namespace core
          *
          * @return  the @c String, converted to lowercase.
          */
-        String toLowerCase() const;
+        String toLowerCase() const &;
+
+        /**
+         * Same as @c toLowerCase() but used when this String is a temporary:
+         * the characters are converted in place when the characters storage of
+         * this String is not shared and the conversion keeps the String length.
+         */
+        String toLowerCase() &&;
 
         /**
          * Converts all of the characters in this @c String to upper
@@ -823,7 +1142,14 @@ namespace core
          *
          * @return  the @c String, converted to uppercase.
          */
-        String toUpperCase() const;
+        String toUpperCase() const &;
+
+        /**
+         * Same as @c toUpperCase() but used when this String is a temporary:
+         * the characters are converted in place when the characters storage of
+         * this String is not shared and the conversion keeps the String length.
+         */
+        String toUpperCase() &&;
 
         /**
          * Returns a string whose value is this string, with all leading
@@ -857,7 +1183,14 @@ namespace core
          *          and trailing space removed, or this string if it
          *          has no leading or trailing space.
          */
-        String trim() const;
+        String trim() const &;
+
+        /**
+         * Same as @c trim() but used when this String is a temporary:
+         * the remaining characters are moved in place when the characters
+         * storage of this String is not shared.
+         */
+        String trim() &&;
 
         /**
          * Returns a string whose value is this string, with all leading
@@ -1161,7 +1494,72 @@ namespace core
          *
          *
          */
-        String repeat(gint count) const;
+        String repeat(gint count) const &;
+
+        /**
+         * Same as @c repeat(gint) but used when this String is a temporary:
+         * the repetitions are appended on the characters storage of this String
+         * when it is not shared, the storage grows if needed.
+         */
+        String repeat(gint count) &&;
+
+        /**
+         * Returns a canonical representation for the string object.
+         * <p>
+         * A pool of strings, initially empty, is maintained privately by the
+         * class @c String.
+         * <p>
+         * When the intern method is invoked, if the pool already contains a
+         * string equal to this @c String object as determined by
+         * the @c equals(Object) method, then a string sharing the characters
+         * of the pooled one is returned. Otherwise, the characters of this
+         * @c String are added to the pool and this @c String is returned.
+         * <p>
+         * It follows that for any two strings @c s and @c t,
+         * @c s.intern().equals(t.intern()) is @c true if and only if
+         * @c s.equals(t) is @c true, and it is decided by a simple
+         * identity test of the characters storage.
+         * <p>
+         * The pool keeps weak references: the characters are removed from the
+         * pool as soon as the last string using them is destroyed. The short
+         * strings stored in the String object itself are never pooled.
+         *
+         * @return  a string that has the same contents as this string, but is
+         *          guaranteed to be from a pool of unique strings.
+         */
+        String intern() const;
+
+        /**
+         * Returns a string that has the same contents as this string, whose
+         * characters are overwritten with zeros when they are released, even
+         * if the secure wipe is disabled.
+         * <p>
+         * The copies of the returned string share its characters, and so they
+         * are also wiped. The strings derived from it (substrings, concatenations,
+         * ...) are not sensitive.
+         *
+         * @return  a string that has the same contents as this string.
+         */
+        String sensitive() const;
+
+        /**
+         * Enables or disables the wipe of the characters of all the strings
+         * when they are released. When disabled, only the characters of the
+         * sensitive strings are wiped.
+         * <p>
+         * The secure wipe is disabled by default, unless the library is built
+         * with @c CORE_HAS_SECURE_WIPE defined to 1.
+         *
+         * @param enabled True to wipe the characters of all the strings
+         * @see sensitive
+         */
+        static void setSecureWipe(gbool enabled);
+
+        /**
+         * Returns true if the characters of all the strings are wiped when
+         * they are released.
+         */
+        static gbool isSecureWipe();
 
         ~String() override;
 
@@ -1221,8 +1619,259 @@ namespace core
         String mixedConcat(CHARS chars, gint count2) const;
 
         String mixedConcat(INTS codePoints, gint count2) const;
+
+        /**
+         * Return a new String with storage for the given number of characters
+         * encoded with the given coder, used to materialize a concatenation.
+         *
+         * @throws OutOfMemoryError if the given number of characters
+         *          exceeds implementation limit.
+         */
+        static String newConcatString(glong count, Coder coder);
+
+        /**
+         * Copy the characters of this String in the storage of the given String,
+         * starting at the given index, and return the index following the last
+         * copied character.
+         */
+        gint copyTo(String &dst, gint offset) const;
+
+        /**
+         * Return true if the hash of this String is already computed,
+         * and store it in the given variable.
+         */
+        gbool cachedHash(gint &hash) const;
+
+        /**
+         * Store the given hash as the hash of this String.
+         */
+        void cacheHash(gint hash) const;
+
+        /**
+         * Return the hash of the concatenation of two Strings from the hash
+         * of each of them: hash1 * 31^count2 + hash2.
+         *
+         * @param hash1 The hash of the first String
+         * @param hash2 The hash of the second String
+         * @param count2 The length of the second String
+         */
+        static gint combineHash(gint hash1, gint hash2, gint count2);
+    };
+
+    /**
+     * The class @c StringConcat represents the lazy concatenation of two operands
+     * produced by the @c operator+ on Strings. The operands are Strings or others
+     * concatenations, in such way that a chain like @c a+b+c+d builds a tree of
+     * concatenations instead of intermediate Strings.
+     * <p>
+     * The characters are copied only once, when the concatenation is converted
+     * to String: the total length and the coder of the result are computed first,
+     * then all the operands are copied in a single storage.
+     *
+     * @note The operands are referenced, not copied. A concatenation must
+     *          be converted to String before the end of the full expression
+     *          that creates it, for this reason it can not be copied nor assigned
+     *          (an expression like @c "auto s = a + f();" does not compile).
+     */
+    template<class Lhs, class Rhs>
+    class StringConcat final
+    {
+        template<class L, class R>
+        friend class StringConcat;
+
+        CORE_ALIAS(Coder, String::Coder);
+
+    private:
+        /**
+         * The left operand (String, or concatenation)
+         */
+        Lhs lhs;
+
+        /**
+         * The right operand (String, or concatenation)
+         */
+        Rhs rhs;
+
+        static glong lengthOf(String const &str)
+        {
+            return str.length();
+        }
+
+        template<class L, class R>
+        static glong lengthOf(StringConcat< L, R > const &expr)
+        {
+            return expr.length();
+        }
+
+        static gbool isLatin1(String const &str)
+        {
+            return str.coding() == String::LATIN1;
+        }
+
+        template<class L, class R>
+        static gbool isLatin1(StringConcat< L, R > const &expr)
+        {
+            return isLatin1(expr.lhs) && isLatin1(expr.rhs);
+        }
+
+        static gint copyTo(String const &str, String &dst, gint offset)
+        {
+            return str.copyTo(dst, offset);
+        }
+
+        template<class L, class R>
+        static gint copyTo(StringConcat< L, R > const &expr, String &dst, gint offset)
+        {
+            return copyTo(expr.rhs, dst, copyTo(expr.lhs, dst, offset));
+        }
+
+        static String toString(String const &str)
+        {
+            return str;
+        }
+
+        template<class L, class R>
+        static String toString(StringConcat< L, R > const &expr)
+        {
+            return expr.toString();
+        }
+
+        static gbool cachedHash(String const &str, gint &hash)
+        {
+            return str.cachedHash(hash);
+        }
+
+        template<class L, class R>
+        static gbool cachedHash(StringConcat< L, R > const &expr, gint &hash)
+        {
+            return expr.cachedHash(hash);
+        }
+
+        /**
+         * Return true if the hash of each operand is already computed,
+         * and store the hash of this concatenation in the given variable.
+         */
+        gbool cachedHash(gint &hash) const
+        {
+            gint hash1 = 0;
+            gint hash2 = 0;
+            if (cachedHash(lhs, hash1) && cachedHash(rhs, hash2)) {
+                hash = String::combineHash(hash1, hash2, (gint) lengthOf(rhs));
+                return true;
+            }
+            return false;
+        }
+
+    public:
+        /**
+         * Initializes a newly created @c StringConcat object so that it
+         * represents the concatenation of the given operands.
+         */
+        CORE_IMPLICIT StringConcat(Lhs lhs, Rhs rhs) : lhs(lhs), rhs(rhs)
+        {
+        }
+
+        /**
+         * A concatenation references its operands, it is never copied.
+         */
+        StringConcat(StringConcat const &) = delete;
+
+        /**
+         * A concatenation references its operands, it is never assigned.
+         */
+        StringConcat &operator=(StringConcat const &) = delete;
+
+        /**
+         * Returns the number of characters of this concatenation.
+         */
+        glong length() const
+        {
+            return lengthOf(lhs) + lengthOf(rhs);
+        }
+
+        /**
+         * Returns a new String containing the characters of all the operands
+         * of this concatenation. The result is allocated once.
+         *
+         * @throws OutOfMemoryError if the length of the result exceeds
+         *          implementation limit.
+         */
+        String toString() const
+        {
+            glong count1 = lengthOf(lhs);
+            glong count2 = lengthOf(rhs);
+            if (count1 == 0) {
+                return toString(rhs);
+            }
+            if (count2 == 0) {
+                return toString(lhs);
+            }
+            Coder coder = isLatin1(lhs) && isLatin1(rhs) ? String::LATIN1 : String::UTF16;
+            String str = String::newConcatString(count1 + count2, coder);
+            copyTo(rhs, str, copyTo(lhs, str, 0));
+            gint hash = 0;
+            if (cachedHash(hash)) {
+                str.cacheHash(hash);
+            }
+            return str;
+        }
+
+        CORE_IMPLICIT operator String() const
+        {
+            return toString();
+        }
     };
 
+    /**
+     * Returns a concatenation of the given concatenation and the given String.
+     */
+    template<class L, class R>
+    StringConcat< StringConcat< L, R > const &, String const & > operator+(StringConcat< L, R > const &expr,
+                                                                            String const &str)
+    {
+        return {expr, str};
+    }
+
+    /**
+     * Returns a concatenation of the given String and the given concatenation.
+     */
+    template<class L, class R>
+    StringConcat< String const &, StringConcat< L, R > const & > operator+(String const &str,
+                                                                            StringConcat< L, R > const &expr)
+    {
+        return {str, expr};
+    }
+
+    /**
+     * Returns a concatenation of the given concatenations.
+     */
+    template<class L1, class R1, class L2, class R2>
+    StringConcat< StringConcat< L1, R1 > const &, StringConcat< L2, R2 > const & > operator+(
+            StringConcat< L1, R1 > const &lhs, StringConcat< L2, R2 > const &rhs)
+    {
+        return {lhs, rhs};
+    }
+
+    /**
+     * Returns a concatenation of the given concatenation and the String representation
+     * of the given value, the same as the one used by @c operator+ on Strings.
+     */
+    template<class T, class L, class R>
+    StringConcat< StringConcat< L, R > const &, String > operator+(StringConcat< L, R > const &expr, T const &value)
+    {
+        return {expr, String(String() + value)};
+    }
+
+    /**
+     * Returns a concatenation of the String representation of the given
+     * value and the given concatenation.
+     */
+    template<class T, class L, class R>
+    StringConcat< String, StringConcat< L, R > const & > operator+(T const &value, StringConcat< L, R > const &expr)
+    {
+        return {String(value + String()), expr};
+    }
+
 } // core
 
 #endif // CORE24_STRING_H
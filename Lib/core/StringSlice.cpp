@@ -0,0 +1,274 @@
+//
+// Created by bruns on 16/06/2024.
+//
+
+#include <core/StringSlice.h>
+#include <meta/StringUtils.h>
+#include <core/misc/Precondition.h>
+#include <core/misc/Foreign.h>
+#include <core/Math.h>
+#include <core/Character.h>
+#include <core/IndexOutOfBoundsException.h>
+
+namespace core
+{
+    using misc::Precondition;
+
+    StringSlice::StringSlice()
+    {
+        coder = String::COMPACT_STRINGS ? String::LATIN1 : String::UTF16;
+        value = StringUtils::newLatin1String(0);
+        offset = 0;
+        count = 0;
+    }
+
+    StringSlice::StringSlice(String const &str)
+    {
+        coder = str.coding();
+        value = str.value;
+        offset = 0;
+        count = str.length();
+        hashValue = str.hashValue;
+        hashIsZero = str.hashIsZero;
+    }
+
+    StringSlice::StringSlice(String const &str, gint beginIndex, gint endIndex)
+    {
+        try {
+            Precondition::checkIndexFromRange(beginIndex, endIndex, str.length());
+            coder = str.coding();
+            value = str.value;
+            offset = beginIndex;
+            count = endIndex - beginIndex;
+        }
+        catch (Exception const &ex) {
+            ex.throws($ftrace(""_S));
+        }
+    }
+
+    gint StringSlice::length() const
+    {
+        return count;
+    }
+
+    gbool StringSlice::isEmpty() const
+    {
+        return count == 0;
+    }
+
+    gchar StringSlice::charAt(gint index) const
+    {
+        try {
+            Precondition::checkIndex(index, count);
+            return coder == String::LATIN1
+                   ? StringUtils::readLatin1CharAt(value, offset + index)
+                   : StringUtils::readUTF16CharAt(value, offset + index);
+        }
+        catch (Exception const &ex) {
+            ex.throws($ftrace(""_S));
+        }
+    }
+
+    StringSlice StringSlice::slice(gint beginIndex, gint endIndex) const
+    {
+        try {
+            Precondition::checkIndexFromRange(beginIndex, endIndex, count);
+            StringSlice slice;
+            slice.coder = coder;
+            slice.value = value;
+            slice.offset = offset + beginIndex;
+            slice.count = endIndex - beginIndex;
+            return slice;
+        }
+        catch (Exception const &ex) {
+            ex.throws($ftrace(""_S));
+        }
+    }
+
+    CharSequence &StringSlice::subSequence(gint beginIndex, gint endIndex) const
+    {
+        try {
+            return *new StringSlice(slice(beginIndex, endIndex));
+        }
+        catch (Exception const &ex) {
+            ex.throws($ftrace(""_S));
+        }
+    }
+
+    void StringSlice::getChars(gint startIndex, gint endIndex, gchar dst[]) const
+    {
+        if (startIndex < 0 || startIndex > endIndex || endIndex > count) {
+            IndexOutOfBoundsException("Range ["_S + String::valueOf(startIndex) + ", "_S + String::valueOf(endIndex)
+                                      + ") out of bounds for length "_S + String::valueOf(count))
+                    .throws($ftrace(""_S));
+        }
+        coder == String::LATIN1
+        ? StringUtils::copyLatin1ToUTF16(value, offset + startIndex, dst, 0, endIndex - startIndex)
+        : StringUtils::copyUTF16(value, offset + startIndex, dst, 0, endIndex - startIndex);
+    }
+
+    gbyte const *StringSlice::latin1Span() const
+    {
+        return coder == String::LATIN1 ? value + offset : null;
+    }
+
+    gchar const *StringSlice::utf16Span() const
+    {
+        return coder == String::UTF16 ? CORE_FCAST(CHARS, value) + offset : null;
+    }
+
+    gint StringSlice::indexOf(gint ch) const
+    {
+        return indexOf(ch, 0);
+    }
+
+    gint StringSlice::indexOf(gint ch, gint fromIndex) const
+    {
+        fromIndex = Math::max(fromIndex, 0);
+        if (fromIndex >= count) {
+            return -1;
+        }
+        gint index = coder == String::LATIN1
+                     ? StringUtils::indexOfLatin1(value, offset + fromIndex, ch, count - fromIndex)
+                     : StringUtils::indexOfUTF16(value, offset + fromIndex, ch, count - fromIndex);
+        return index < 0 ? -1 : index - offset;
+    }
+
+    gint StringSlice::indexOf(StringSlice const &str) const
+    {
+        return indexOf(str, 0);
+    }
+
+    gint StringSlice::indexOf(StringSlice const &str, gint fromIndex) const
+    {
+        fromIndex = Math::clamp(fromIndex, 0, count);
+        gint count1 = count - fromIndex;
+        gint count2 = str.count;
+
+        if (count2 > count1) {
+            return -1;
+        }
+        if (count2 == 0) {
+            return fromIndex;
+        }
+
+        gint index = -1;
+        if (coder == str.coder) {
+            index = coder == String::LATIN1
+                    ? StringUtils::indexOfLatin1(value, offset + fromIndex, str.value, str.offset, count1, count2)
+                    : StringUtils::indexOfUTF16(value, offset + fromIndex, str.value, str.offset, count1, count2);
+        }
+        else if (coder == String::UTF16) {
+            index = StringUtils::indexOfLatin1$UTF16(value, offset + fromIndex, str.value, str.offset,
+                                                     count1, count2);
+        }
+        else {
+            // utf16 characters of a latin1-encoded slice view
+            for (int i = 0; i <= count1 - count2; ++i) {
+                if (StringUtils::compareLatin1ToUTF16(value, offset + fromIndex + i,
+                                                      str.value, str.offset, count2) == 0) {
+                    index = offset + fromIndex + i;
+                    break;
+                }
+            }
+        }
+        return index < 0 ? -1 : index - offset;
+    }
+
+    gint StringSlice::compareSlices(ARRAY val1, gint off1, Coder coder1, ARRAY val2, gint off2, Coder coder2,
+                                    gint count)
+    {
+        if (coder1 == coder2) {
+            return coder1 == String::LATIN1
+                   ? StringUtils::compareToLatin1(val1, off1, val2, off2, count)
+                   : StringUtils::compareToUTF16(val1, off1, val2, off2, count);
+        }
+        return coder1 == String::LATIN1
+               ? StringUtils::compareLatin1ToUTF16(val1, off1, val2, off2, count)
+               : StringUtils::compareUTF16ToLatin1(val1, off1, val2, off2, count);
+    }
+
+    gbool StringSlice::startsWith(StringSlice const &prefix) const
+    {
+        if (prefix.count > count) {
+            return false;
+        }
+        return compareSlices(value, offset, coder, prefix.value, prefix.offset, prefix.coder, prefix.count) == 0;
+    }
+
+    gbool StringSlice::endsWith(StringSlice const &suffix) const
+    {
+        if (suffix.count > count) {
+            return false;
+        }
+        return compareSlices(value, offset + count - suffix.count, coder,
+                             suffix.value, suffix.offset, suffix.coder, suffix.count) == 0;
+    }
+
+    gbool StringSlice::equals(Object const &obj) const
+    {
+        if (this == &obj) {
+            return true;
+        }
+        if (!Class< StringSlice >::hasInstance(obj)) {
+            return false;
+        }
+        StringSlice const &other = CORE_XCAST(StringSlice const, obj);
+        if (count != other.count) {
+            return false;
+        }
+        if (value == other.value && offset == other.offset) {
+            return true;
+        }
+        return compareSlices(value, offset, coder, other.value, other.offset, other.coder, count) == 0;
+    }
+
+    gint StringSlice::compareTo(StringSlice const &other) const
+    {
+        gint count1 = count;
+        gint count2 = other.count;
+        gint res = compareSlices(value, offset, coder, other.value, other.offset, other.coder,
+                                 Math::min(count1, count2));
+        return res != 0 ? res : count1 - count2;
+    }
+
+    gint StringSlice::hash() const
+    {
+        gint hash = hashValue;
+        if (hash == 0 && !hashIsZero) {
+            hash = coder == String::LATIN1
+                   ? StringUtils::hashLatin1String(value, offset, count)
+                   : StringUtils::hashUTF16String(value, offset, count);
+            hashIsZero = (hashValue = hash) == 0;
+        }
+        return hash;
+    }
+
+    String StringSlice::toString() const
+    {
+        String str;
+        if (coder == String::LATIN1) {
+            str.allocate(String::LATIN1, count);
+            StringUtils::copyLatin1(value, offset, str.value, 0, count);
+        }
+        else {
+            if (String::COMPACT_STRINGS) {
+                // The owning String must be latin1 if all characters can be compressed
+                CHARS chars = CORE_FCAST(CHARS, value);
+                gint i = 0;
+                while (i < count && StringUtils::isLatin1(chars[offset + i])) {
+                    i += 1;
+                }
+                if (i == count) {
+                    str.allocate(String::LATIN1, count);
+                    StringUtils::copyUTF16ToLatin1(value, offset, str.value, 0, count);
+                    return str;
+                }
+            }
+            str.allocate(String::UTF16, count);
+            StringUtils::copyUTF16(value, offset, str.value, 0, count);
+        }
+        return str;
+    }
+
+} // core
@@ -0,0 +1,261 @@
+//
+// Created by bruns on 16/06/2024.
+//
+
+#ifndef CORE24_STRINGSLICE_H
+#define CORE24_STRINGSLICE_H
+
+#include <core/String.h>
+
+namespace core
+{
+    /**
+     * The class @c StringSlice represents a read-only view on a range of
+     * characters of a @c String. A slice never copies the characters, it
+     * refers directly to the latin1 or utf16 bytes of the viewed String.
+     * <p>
+     * Because a slice does not own the characters, it must not outlive the
+     * String it refers to, and it is invalidated when this String is assigned
+     * or destroyed. Use @c toString() to obtain an owning copy of the characters.
+     * The short Strings store their characters inside the String object itself,
+     * so a slice of such a String must not outlive this String object, even if
+     * a copy of the String still exists. For the same reason, a slice can not be
+     * created on a temporary String.
+     * <p>
+     * Slices are intended for tokenizers and parsers that create many
+     * temporary substrings: creating, slicing and comparing slices never
+     * allocate memory.
+     *
+     * @note The hash of a slice is the same as the hash of the String
+     *          containing the same characters.
+     */
+    class StringSlice final : public virtual CharSequence, public virtual Comparable< StringSlice >
+    {
+        CORE_ALIAS(ARRAY, Class< gbyte >::Pointer);
+        CORE_ALIAS(BYTES, Class< gbyte >::Pointer);
+        CORE_ALIAS(CHARS, Class< gchar >::Pointer);
+
+        CORE_ALIAS(StringUtils, String::StringUtils);
+        CORE_ALIAS(Coder, String::Coder);
+
+    private:
+        /**
+         * The bytes of the viewed String.
+         */
+        ARRAY value = null;
+
+        /**
+         * The index of the first character of this slice on the @c value field.
+         */
+        gint offset = 0;
+
+        /**
+         * The number of 16 bits characters on this slice.
+         */
+        gint count = 0;
+
+        /**
+         * The identifier of the encoding used to encode
+         * the bytes in the @c value field.
+         */
+        Coder coder = String::LATIN1;
+
+        /**
+         * Cache of hash value for the slice
+         */
+        gint mutable hashValue = 0;
+
+        /**
+         * Cache if the hash has been calculated as actually being zero.
+         */
+        gbool mutable hashIsZero = false;
+
+        /**
+         * Compares the characters of two slices with the kernel corresponding to their coders.
+         */
+        static gint compareSlices(ARRAY val1, gint off1, Coder coder1, ARRAY val2, gint off2, Coder coder2, gint count);
+
+    public:
+        /**
+         * Initializes a newly created @c StringSlice object so that it
+         * represents an empty character sequence.
+         */
+        CORE_IMPLICIT StringSlice();
+
+        /**
+         * Initializes a newly created @c StringSlice object so that it
+         * represents all the characters of the given String.
+         *
+         * @param str The viewed String
+         */
+        CORE_IMPLICIT StringSlice(String const &str);
+
+        /**
+         * A slice can not view a temporary String, that is destroyed at the end
+         * of the full expression.
+         */
+        StringSlice(String &&str) = delete;
+
+        /**
+         * Initializes a newly created @c StringSlice object so that it
+         * represents the characters of the given String from index @c beginIndex
+         * (inclusive) to index @c endIndex (exclusive).
+         *
+         * @param str The viewed String
+         * @param beginIndex The beginning index, inclusive.
+         * @param endIndex The ending index, exclusive.
+         *
+         * @throws IndexOutOfBoundsException  if the @c beginIndex is negative, or
+         *          @c endIndex is larger than the length of the given String, or
+         *          @c beginIndex is larger than @c endIndex.
+         */
+        CORE_EXPLICIT StringSlice(String const &str, gint beginIndex, gint endIndex);
+
+        /**
+         * A slice can not view a temporary String, that is destroyed at the end
+         * of the full expression.
+         */
+        StringSlice(String &&str, gint beginIndex, gint endIndex) = delete;
+
+        /**
+         * Returns the length of this slice.
+         *
+         * @return the number of chars in this slice
+         */
+        gint length() const override;
+
+        /**
+         * Returns @c true if, and only if, @c length() is @c 0.
+         */
+        gbool isEmpty() const override;
+
+        /**
+         * Returns the @c char value at the specified index.
+         *
+         * @param index The index of the char value.
+         *
+         * @throws IndexOutOfBoundsException  if the @c index argument is negative or
+         *          not less than the length of this slice.
+         */
+        gchar charAt(gint index) const override;
+
+        /**
+         * Returns a slice that is a part of this slice. The returned slice refers to
+         * the same String as this slice.
+         *
+         * @param beginIndex The beginning index, inclusive.
+         * @param endIndex The ending index, exclusive.
+         *
+         * @throws IndexOutOfBoundsException  if the @c beginIndex is negative, or
+         *          @c endIndex is larger than the length of this slice, or
+         *          @c beginIndex is larger than @c endIndex.
+         */
+        StringSlice slice(gint beginIndex, gint endIndex) const;
+
+        /**
+         * Returns a slice that is a part of this slice.
+         *
+         * @param beginIndex The beginning index, inclusive.
+         * @param endIndex The ending index, exclusive.
+         *
+         * @throws IndexOutOfBoundsException  if the @c beginIndex is negative, or
+         *          @c endIndex is larger than the length of this slice, or
+         *          @c beginIndex is larger than @c endIndex.
+         */
+        CharSequence &subSequence(gint beginIndex, gint endIndex) const override;
+
+        /**
+         * Copies the characters of the specified range to the given buffer, by blocks.
+         *
+         * @see CharSequence::getChars(gint, gint, gchar[])
+         */
+        void getChars(gint startIndex, gint endIndex, gchar dst[]) const override;
+
+        gbyte const *latin1Span() const override;
+
+        gchar const *utf16Span() const override;
+
+
+        /**
+         * Returns the index within this slice of the first occurrence of
+         * the specified character (unicode code point), or @c -1 if the character
+         * does not occur.
+         *
+         * @param ch A character (Unicode code point).
+         */
+        gint indexOf(gint ch) const;
+
+        /**
+         * Returns the index within this slice of the first occurrence of
+         * the specified character (unicode code point), starting the search
+         * at the specified index, or @c -1 if the character does not occur.
+         *
+         * @param ch A character (Unicode code point).
+         * @param fromIndex The index to start the search from.
+         */
+        gint indexOf(gint ch, gint fromIndex) const;
+
+        /**
+         * Returns the index within this slice of the first occurrence of
+         * the specified sequence of characters, or @c -1 if it does not occur.
+         *
+         * @param str The characters to search for.
+         */
+        gint indexOf(StringSlice const &str) const;
+
+        /**
+         * Returns the index within this slice of the first occurrence of the
+         * specified sequence of characters, starting at the specified index,
+         * or @c -1 if it does not occur.
+         *
+         * @param str The characters to search for.
+         * @param fromIndex The index from which to start the search.
+         */
+        gint indexOf(StringSlice const &str, gint fromIndex) const;
+
+        /**
+         * Tests if this slice starts with the specified prefix.
+         *
+         * @param prefix The prefix.
+         */
+        gbool startsWith(StringSlice const &prefix) const;
+
+        /**
+         * Tests if this slice ends with the specified suffix.
+         *
+         * @param suffix The suffix.
+         */
+        gbool endsWith(StringSlice const &suffix) const;
+
+        /**
+         * Compares this slice to the specified object. The result is
+         * @c true if and only if the argument is a @c StringSlice
+         * that represents the same sequence of characters as this slice.
+         *
+         * @param obj The object to compare this slice against
+         */
+        gbool equals(Object const &obj) const override;
+
+        /**
+         * Compares two slices lexicographically, with the same rule
+         * as @c String::compareTo.
+         *
+         * @param other The slice to be compared.
+         */
+        gint compareTo(StringSlice const &other) const override;
+
+        /**
+         * Returns a hash code for this slice. The result is the same
+         * as the hash of the String containing the same characters.
+         */
+        gint hash() const override;
+
+        /**
+         * Returns a new String containing the characters of this slice.
+         */
+        String toString() const override;
+    };
+
+} // core
+
+#endif // CORE24_STRINGSLICE_H
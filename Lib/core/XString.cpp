@@ -5,10 +5,12 @@
 #include <core/XString.h>
 #include <core/Math.h>
 #include <core/IllegalArgumentException.h>
+#include <core/IndexOutOfBoundsException.h>
 #include <core/misc/Foreign.h>
 #include <core/misc/Precondition.h>
 #include <core/OutOfMemoryError.h>
 #include <meta/StringUtils.h>
+#include <meta/StringKernels.h>
 
 namespace core
 {
@@ -23,6 +25,46 @@ namespace core
                : String::UTF16;
     }
 
+    void XString::moveGap(gint index)
+    {
+        gint shift = limit - count;
+        if (gap < 0) {
+            // the contiguous characters have an empty gap at their end
+            gap = count;
+        }
+        if (coding() == String::LATIN1) {
+            index < gap
+            ? StringUtils::copyLatin1(value, index, value, index + shift, gap - index)
+            : StringUtils::copyLatin1(value, gap + shift, value, gap, index - gap);
+        }
+        else {
+            index < gap
+            ? StringUtils::copyUTF16(value, index, value, index + shift, gap - index)
+            : StringUtils::copyUTF16(value, gap + shift, value, gap, index - gap);
+        }
+        gap = index;
+    }
+
+    void XString::closeGap() const
+    {
+        if (gap >= 0) {
+            gint shift = limit - count;
+            coding() == String::LATIN1
+            ? StringUtils::copyLatin1(value, gap + shift, value, gap, count - gap)
+            : StringUtils::copyUTF16(value, gap + shift, value, gap, count - gap);
+            gap = -1;
+        }
+    }
+
+    void XString::inflate()
+    {
+        // the whole storage is converted, so that the gap stays at its place
+        ARRAY a = StringUtils::copyOfLatin1ToUTF16(value, 0, limit, limit);
+        StringUtils::destroyLatin1String(value, limit);
+        value = a;
+        coder = String::UTF16;
+    }
+
     XString::XString() : XString(16)
     {
     }
@@ -108,8 +150,97 @@ namespace core
         XString::append(seq);
     }
 
+    XString::XString(XString const &sb) : value(), count(), limit(), coder(), maybeLatin1(false)
+    {
+        sb.closeGap();
+        gint count = sb.length();
+        gint limit = sb.capacity();
+        Coder coder = sb.coding();
+        XString::value = coder == String::LATIN1
+                         ? StringUtils::copyOfLatin1(sb.value, 0, count, limit)
+                         : StringUtils::copyOfUTF16(sb.value, 0, count, limit);
+        XString::coder = coder;
+        XString::limit = limit;
+        XString::count = count;
+        XString::maybeLatin1 = sb.maybeLatin1;
+    }
+
+    XString &XString::operator=(XString const &sb)
+    {
+        if (this != &sb) {
+            sb.closeGap();
+            gint count = sb.length();
+            gint limit = sb.capacity();
+            Coder coder = sb.coding();
+            ARRAY a = coder == String::LATIN1
+                      ? StringUtils::copyOfLatin1(sb.value, 0, count, limit)
+                      : StringUtils::copyOfUTF16(sb.value, 0, count, limit);
+            coding() == String::LATIN1
+            ? StringUtils::destroyLatin1String(value, XString::limit)
+            : StringUtils::destroyUTF16String(value, XString::limit);
+            XString::value = a;
+            XString::coder = coder;
+            XString::limit = limit;
+            XString::count = count;
+            XString::maybeLatin1 = sb.maybeLatin1;
+            XString::gap = -1;
+        }
+        return *this;
+    }
+
+    XString::XString(XString &&sb) CORE_NOTHROW: value(), count(), limit(), coder(), maybeLatin1(false)
+    {
+        value = sb.value;
+        count = sb.count;
+        limit = sb.limit;
+        coder = sb.coder;
+        maybeLatin1 = sb.maybeLatin1;
+        gap = sb.gap;
+
+        sb.value = StringUtils::newLatin1String(0);
+        sb.count = 0;
+        sb.limit = 0;
+        sb.coder = String::COMPACT_STRINGS ? String::LATIN1 : String::UTF16;
+        sb.maybeLatin1 = false;
+        sb.gap = -1;
+    }
+
+    XString &XString::operator=(XString &&sb) CORE_NOTHROW
+    {
+        if (this != &sb) {
+            coding() == String::LATIN1
+            ? StringUtils::destroyLatin1String(value, limit)
+            : StringUtils::destroyUTF16String(value, limit);
+            value = sb.value;
+            count = sb.count;
+            limit = sb.limit;
+            coder = sb.coder;
+            maybeLatin1 = sb.maybeLatin1;
+            gap = sb.gap;
+
+            sb.value = StringUtils::newLatin1String(0);
+            sb.count = 0;
+            sb.limit = 0;
+            sb.coder = String::COMPACT_STRINGS ? String::LATIN1 : String::UTF16;
+            sb.maybeLatin1 = false;
+            sb.gap = -1;
+        }
+        return *this;
+    }
+
+    XString::~XString()
+    {
+        coding() == String::LATIN1
+        ? StringUtils::destroyLatin1String(value, limit)
+        : StringUtils::destroyUTF16String(value, limit);
+        count = 0;
+        limit = 0;
+    }
+
     gint XString::compareTo(XString const &another) const
     {
+        closeGap();
+        another.closeGap();
         gint count1 = length();
         gint count2 = another.length();
         gint count = Math::min(count1, count2);
@@ -251,6 +382,7 @@ namespace core
             gint count = length();
             Coder coder = coding();
             if (minLimit - oldLimit > 0) {
+                closeGap();
                 gint newLimit = newCapacity(minLimit);
                 if (coder == String::LATIN1) {
                     ARRAY newValue = StringUtils::copyOfLatin1(value, 0, count, newLimit);
@@ -301,6 +433,7 @@ namespace core
 
     void XString::trimToSize()
     {
+        closeGap();
         gint limit = capacity();
         gint count = length();
         Coder coder = coding();
@@ -329,6 +462,7 @@ namespace core
         if (newLength < 0) {
             IllegalArgumentException("Negative String length"_S).throws($ftrace(""_S));
         }
+        closeGap();
 
         gint limit = capacity();
         gint count = length();
@@ -361,6 +495,10 @@ namespace core
         Coder coder = coding();
         try {
             Precondition::checkIndex(index, count);
+            if (gap >= 0 && index >= gap) {
+                // the character follows the gap
+                index += limit - count;
+            }
             if (coder == String::LATIN1) {
                 return StringUtils::readLatin1CharAt(value, index);
             }
@@ -375,6 +513,7 @@ namespace core
 
     gint XString::codePointAt(gint index) const
     {
+        closeGap();
         gint count = length();
         Coder coder = coding();
         try {
@@ -393,6 +532,7 @@ namespace core
 
     void XString::toChars(gint srcBegin, gint srcEnd, CharArray &dst, gint dstBegin) const
     {
+        closeGap();
         gint count = length();
         Coder coder = coding();
         gint count2 = srcEnd - srcBegin;
@@ -418,6 +558,9 @@ namespace core
         Coder coder = coding();
         try {
             Precondition::checkIndex(index, count);
+            if (gap >= 0 && index >= gap) {
+                index += limit - count;
+            }
             if (coder == String::LATIN1) {
                 StringUtils::writeLatin1CharAt(value, index, ch);
             }
@@ -472,6 +615,7 @@ namespace core
 
     XString &XString::append(CharSequence const &s, gint start, gint end)
     {
+        closeGap();
         gint count = length();
         Coder coder = coding();
         gint count2 = end - start;
@@ -508,6 +652,7 @@ namespace core
             }
             else if (Class< XString >::hasInstance(s)) {
                 XString const &str = CORE_XCAST(XString const, s);
+                str.closeGap();
                 if (coder == str.coding()) {
                     if (coder == String::LATIN1) {
                         StringUtils::copyLatin1(str.value, start, value, count, count2);
@@ -534,30 +679,39 @@ namespace core
                 XString::maybeLatin1 |= str.maybeLatin1;
             }
             else {
-                // Appends characters
-                if (coder == String::LATIN1) {
-                    for (int i = 0; i < count2; ++i) {
-                        gchar c = s.charAt(start + i);
-                        if (!StringUtils::isLatin1(c)) {
-                            // Convert to UTF16
-                            ARRAY a = StringUtils::copyOfLatin1ToUTF16(value, 0, count + i, limit);
-                            for (int j = i; j < count2; ++j) {
-                                gchar c = s.charAt(start + j);
-                                StringUtils::writeUTF16CharAt(value, count + j, c);
-                            }
-
-                            XString::count = 0;
-                            StringUtils::destroyLatin1String(value, count + i);
-                            break;
-                        }
-                        StringUtils::writeLatin1CharAt(value, count + i, c);
-                    }
+                // Appends characters by blocks, from the storage of the sequence when it has one
+                BYTES latin1 = CORE_CAST(BYTES, s.latin1Span());
+                CHARS utf16 = CORE_CAST(CHARS, s.utf16Span());
+                gint i = 0;
+                if (latin1 != null) {
+                    coder == String::LATIN1
+                    ? StringUtils::copyLatin1(latin1, start, value, count, count2)
+                    : StringUtils::copyLatin1ToUTF16(latin1, start, value, count, count2);
+                    i = count2;
                 }
-                else {
-                    for (int i = 0; i < count2; ++i) {
-                        gchar c = s.charAt(start + i);
-                        StringUtils::writeUTF16CharAt(value, count + i, c);
+                gchar buffer[256];
+                while (i < count2 && coding() == String::LATIN1) {
+                    gint n = Math::min(count2 - i, 256);
+                    CHARS chars = buffer;
+                    if (utf16 != null) {
+                        chars = utf16 + start + i;
+                    }
+                    else {
+                        s.getChars(start + i, start + i + n, buffer);
+                    }
+                    gint k = StringKernels::compressUTF16(chars, value + count + i, n);
+                    if (k < n) {
+                        // Convert to UTF16
+                        inflate();
+                        StringUtils::copyUTF16(chars, k, value, count + i + k, n - k);
                     }
+                    i += n;
+                }
+                if (i < count2) {
+                    CHARS chars = CORE_FCAST(CHARS, value);
+                    utf16 != null
+                    ? StringUtils::copyUTF16(utf16, start + i, value, count + i, count2 - i)
+                    : s.getChars(start + i, end, chars + count + i);
                 }
             }
 
@@ -581,6 +735,7 @@ namespace core
 
     XString &XString::append(CharArray const &str, gint offset, gint len)
     {
+        closeGap();
         gint count = length();
         Coder coder = coding();
         try {
@@ -617,6 +772,7 @@ namespace core
 
     XString &XString::append(gbool b)
     {
+        closeGap();
         gint count = length();
         Coder coder = coding();
         try {
@@ -662,6 +818,7 @@ namespace core
 
     XString &XString::append(gchar c)
     {
+        closeGap();
         gint count = length();
         Coder coder = coding();
         try {
@@ -692,10 +849,75 @@ namespace core
         }
     }
 
+    /**
+     * Return the number of characters of the decimal representation
+     * of the given number (with its sign).
+     */
+    static gint stringSize(glong x)
+    {
+        gint d = 1;
+        if (x >= 0) {
+            d = 0;
+            x = -x;
+        }
+        glong p = -10;
+        for (gint i = 1; i < 19; i++) {
+            if (x > p) {
+                return i + d;
+            }
+            p = 10 * p;
+        }
+        return 19 + d;
+    }
+
+    /**
+     * Write the decimal representation of the given number backward
+     * from the given index (excluded). The number is processed as a negative
+     * value, so that @c Long::MIN_VALUE needs no special case.
+     */
+    template<class T>
+    static void writeDigits(glong l, gint end, T *chars)
+    {
+        gint cursor = end;
+        gbool negative = l < 0;
+        if (!negative) {
+            l = -l;
+        }
+
+        // Generate two digits per iteration, with glong division
+        // until the value fits on gint
+        while (l < Integer::MIN_VALUE) {
+            glong q = l / 100;
+            gint r = (gint) ((q * 100) - l);
+            l = q;
+            chars[--cursor] = (T) ('0' + r % 10);
+            chars[--cursor] = (T) ('0' + r / 10);
+        }
+
+        gint i = (gint) l;
+        while (i <= -100) {
+            gint q = i / 100;
+            gint r = (q * 100) - i;
+            i = q;
+            chars[--cursor] = (T) ('0' + r % 10);
+            chars[--cursor] = (T) ('0' + r / 10);
+        }
+
+        // We know there are at most two digits left at this point.
+        chars[--cursor] = (T) ('0' + (-i) % 10);
+        if (i < -9) {
+            chars[--cursor] = (T) ('0' + (-i) / 10);
+        }
+
+        if (negative) {
+            chars[--cursor] = '-';
+        }
+    }
+
     XString &XString::append(gint i)
     {
         try {
-            return append(String::valueOf(i));
+            return append((glong) i);
         }
         catch (Throwable const &ex) {
             ex.throws($ftrace(""_S));
@@ -704,8 +926,21 @@ namespace core
 
     XString &XString::append(glong l)
     {
+        closeGap();
+        gint count = length();
+        gint size = stringSize(l);
         try {
-            return append(String::valueOf(l));
+            // the digits are written in place, without temporary string
+            ensureCapacity(count + size);
+            if (coding() == String::LATIN1) {
+                writeDigits(l, count + size, value);
+            }
+            else {
+                CHARS chars = CORE_FCAST(CHARS, value);
+                writeDigits(l, count + size, chars);
+            }
+            XString::count = count + size;
+            return *this;
         }
         catch (Throwable const &ex) {
             ex.throws($ftrace(""_S));
@@ -735,22 +970,19 @@ namespace core
     XString &XString::remove(gint start, gint end)
     {
         gint count = length();
-        Coder coder = coding();
         if (end > count) {
             end = count;
         }
         gint count2 = end - start;
+        if (start < 0 || start > end) {
+            IndexOutOfBoundsException("start "_S + String::valueOf(start) + ", end "_S + String::valueOf(end)
+                                      + ", length "_S + String::valueOf(count)).throws($ftrace(""_S));
+        }
         try {
-            Precondition::checkIndexFromRange(start, end, count);
             if (count2 > 0) {
-                if (coder == String::LATIN1) {
-                    StringUtils::copyLatin1(value, end, value, start, count - end);
-                    StringUtils::fillLatin1String(value, count - end, count2, 0);
-                }
-                else {
-                    StringUtils::copyUTF16(value, end, value, start, count - end);
-                    StringUtils::fillUTF16String(value, count - end, count2, 0);
-                }
+                // the removed characters join the gap
+                moveGap(end);
+                gap = start;
                 XString::count = count - count2;
                 XString::maybeLatin1 = true;
             }
@@ -781,10 +1013,8 @@ namespace core
         gint count = length();
         try {
             Precondition::checkIndex(index, count);
-            gchar c = charAt(index);
-            remove(index, index + 1);
-            XString::maybeLatin1 = !StringUtils::isLatin1(c);
-            return *this;
+            // remove() marks the storage as maybe latin1
+            return remove(index, index + 1);
         }
         catch (Throwable const &ex) {
             ex.throws($ftrace(""_S));
@@ -794,54 +1024,12 @@ namespace core
     XString &XString::replace(gint start, gint end, String const &str)
     {
         gint count = length();
-        Coder coder = coding();
-        gint count2 = end - start;
-        gint count3 = str.length();
 
         try {
             Precondition::checkIndexFromRange(start, end, count);
-            if (count3 == 0) {
-                return remove(start, end);
-            }
-
-            gint count4 = count3 - count2;
-            ensureCapacity(count + count4);
-            // Shift trailing characters
-            if (count4 != 0) {
-                if (coder == String::LATIN1) {
-                    StringUtils::copyLatin1(value, end, value, end + count4, count4);
-                }
-                else {
-                    StringUtils::copyUTF16(value, end, value, end + count4, count4);
-                }
-            }
-            // Insert string characters
-            if (coder == str.coding()) {
-                if (coder == String::LATIN1) {
-                    StringUtils::copyLatin1(str.value, 0, value, start, count3);
-                }
-                else {
-                    StringUtils::copyUTF16(str.value, 0, value, start, count3);
-                }
-            }
-            else {
-                if (coder == String::LATIN1) {
-                    // Convert to UTF16
-                    ARRAY a = StringUtils::copyOfLatin1ToUTF16(value, 0, count, limit);
-                    StringUtils::copyUTF16(str.value, 0, a, start, count3);
-
-                    XString::count = 0;
-                    StringUtils::destroyLatin1String(value, count);
-
-                    XString::value = a;
-                }
-                else {
-                    StringUtils::copyLatin1ToUTF16(str.value, 0, value, start, count3);
-                }
-            }
-
-            XString::count = count + count4;
-            return *this;
+            // the replaced characters join the gap, and the string is written in it
+            remove(start, end);
+            return insert(start, str);
         }
         catch (Throwable const &ex) {
             ex.throws($ftrace(""_S));
@@ -866,8 +1054,35 @@ namespace core
         }
     }
 
+    void XString::getChars(gint startIndex, gint endIndex, gchar dst[]) const
+    {
+        gint count = length();
+        if (startIndex < 0 || startIndex > endIndex || endIndex > count) {
+            IndexOutOfBoundsException("Range ["_S + String::valueOf(startIndex) + ", "_S + String::valueOf(endIndex)
+                                      + ") out of bounds for length "_S + String::valueOf(count))
+                    .throws($ftrace(""_S));
+        }
+        closeGap();
+        coding() == String::LATIN1
+        ? StringUtils::copyLatin1ToUTF16(value, startIndex, dst, 0, endIndex - startIndex)
+        : StringUtils::copyUTF16(value, startIndex, dst, 0, endIndex - startIndex);
+    }
+
+    gbyte const *XString::latin1Span() const
+    {
+        closeGap();
+        return coding() == String::LATIN1 ? value : null;
+    }
+
+    gchar const *XString::utf16Span() const
+    {
+        closeGap();
+        return coding() == String::UTF16 ? CORE_FCAST(CHARS, value) : null;
+    }
+
     String XString::subString(gint start, gint end) const
     {
+        closeGap();
         gint count = length();
         Coder coder = coding();
         gint count2 = end - start;
@@ -904,38 +1119,30 @@ namespace core
     {
         gint count = length();
         Coder coder = coding();
+        if (index < 0 || index > count) {
+            IndexOutOfBoundsException("offset "_S + String::valueOf(index) + ", length "_S
+                                      + String::valueOf(count)).throws($ftrace(""_S));
+        }
         try {
-            Precondition::checkIndexFromSize(index, len, count);
             Precondition::checkIndexFromSize(offset, len, str.length());
             ensureCapacity(count + len);
+            // the characters are written in the gap
+            moveGap(index);
             if (coder == String::LATIN1) {
-                // Shift
-                StringUtils::copyLatin1(value, index, value, index + len, count - index);
-                // Insert
                 for (int i = 0; i < len; ++i) {
                     gchar c = str[offset + i];
                     if (!StringUtils::isLatin1(c)) {
-                        // Convert to UTF16
-                        ARRAY a = StringUtils::copyOfLatin1ToUTF16(value, 0, count + len, limit);
-                        for (int j = i; j < len; ++j) {
-                            gchar c = str[offset + j];
-                            StringUtils::writeUTF16CharAt(value, index + j, c);
-                        }
-
-                        XString::count = 0;
-                        StringUtils::destroyLatin1String(value, count + len);
-                        XString::value = a;
+                        inflate();
+                        StringUtils::copyUTF16(str.value, offset + i, value, index + i, len - i);
                         break;
                     }
                     StringUtils::writeLatin1CharAt(value, index + i, c);
                 }
             }
             else {
-                // Shift
-                StringUtils::copyUTF16(value, index, value, index + len, count - index);
-                // Insert
                 StringUtils::copyUTF16(str.value, offset, value, index, len);
             }
+            gap = index + len;
             XString::count = count + len;
             return *this;
         }
@@ -984,7 +1191,54 @@ namespace core
 
     XString &XString::insert(gint dstOffset, CharSequence const &s, gint start, gint end)
     {
-        // RAS
+        gint count = length();
+        if (dstOffset < 0 || dstOffset > count) {
+            IndexOutOfBoundsException("offset "_S + String::valueOf(dstOffset) + ", length "_S
+                                      + String::valueOf(count)).throws($ftrace(""_S));
+        }
+        if (start < 0 || start > end || end > s.length()) {
+            IndexOutOfBoundsException("start "_S + String::valueOf(start) + ", end "_S + String::valueOf(end)
+                                      + ", length "_S + String::valueOf(s.length())).throws($ftrace(""_S));
+        }
+        gint count2 = end - start;
+        try {
+            ensureCapacity(count + count2);
+            // the characters are written in the gap
+            moveGap(dstOffset);
+            if (Class< String >::hasInstance(s)) {
+                String const &str = CORE_XCAST(String const, s);
+                if (coding() == String::LATIN1 && str.coding() == String::UTF16) {
+                    inflate();
+                }
+                if (coding() == str.coding()) {
+                    coding() == String::LATIN1
+                    ? StringUtils::copyLatin1(str.value, start, value, dstOffset, count2)
+                    : StringUtils::copyUTF16(str.value, start, value, dstOffset, count2);
+                }
+                else {
+                    StringUtils::copyLatin1ToUTF16(str.value, start, value, dstOffset, count2);
+                }
+            }
+            else {
+                // the characters of this sequence are still read around the gap
+                for (gint i = 0; i < count2; ++i) {
+                    gchar c = s.charAt(start + i);
+                    if (coding() == String::LATIN1 && !StringUtils::isLatin1(c)) {
+                        inflate();
+                    }
+                    coding() == String::LATIN1
+                    ? StringUtils::writeLatin1CharAt(value, dstOffset + i, c)
+                    : StringUtils::writeUTF16CharAt(value, dstOffset + i, c);
+                }
+                if (Class< XString >::hasInstance(s)) {
+                    XString::maybeLatin1 |= CORE_XCAST(XString const, s).maybeLatin1;
+                }
+            }
+            gap = dstOffset + count2;
+            XString::count = count + count2;
+            return *this;
+        }
+        catch (Throwable const &ex) { ex.throws($ftrace(""_S)); }
     }
 
     XString &XString::insert(gint offset, gbool b)
@@ -1008,15 +1262,32 @@ namespace core
     XString &XString::insert(gint offset, gint i)
     {
         try {
-            return insert(offset, String::valueOf(i));
+            return insert(offset, (glong) i);
         }
         catch (Throwable const &ex) { ex.throws($ftrace(""_S)); }
     }
 
     XString &XString::insert(gint offset, glong l)
     {
+        gint count = length();
+        if (offset < 0 || offset > count) {
+            IndexOutOfBoundsException("offset "_S + String::valueOf(offset) + ", length "_S
+                                      + String::valueOf(count)).throws($ftrace(""_S));
+        }
+        gint size = stringSize(l);
         try {
-            return insert(offset, String::valueOf(l));
+            ensureCapacity(count + size);
+            moveGap(offset);
+            if (coding() == String::LATIN1) {
+                writeDigits(l, offset + size, value);
+            }
+            else {
+                CHARS chars = CORE_FCAST(CHARS, value);
+                writeDigits(l, offset + size, chars);
+            }
+            gap = offset + size;
+            XString::count = count + size;
+            return *this;
         }
         catch (Throwable const &ex) { ex.throws($ftrace(""_S)); }
     }
@@ -1049,6 +1320,7 @@ namespace core
 
     gint XString::indexOf(String const &str, gint fromIndex) const
     {
+        closeGap();
         gint count1 = length();
         gint count2 = str.length();
         fromIndex = Math::clamp(fromIndex, 0, count1);
@@ -1063,85 +1335,15 @@ namespace core
 
         Coder coder = coding();
         if (coder == str.coding()) {
-            if (coder == String::LATIN1) {
-                gchar f = StringUtils::readLatin1CharAt(str.value, 0);
-                gint count = count1 - count2;
-                for (int i = fromIndex; i < count; ++i) {
-                    gchar c1 = StringUtils::readLatin1CharAt(value, i);
-                    // Look for first character.
-                    if (c1 != f) {
-                        continue;
-                    }
-                    // Found first character, now look at the rest of value
-                    gint j = i + 1;
-                    for (int k = 1; k < count2; ++k, ++j) {
-                        c1 = StringUtils::readLatin1CharAt(value, j);
-                        gchar c2 = StringUtils::readLatin1CharAt(str.value, k);
-                        if (c1 != c2) {
-                            break;
-                        }
-                    }
-                    if (j == i + count2) {
-                        // Found whole string.
-                        return i;
-                    }
-                }
-            }
-            else {
-                gchar f = StringUtils::readUTF16CharAt(str.value, 0);
-                gint count = count1 - count2;
-                for (int i = fromIndex; i < count; ++i) {
-                    gchar c1 = StringUtils::readUTF16CharAt(value, i);
-                    // Look for first character.
-                    if (c1 != f) {
-                        continue;
-                    }
-                    // Found first character, now look at the rest of value
-                    gint j = i + 1;
-                    for (int k = 1; k < count2; ++k, ++j) {
-                        c1 = StringUtils::readUTF16CharAt(value, j);
-                        gchar c2 = StringUtils::readUTF16CharAt(str.value, k);
-                        if (c1 != c2) {
-                            break;
-                        }
-                    }
-                    if (j == i + count2) {
-                        // Found whole string.
-                        return i;
-                    }
-                }
-            }
+            return coder == String::LATIN1
+                   ? StringUtils::indexOfLatin1(value, fromIndex, str.value, 0, count1 - fromIndex, count2)
+                   : StringUtils::indexOfUTF16(value, fromIndex, str.value, 0, count1 - fromIndex, count2);
         }
-        else {
-            if (coder == String::LATIN1) {
-                return -1;
-            }
-            else {
-                gchar f = StringUtils::readLatin1CharAt(str.value, 0);
-                gint count = count1 - count2;
-                for (int i = fromIndex; i < count; ++i) {
-                    gchar c1 = StringUtils::readUTF16CharAt(value, i);
-                    // Look for first character.
-                    if (c1 != f) {
-                        continue;
-                    }
-                    // Found first character, now look at the rest of value
-                    gint j = i + 1;
-                    for (int k = 1; k < count2; ++k, ++j) {
-                        c1 = StringUtils::readUTF16CharAt(value, j);
-                        gchar c2 = StringUtils::readLatin1CharAt(str.value, k);
-                        if (c1 != c2) {
-                            break;
-                        }
-                    }
-                    if (j == i + count2) {
-                        // Found whole string.
-                        return i;
-                    }
-                }
-            }
+        if (coder == String::LATIN1) {
+            // The utf16 strings contain at least one character above 0xFF
+            return -1;
         }
-        return -1;
+        return StringUtils::indexOfLatin1$UTF16(value, fromIndex, str.value, 0, count1 - fromIndex, count2);
     }
 
     gint XString::lastIndexOf(String const &str) const
@@ -1154,6 +1356,7 @@ namespace core
 
     gint XString::lastIndexOf(String const &str, gint fromIndex) const
     {
+        closeGap();
         gint count1 = length();
         gint count2 = str.length();
 
@@ -1169,91 +1372,24 @@ namespace core
             return fromIndex;
         }
 
+        // The occurrences start at most at fromIndex
+        gint count = fromIndex + count2;
         Coder coder = coding();
         if (coder == str.coding()) {
-            if (coder == String::LATIN1) {
-                gchar l = StringUtils::readLatin1CharAt(str.value, count2 - 1);
-                gint count = count1 - count2;
-                for (int i = count1 - 1; i >= count; --i) {
-                    gchar c1 = StringUtils::readLatin1CharAt(value, i);
-                    // Look for last character.
-                    if (c1 != l) {
-                        continue;
-                    }
-                    // Found first character, now look at the rest of value
-                    gint j = i - 1;
-                    for (int k = count2 - 2; k >= 0; --k, --j) {
-                        c1 = StringUtils::readLatin1CharAt(value, j);
-                        gchar c2 = StringUtils::readLatin1CharAt(str.value, k);
-                        if (c1 != c2) {
-                            break;
-                        }
-                    }
-                    if (j <= i - count2) {
-                        // Found whole string.
-                        return j + 1;
-                    }
-                }
-            }
-            else {
-                gchar l = StringUtils::readUTF16CharAt(str.value, count2 - 1);
-                gint count = count1 - count2;
-                for (int i = count1 - 1; i >= count; --i) {
-                    gchar c1 = StringUtils::readUTF16CharAt(value, i);
-                    // Look for last character.
-                    if (c1 != l) {
-                        continue;
-                    }
-                    // Found first character, now look at the rest of value
-                    gint j = i - 1;
-                    for (int k = count2 - 2; k >= 0; --k, --j) {
-                        c1 = StringUtils::readUTF16CharAt(value, j);
-                        gchar c2 = StringUtils::readUTF16CharAt(str.value, k);
-                        if (c1 != c2) {
-                            break;
-                        }
-                    }
-                    if (j <= i - count2) {
-                        // Found whole string.
-                        return j + 1;
-                    }
-                }
-            }
+            return coder == String::LATIN1
+                   ? StringUtils::lastIndexOfLatin1(value, 0, str.value, 0, count, count2)
+                   : StringUtils::lastIndexOfUTF16(value, 0, str.value, 0, count, count2);
         }
-        else {
-            if (coder == String::LATIN1) {
-                return -1;
-            }
-            else {
-                gchar l = StringUtils::readLatin1CharAt(str.value, count2 - 1);
-                gint count = count1 - count2;
-                for (int i = count1 - 1; i >= count; --i) {
-                    gchar c1 = StringUtils::readUTF16CharAt(value, i);
-                    // Look for last character.
-                    if (c1 != l) {
-                        continue;
-                    }
-                    // Found first character, now look at the rest of value
-                    gint j = i - 1;
-                    for (int k = count2 - 2; k >= 0; --k, --j) {
-                        c1 = StringUtils::readUTF16CharAt(value, j);
-                        gchar c2 = StringUtils::readLatin1CharAt(str.value, k);
-                        if (c1 != c2) {
-                            break;
-                        }
-                    }
-                    if (j <= i - count2) {
-                        // Found whole string.
-                        return j + 1;
-                    }
-                }
-            }
+        if (coder == String::LATIN1) {
+            // The utf16 strings contain at least one character above 0xFF
+            return -1;
         }
-        return -1;
+        return StringUtils::lastIndexOfLatin1$UTF16(value, 0, str.value, 0, count, count2);
     }
 
     XString &XString::reverse()
     {
+        closeGap();
         gint count = length() >> 1;
         Coder coder = coding();
 
@@ -1281,28 +1417,89 @@ namespace core
 
     String XString::toString() const
     {
+        closeGap();
         gint count = length();
         Coder coder = coding();
         gbool maybeLatin1 = XString::maybeLatin1;
 
         String str;
-        if(coder == String::LATIN1) {
-            str.coder = String::LATIN1;
-            str.value = StringUtils::copyOfLatin1(value, 0, count);
-        }else {
-            if(String::COMPACT_STRINGS && maybeLatin1) {
-                str.coder = String::LATIN1;
-                str.value = StringUtils::inflateUTF16ToLatin1(value, 0, count);
-                if(value != null) {
-                    goto End;
+        if (coder == String::LATIN1) {
+            str.allocate(String::LATIN1, count);
+            StringUtils::copyLatin1(value, 0, str.value, 0, count);
+        }
+        else {
+            if (String::COMPACT_STRINGS && maybeLatin1 && count < String::EMBEDDED_LENGTH) {
+                CHARS chars = CORE_FCAST(CHARS, value);
+                gint i = 0;
+                while (i < count && StringUtils::isLatin1(chars[i])) {
+                    i += 1;
+                }
+                if (i == count) {
+                    str.allocate(String::LATIN1, count);
+                    StringUtils::copyUTF16ToLatin1(value, 0, str.value, 0, count);
+                    return str;
+                }
+            }
+            else if (String::COMPACT_STRINGS && maybeLatin1) {
+                ARRAY bytes = StringUtils::inflateUTF16ToLatin1(value, 0, count);
+                if (bytes != null) {
+                    str.coder = String::LATIN1;
+                    str.value = bytes;
+                    str.count = count;
+                    return str;
                 }
             }
-            str.coder = String::UTF16;
-            str.value = StringUtils::copyOfUTF16(value, 0, count);
+            str.allocate(String::UTF16, count);
+            StringUtils::copyUTF16(value, 0, str.value, 0, count);
         }
-        End:
-        str.count = count;
         return str;
     }
 
-} // core
\ No newline at end of file
+    String XString::build()
+    {
+        closeGap();
+        gint count = length();
+        Coder coder = coding();
+        gint limit = capacity();
+
+        String str;
+        if (count < (String::EMBEDDED_LENGTH >> coder)
+            || (String::COMPACT_STRINGS && coder == String::UTF16 && maybeLatin1)) {
+            // short strings are embedded, and the other ones may be compressed
+            str = toString();
+            coder == String::LATIN1
+            ? StringUtils::destroyLatin1String(value, limit)
+            : StringUtils::destroyUTF16String(value, limit);
+        }
+        else {
+            if (limit - count > (count >> 2)) {
+                // too much unused space, the characters are moved to a buffer of their size
+                ARRAY a = coder == String::LATIN1
+                          ? StringUtils::copyOfLatin1(value, 0, count)
+                          : StringUtils::copyOfUTF16(value, 0, count);
+                coder == String::LATIN1
+                ? StringUtils::destroyLatin1String(value, limit)
+                : StringUtils::destroyUTF16String(value, limit);
+                value = a;
+            }
+            else if (coder == String::LATIN1) {
+                value[count] = 0;
+            }
+            else {
+                CHARS chars = CORE_FCAST(CHARS, value);
+                chars[count] = 0;
+            }
+            str.value = value;
+            str.coder = coder;
+            str.count = count;
+        }
+
+        // this sequence is now empty, the next append allocates a new storage
+        value = StringUtils::newLatin1String(0);
+        XString::count = 0;
+        XString::limit = 0;
+        XString::coder = String::COMPACT_STRINGS ? String::LATIN1 : String::UTF16;
+        maybeLatin1 = false;
+        return str;
+    }
+} // core
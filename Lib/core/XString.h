@@ -46,6 +46,12 @@ namespace core
      * character sequence contained in the string builder does not exceed
      * the capacity, it is not necessary to allocate a new internal
      * buffer. If the internal buffer overflows, it is automatically made larger.
+     * <p>
+     * The unused capacity is kept as a gap at the index of the last @c insert or
+     * @c remove, so that the successive edits near the same index don't move the
+     * whole tail of the sequence. The gap is moved back to the end on the first
+     * operation that needs the characters to be contiguous (@c append,
+     * @c toString, searches...). @c charAt and @c setCharAt read around it.
      *
      * <p>Instances of @c XString are not safe for
      * use by multiple threads. If such synchronization is required then it is
@@ -100,8 +106,41 @@ namespace core
          */
         gbool maybeLatin1 = false;
 
+        /**
+         * The index of the gap of the storage, or -1 if the characters are contiguous.
+         * When the gap is open, the characters that follow it are stored at the end of
+         * the storage and the gap holds the @c limit-count unused characters. So the
+         * successive inserts and removals near the same index only move the characters
+         * between this index and the gap, instead of the whole tail.
+         */
+        gint mutable gap = -1;
+
         Coder coding() const;
 
+        /**
+         * Moves the gap to the given index (opening it if needed). The capacity
+         * must already hold the characters that will be written in the gap.
+         */
+        void moveGap(gint index);
+
+        /**
+         * Moves the characters that follow the gap back to it, so that the characters
+         * are contiguous again. All the methods that access the storage as a whole call
+         * this method first, only @c insert, @c remove and the accesses by index keep
+         * the gap open.
+         *
+         * @note The const readers call this method too, so they may move the characters
+         *          of the storage: an address returned by @c latin1Span or @c utf16Span
+         *          is invalidated by any call on this XString, const or not, and the
+         *          const methods must not be called concurrently.
+         */
+        void closeGap() const;
+
+        /**
+         * Converts the latin1 storage to utf16, the gap is kept at its place.
+         */
+        void inflate();
+
     public:
 
         /**
@@ -139,6 +178,42 @@ namespace core
          */
         CORE_EXPLICIT XString(CharSequence const &seq);
 
+        /**
+         * Constructs a string builder that contains a copy of the characters
+         * of the given builder, with the same capacity. The two builders never
+         * share their storage, so @c build() on one of them does not change
+         * the other one.
+         *
+         * @param      sb   the builder to copy.
+         */
+        CORE_IMPLICIT XString(XString const &sb);
+
+        /**
+         * Constructs a string builder that takes the storage of the given builder,
+         * without copy. The given builder is left empty, as after @c build().
+         *
+         * @param      sb   the builder to move.
+         */
+        CORE_IMPLICIT XString(XString &&sb) CORE_NOTHROW;
+
+        /**
+         * Replaces the characters of this builder by a copy of the characters
+         * of the given builder.
+         *
+         * @param      sb   the builder to copy.
+         */
+        XString &operator=(XString const &sb);
+
+        /**
+         * Replaces the characters of this builder by the storage of the given
+         * builder, without copy. The given builder is left empty, as after @c build().
+         *
+         * @param      sb   the builder to move.
+         */
+        XString &operator=(XString &&sb) CORE_NOTHROW;
+
+        ~XString() override;
+
         /**
          * Compares two @c StringBuilder instances lexicographically. This method
          * follows the same rules for lexicographical comparison as defined in the
@@ -558,10 +633,8 @@ namespace core
         XString &append(Num num)
         {
             if (Class< Num >::isInteger()) {
-                if (num <= Integer::MAX_VALUE) {
-                    return append((gint) num);
-                }
-                else if (num <= Long::MAX_VALUE) {
+                if (num <= Long::MAX_VALUE) {
+                    // the negative numbers are included, gint and glong share the same formatting
                     return append((glong) num);
                 }
                 else {
@@ -736,6 +809,34 @@ namespace core
          */
         CharSequence &subSequence(gint start, gint end) const override;
 
+        /**
+         * Copies the characters of the specified range to the given buffer, by blocks.
+         * The spans close the gap of the storage first.
+         *
+         * @see CharSequence::getChars(gint, gint, gchar[])
+         */
+        void getChars(gint startIndex, gint endIndex, gchar dst[]) const override;
+
+        /**
+         * Returns the address of the latin1 storage once the gap is closed, or @c null
+         * if the storage is utf16. Unlike the other sequences, the address is
+         * invalidated by any later call on this XString, including the const ones
+         * (that may close a gap opened in between).
+         *
+         * @see CharSequence::latin1Span()
+         */
+        gbyte const *latin1Span() const override;
+
+        /**
+         * Returns the address of the utf16 storage once the gap is closed, or @c null
+         * if the storage is latin1. The address is invalidated by any later call on
+         * this XString, including the const ones.
+         *
+         * @see CharSequence::utf16Span()
+         */
+        gchar const *utf16Span() const override;
+
+
         /**
          * Returns a new @c String that contains a subsequence of
          * characters currently contained in this sequence. The
@@ -1020,10 +1121,8 @@ namespace core
         XString &insert(gint offset, Num num)
         {
             if (Class< Num >::isInteger()) {
-                if (num <= Integer::MAX_VALUE) {
-                    return insert(offset, (gint) num);
-                }
-                else if (num <= Long::MAX_VALUE) {
+                if (num <= Long::MAX_VALUE) {
+                    // the negative numbers are included, gint and glong share the same formatting
                     return insert(offset, (glong) num);
                 }
                 else {
@@ -1208,6 +1307,17 @@ namespace core
          */
         String toString() const override;
 
+        /**
+         * Returns a string representing the data in this sequence, and
+         * leaves this sequence empty. Unlike @c toString(), the characters
+         * storage of this sequence is given to the returned @c String without
+         * copy, it is only reallocated when more than a quarter of it is unused.
+         * The short strings and the compressible ones are copied, as by @c toString().
+         *
+         * @return  a string representation of this sequence of characters.
+         */
+        String build();
+
     };
 
 } // core
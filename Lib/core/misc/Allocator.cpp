@@ -0,0 +1,400 @@
+//
+// Created by bruns on 20/06/2024.
+//
+
+#include <core/misc/Allocator.h>
+#include <core/IllegalStateException.h>
+#include <core/misc/Nil.h>
+#include <core/misc/Foreign.h>
+
+#if CORE_COMPILER_MSVC
+#include <intrin.h>
+#endif
+
+namespace core
+{
+    namespace misc
+    {
+        struct FreeBlock
+        {
+            FreeBlock *next; // the next released block of the same size class
+        };
+
+        struct FreeList
+        {
+            FreeBlock *head; // the last released block
+            gint size;       // the number of blocks on this list
+        };
+
+        /**
+         * The number of size classes: 16, 32, 64, ..., 4096 bytes.
+         */
+        static CORE_FAST gint SIZE_CLASSES = 9;
+
+        /**
+         * The size of the largest size class.
+         */
+        static CORE_FAST glong MAX_POOLED_SIZE = 16LL << (SIZE_CLASSES - 1);
+
+        /**
+         * The maximal number of blocks kept by each thread for each size class.
+         */
+        static CORE_FAST gint LOCAL_LIMIT = 64;
+
+        /**
+         * The maximal number of blocks shared by all the threads for each size class.
+         */
+        static CORE_FAST gint GLOBAL_LIMIT = 1024;
+
+        static struct
+        {
+            gint volatile lock; // 0 if unlocked, 1 otherwise
+            FreeList lists[SIZE_CLASSES];
+        } globalPool = {};
+
+        static void lockPool()
+        {
+#if CORE_COMPILER_MSVC
+            while (_InterlockedExchange(CORE_CAST(long volatile *, &globalPool.lock), 1) != 0) {
+                while (globalPool.lock != 0) {
+                    _mm_pause();
+                }
+            }
+#else
+            while (__atomic_exchange_n(&globalPool.lock, 1, __ATOMIC_ACQUIRE) != 0) {
+                while (__atomic_load_n(&globalPool.lock, __ATOMIC_RELAXED) != 0) {
+#if defined(__i386__) || defined(__x86_64__)
+                    __builtin_ia32_pause();
+#endif
+                }
+            }
+#endif
+        }
+
+        static void unlockPool()
+        {
+#if CORE_COMPILER_MSVC
+            _InterlockedExchange(CORE_CAST(long volatile *, &globalPool.lock), 0);
+#else
+            __atomic_store_n(&globalPool.lock, 0, __ATOMIC_RELEASE);
+#endif
+        }
+
+        static gint classOf(glong size)
+        {
+            gint index = 0;
+            while ((16LL << index) < size) {
+                index += 1;
+            }
+            return index;
+        }
+
+        static void *newBlock(glong size)
+        {
+            // the blocks are allocated by 8 bytes words
+            return new glong[(size + 7) >> 3];
+        }
+
+        static void deleteBlock(void *block)
+        {
+            delete[] CORE_CAST(glong *, block);
+        }
+
+        static FreeBlock *pop(FreeList &list)
+        {
+            FreeBlock *block = list.head;
+            if (block != null) {
+                list.head = block->next;
+                list.size -= 1;
+            }
+            return block;
+        }
+
+        static void push(FreeList &list, FreeBlock *block)
+        {
+            block->next = list.head;
+            list.head = block;
+            list.size += 1;
+        }
+
+        /**
+         * Move at most the given number of blocks of the given list to the global list
+         * of the same size class. The blocks that the global list can not keep are deleted.
+         */
+        static void releaseToGlobal(FreeList &list, gint index, gint count)
+        {
+            lockPool();
+            FreeList &global = globalPool.lists[index];
+            while (count > 0 && list.head != null && global.size < GLOBAL_LIMIT) {
+                push(global, pop(list));
+                count -= 1;
+            }
+            unlockPool();
+            while (count > 0 && list.head != null) {
+                deleteBlock(pop(list));
+                count -= 1;
+            }
+        }
+
+#ifdef CORE_XCOMPILER_THREAD_LOCAL
+
+        /**
+         * Set when the free lists of the current thread are destroyed. The strings
+         * destroyed after them (the static strings of the main thread, at exit) use
+         * the global lists. This flag has no destructor, so it stays readable.
+         */
+        static thread_local gbool localPoolDestroyed = false;
+
+        /**
+         * The free lists of a thread. On thread exit, the blocks
+         * are given back to the global lists.
+         */
+        struct LocalPool
+        {
+            FreeList lists[SIZE_CLASSES];
+
+            ~LocalPool()
+            {
+                localPoolDestroyed = true;
+                for (int i = 0; i < SIZE_CLASSES; ++i) {
+                    releaseToGlobal(lists[i], i, lists[i].size);
+                }
+            }
+        };
+
+        static thread_local LocalPool localPool = {};
+
+#endif
+
+        static FreeBlock *allocateGlobal(gint index)
+        {
+            lockPool();
+            FreeBlock *block = pop(globalPool.lists[index]);
+            unlockPool();
+            return block;
+        }
+
+        static void releaseGlobal(void *block, gint index)
+        {
+            lockPool();
+            FreeList &global = globalPool.lists[index];
+            if (global.size < GLOBAL_LIMIT) {
+                push(global, CORE_CAST(FreeBlock *, block));
+                block = null;
+            }
+            unlockPool();
+            if (block != null) {
+                deleteBlock(block);
+            }
+        }
+
+        static void *allocatePooled(glong size)
+        {
+            if (size > MAX_POOLED_SIZE) {
+                return newBlock(size);
+            }
+            gint index = classOf(size);
+            FreeBlock *block = null;
+#ifdef CORE_XCOMPILER_THREAD_LOCAL
+            if (localPoolDestroyed) {
+                block = allocateGlobal(index);
+                return block != null ? block : newBlock(16LL << index);
+            }
+            FreeList &local = localPool.lists[index];
+            block = pop(local);
+            if (block == null) {
+                // refill the local list with half of its capacity at once
+                lockPool();
+                FreeList &global = globalPool.lists[index];
+                block = pop(global);
+                for (int i = 1; i < (LOCAL_LIMIT >> 1) && global.head != null; ++i) {
+                    push(local, pop(global));
+                }
+                unlockPool();
+            }
+#else
+            block = allocateGlobal(index);
+#endif
+            return block != null ? block : newBlock(16LL << index);
+        }
+
+        static void releasePooled(void *block, glong size)
+        {
+            if (size > MAX_POOLED_SIZE) {
+                deleteBlock(block);
+                return;
+            }
+            gint index = classOf(size);
+#ifdef CORE_XCOMPILER_THREAD_LOCAL
+            if (localPoolDestroyed) {
+                releaseGlobal(block, index);
+                return;
+            }
+            FreeList &local = localPool.lists[index];
+            if (local.size >= LOCAL_LIMIT) {
+                // give back half of the local list at once
+                releaseToGlobal(local, index, LOCAL_LIMIT >> 1);
+            }
+            push(local, CORE_CAST(FreeBlock *, block));
+#else
+            releaseGlobal(block, index);
+#endif
+        }
+
+        /**
+         * The default allocator, based on the free lists of this file.
+         */
+        class PooledAllocator final : public Allocator
+        {
+        public:
+            void *allocate(glong size) override
+            {
+                return allocatePooled(size);
+            }
+
+            void deallocate(void *block, glong size) override
+            {
+                releasePooled(block, size);
+            }
+        };
+
+        static PooledAllocator pooledAllocator;
+
+        /**
+         * The allocators that may own blocks, indexed by their tag. The entry 0 is the
+         * default allocator (null). Each entry is written once, before its tag is published,
+         * so that the blocks allocated by an allocator are released by it after another
+         * allocator is installed.
+         */
+        static Allocator *volatile owners[Allocator::MAX_OWNERS] = {};
+
+        /**
+         * The number of used entries of @c owners, modified with the lock of the global lists.
+         */
+        static gint ownerCount = 1;
+
+        /**
+         * The tag of the installed allocator, 0 for the default one. It is read and written
+         * atomically, since any thread may allocate while another one installs.
+         */
+        static gint volatile installedOwner = 0;
+
+        static gint loadOwner()
+        {
+#if CORE_COMPILER_MSVC
+            // the volatile reads have the acquire semantic with msvc
+            return installedOwner;
+#else
+            return __atomic_load_n(&installedOwner, __ATOMIC_ACQUIRE);
+#endif
+        }
+
+        static void storeOwner(gint owner)
+        {
+#if CORE_COMPILER_MSVC
+            _InterlockedExchange(CORE_CAST(long volatile *, &installedOwner), owner);
+#else
+            __atomic_store_n(&installedOwner, owner, __ATOMIC_RELEASE);
+#endif
+        }
+
+        static Allocator *ownerAllocator(gint owner)
+        {
+            if (owner == 0) {
+                return null;
+            }
+#if CORE_COMPILER_MSVC
+            return owners[owner];
+#else
+            return __atomic_load_n(&owners[owner], __ATOMIC_ACQUIRE);
+#endif
+        }
+
+        static void storeOwnerAllocator(gint owner, Allocator *allocator)
+        {
+#if CORE_COMPILER_MSVC
+            _InterlockedExchangePointer(CORE_CAST(void *volatile *, &owners[owner]), allocator);
+#else
+            __atomic_store_n(&owners[owner], allocator, __ATOMIC_RELEASE);
+#endif
+        }
+
+        void *Allocator::allocateBlock(glong size, gint &owner)
+        {
+            owner = 0;
+            if (size <= 0) {
+                return null;
+            }
+            owner = loadOwner();
+            Allocator *allocator = ownerAllocator(owner);
+            return allocator == null ? allocatePooled(size) : allocator->allocate(size);
+        }
+
+        void Allocator::releaseBlock(void *block, glong size, gint owner)
+        {
+            if (block == null || size <= 0) {
+                return;
+            }
+            Allocator *allocator = ownerAllocator(owner);
+            allocator == null ? releasePooled(block, size) : allocator->deallocate(block, size);
+        }
+
+        void *Allocator::allocateBlock(glong size)
+        {
+            if (size <= 0) {
+                return null;
+            }
+            // the prefix keeps the tag of the owner, and the alignment of 8 bytes
+            gint owner = 0;
+            glong *words = CORE_CAST(glong *, allocateBlock(size + 8, owner));
+            words[0] = owner;
+            return words + 1;
+        }
+
+        void Allocator::releaseBlock(void *block, glong size)
+        {
+            if (block == null || size <= 0) {
+                return;
+            }
+            glong *words = CORE_CAST(glong *, block) - 1;
+            releaseBlock(words, size + 8, (gint) words[0]);
+        }
+
+        Allocator &Allocator::allocator()
+        {
+            Allocator *allocator = ownerAllocator(loadOwner());
+            return allocator == null ? defaultAllocator() : *allocator;
+        }
+
+        Allocator &Allocator::defaultAllocator()
+        {
+            return pooledAllocator;
+        }
+
+        void Allocator::setAllocator(Allocator &allocator)
+        {
+            if (&allocator == &pooledAllocator) {
+                storeOwner(0);
+                return;
+            }
+            gint owner = 0;
+            // the allocators are rarely installed, they share the lock of the global lists
+            lockPool();
+            for (gint i = 1; i < ownerCount; ++i) {
+                if (owners[i] == &allocator) {
+                    owner = i;
+                }
+            }
+            if (owner == 0 && ownerCount < MAX_OWNERS) {
+                owner = ownerCount;
+                storeOwnerAllocator(owner, &allocator);
+                ownerCount += 1;
+            }
+            unlockPool();
+            if (owner == 0) {
+                IllegalStateException("Too many allocators installed"_S).throws($ftrace(""_S));
+            }
+            storeOwner(owner);
+        }
+    } // misc
+} // core
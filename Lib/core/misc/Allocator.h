@@ -0,0 +1,115 @@
+//
+// Created by bruns on 20/06/2024.
+//
+
+#ifndef CORE24_ALLOCATOR_H
+#define CORE24_ALLOCATOR_H
+
+#include <core/Object.h>
+
+namespace core
+{
+    namespace misc
+    {
+        /**
+         * The class @c Allocator provides the memory blocks used to store
+         * the characters of the Strings and the values of the primitive arrays.
+         * <p>
+         * The default allocator keeps the released blocks up to 4096 bytes on
+         * free lists, one list for each size class (16, 32, 64, ..., 4096 bytes).
+         * Each thread has its own lists, so that the allocation and the release
+         * of the short-lived buffers does not need any synchronization. When the
+         * lists of a thread are full, the released blocks are moved to the
+         * global lists shared by all the threads. Larger blocks are allocated
+         * and released directly.
+         * <p>
+         * A custom allocator may be installed with @c setAllocator at any time.
+         * Each block records the tag of the allocator that provided it (in the
+         * header of the String buffers, in a prefix of 8 bytes for the other
+         * blocks), and it is always released by this owner, even when another
+         * allocator has been installed since.
+         * <p>
+         * The blocks released after the lists of their thread are destroyed
+         * (by the static Strings, at exit) go to the global lists.
+         */
+        class Allocator : public virtual Object
+        {
+        public:
+            /**
+             * Allocates a block of memory of the given size, aligned on 8 bytes.
+             * The content of the block is unspecified.
+             *
+             * @param size The number of bytes of the block (positive).
+             */
+            virtual void *allocate(glong size) = 0;
+
+            /**
+             * Releases the given block of memory, previously obtained by a call
+             * of @c allocate with the same size.
+             *
+             * @param block The block to release (never null).
+             * @param size The size given when the block was allocated.
+             */
+            virtual void deallocate(void *block, glong size) = 0;
+
+            /**
+             * Allocates a block of memory of the given size with the current allocator.
+             * The tag of this allocator is stored in a prefix of 8 bytes that precedes
+             * the returned block. Return null if the given size is not positive.
+             */
+            static void *allocateBlock(glong size);
+
+            /**
+             * Releases a block of memory obtained with @c allocateBlock, with the
+             * allocator that provided it. Nothing is made if the given block is null.
+             */
+            static void releaseBlock(void *block, glong size);
+
+            /**
+             * Allocates a block of memory of the given size with the current allocator,
+             * without prefix. The tag of the allocator is returned in @c owner and must be
+             * given back to @c releaseBlock. Return null if the given size is not positive.
+             *
+             * @param size The number of bytes of the block.
+             * @param owner Receives the tag of the allocator (from 0 to @c MAX_OWNERS-1).
+             */
+            static void *allocateBlock(glong size, gint &owner);
+
+            /**
+             * Releases a block of memory obtained with @c allocateBlock(glong,gint&),
+             * with the allocator of the given tag. Nothing is made if the given block is null.
+             */
+            static void releaseBlock(void *block, glong size, gint owner);
+
+            /**
+             * The maximal number of allocators that may own blocks, including the
+             * default one (the tag of the default allocator is 0).
+             */
+            static CORE_FAST gint MAX_OWNERS = 16;
+
+            /**
+             * Returns the current allocator.
+             */
+            static Allocator &allocator();
+
+            /**
+             * Returns the default pooled allocator.
+             */
+            static Allocator &defaultAllocator();
+
+            /**
+             * Installs the given allocator. The given allocator must live until
+             * the last block allocated with it is released. The blocks allocated
+             * before are still released by their own allocator.
+             *
+             * @param allocator The new allocator
+             *
+             * @throws IllegalStateException if @c MAX_OWNERS-1 other custom allocators
+             *          have already been installed.
+             */
+            static void setAllocator(Allocator &allocator);
+        };
+    } // misc
+} // core
+
+#endif // CORE24_ALLOCATOR_H
@@ -1363,6 +1363,11 @@ namespace core
 
 #else
 #define CORE_HAS_COMPACT_STRINGS 0
+#endif
+
+#ifndef CORE_HAS_SECURE_WIPE
+/* Define CORE_HAS_SECURE_WIPE to 1 to overwrite all the strings characters before release */
+#define CORE_HAS_SECURE_WIPE 0
 #endif
     } // misc
 } // core
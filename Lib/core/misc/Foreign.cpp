@@ -4,11 +4,13 @@
 
 #include "Foreign.h"
 #include <meta/StringUtils.h>
+#include <meta/StringKernels.h>
 #include <core/Math.h>
 #include <core/Integer.h>
 #include <core/Long.h>
 #include <core/Float.h>
 #include <core/Double.h>
+#include <core/IllegalArgumentException.h>
 
 namespace core
 {
@@ -39,59 +41,89 @@ namespace core
         }
 
         String Foreign::strUtf8(glong ptr, glong offset, glong count)
+        {
+            gint errorOffset = -1;
+            return strUtf8(ptr, offset, count, REPLACE, errorOffset);
+        }
+
+        String Foreign::strUtf8(glong ptr, glong offset, glong count, MalformedAction action, gint &errorOffset)
         {
             CORE_ALIAS(BYTES, Class<gbyte>::Pointer);
+            CORE_ALIAS(CHARS, Class<gchar>::Pointer);
             CORE_ALIAS(Utils, String::StringUtils);
+            String str;
             BYTES bytes = CORE_CAST(BYTES, ptr);
-            gint len = Math::clamp(count, 0, Integer::MAX_VALUE - 8);
-            if (bytes != null && offset >= 0 && count > 0) {
-                CharArray ca = CharArray(len);
-                gint size = 0;
-                for (int i = 0; i < count && size < len;) {
-                    if (bytes[i] >= 0) {
-                        ca.set(size++, bytes[i++]);
-                    } else if (bytes[i] >> 5 == -2) {
-                        if ((bytes[i] & 0x1e) == 0 || i + 1 >= count || (bytes[i + 1] & 0xc0) != 0x80) {
-                            ca.set(size++, '?');
-                        } else {
-                            ca.set(size++, ((bytes[i] << 6) ^ bytes[i + 1]) ^ (0xc0 << 6) ^ (0x80 << 0));
-                        }
-                        i += 2;
-                    } else if (bytes[i] >> 4 == -2) {
-                        if (i + 2 >= count
-                            || bytes[i] == (gbyte) 0xe0 && (bytes[i + 1] & 0xe0) == 0x80
-                            || (bytes[i + 1] & 0xc0) != 0x80
-                            || (bytes[i + 2] & 0xc0) != 0x80) {
-                            ca.set(size++, '?');
-                        } else {
-                            gchar ch = (bytes[i] << 12) ^ (bytes[i + 1] << 6) ^
-                                       (bytes[i + 2] ^ (0xe0 << 12) ^ (0x80 << 6) ^ (0x80 << 0));
-                            ca.set(size++, 0xd800 <= ch && ch <= 0xdfff ? '?' : ch);
-                        }
-                        i += 3;
-                    } else if (bytes[i] >> 3 == -2) {
-                        if (i + 3 >= count || (bytes[i + 1] & 0xc0) != 0x80
-                            || (bytes[i + 2] & 0xc0) != 0x80 || (bytes[i + 3] & 0xc0) != 0x80) {
-                            ca.set(size++, '?');
-                        } else {
-                            gint ch = ((bytes[i] << 18) ^ (bytes[i + 1] << 12) ^ (bytes[i + 2] << 6) ^ bytes[i + 3]) ^
-                                      ((0xf0 << 18) ^ (0x80 << 12) ^ (0x80 << 6) ^ (0x80 << 0));
-                            if (ch <= 0xffff)
-                                ca.set(size++, '?');
-                            else {
-                                ca.set(size++, (ch >> 10) + 0xd800 - (0x10000 >> 10));
-                                ca.set(size++, (ch & 0x3ff) + 0xdc00);
-                            }
-                        }
-                        i += 4;
-                    } else {
-                        ca.set(size++, '?');
-                        i += 1;
+            errorOffset = -1;
+            if (bytes == null || offset < 0 || count <= 0) {
+                return str;
+            }
+            bytes += offset;
+            gint size = Math::clamp(count, 0, Integer::MAX_VALUE - 8);
+            gint ascii = StringKernels::indexOfNonAscii(bytes, size);
+            if (ascii < 0) {
+                // ascii bytes are latin1 characters
+                return strLatin1(CORE_CAST(glong, bytes), 0, size);
+            }
+            // first pass: validate the bytes that follow the ascii prefix, count
+            // the characters and select the coder
+            gint length = ascii;
+            gbool latin1 = String::COMPACT_STRINGS;
+            gint i = ascii;
+            while (i < size) {
+                i += StringKernels::scanUTF8(bytes + i, size - i, length, latin1);
+                if (i == size) {
+                    break;
+                }
+                if (action == THROW) {
+                    IllegalArgumentException("Malformed input at offset "_S + String::valueOf(offset + i))
+                            .throws($ftrace(""_S));
+                }
+                if (action == REPORT) {
+                    errorOffset = (gint) (offset + i);
+                    size = i;
+                    break;
+                }
+                length += 1;
+                i += StringKernels::malformedUTF8(bytes + i, size - i);
+            }
+            if (length == 0) {
+                return str;
+            }
+            // second pass: copy the ascii prefix, then decode the bytes in the buffer of the string
+            gint k = ascii;
+            i = ascii;
+            if (latin1) {
+                BYTES dst = Utils::newLatin1String(length);
+                Utils::copyLatin1(bytes, 0, dst, 0, ascii);
+                while (i < size) {
+                    gint n = 0;
+                    i += StringKernels::decodeUTF8(bytes + i, size - i, dst + k, n);
+                    k += n;
+                    if (i < size) {
+                        dst[k++] = '?';
+                        i += StringKernels::malformedUTF8(bytes + i, size - i);
                     }
                 }
-                return String(ca, 0, size);
+                str.value = dst;
+                str.coder = String::LATIN1;
+            } else {
+                BYTES value = Utils::newUTF16String(length);
+                CHARS dst = CORE_FCAST(CHARS, value);
+                Utils::copyLatin1ToUTF16(bytes, 0, dst, 0, ascii);
+                while (i < size) {
+                    gint n = 0;
+                    i += StringKernels::decodeUTF8(bytes + i, size - i, dst + k, n);
+                    k += n;
+                    if (i < size) {
+                        dst[k++] = '?';
+                        i += StringKernels::malformedUTF8(bytes + i, size - i);
+                    }
+                }
+                str.value = value;
+                str.coder = String::UTF16;
             }
-            return ""_S;
+            str.count = length;
+            return str;
         }
 
         String Foreign::strUtf16(glong ptr, glong offset, glong count)
@@ -128,23 +160,14 @@ namespace core
             CORE_ALIAS(INTS, Class<gint>::Pointer);
             CORE_ALIAS(Utils, String::StringUtils);
             INTS chars = CORE_CAST(INTS, ptr);
-            count /= 2;
-            offset /= 2;
+            count /= 4;
+            offset /= 4;
             if (chars != null && offset >= 0 && count > 0) {
                 gint len = Math::clamp(count, 0, Integer::MAX_VALUE - 8);
                 gint off = Math::clamp(offset, 0, Integer::MAX_VALUE - 8);
-                if (String::COMPACT_STRINGS) {
-                    str.value = Utils::inflateUTF32ToLatin1(chars, off, len);
-                    if (str.value == null) {
-                        str.value = Utils::copyOfUTF32ToUTF16(chars, off, len, len);
-                        str.coder = String::UTF16;
-                    } else {
-                        str.coder = String::LATIN1;
-                    }
-                } else {
-                    str.value = Utils::copyOfUTF32ToUTF16(chars, off, len, len);
-                    str.coder = String::UTF16;
-                }
+                String::Coder coder = String::LATIN1;
+                str.value = Utils::copyOfUTF32(chars, off, len, coder, len);
+                str.coder = coder;
                 str.count = len;
             }
             return str;
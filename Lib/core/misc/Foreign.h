@@ -16,6 +16,20 @@ namespace core
 
         class Foreign final : public Object
         {
+        public:
+            /**
+             * The actions on the malformed sequences of the utf8 strings.
+             * <ul>
+             * <li> @c REPLACE replaces each malformed sequence by @c '?'.
+             * <li> @c THROW throws an @c IllegalArgumentException on the first malformed sequence.
+             * <li> @c REPORT stops the decoding on the first malformed sequence and stores its offset.
+             * </ul>
+             */
+            enum MalformedAction : gint
+            {
+                REPLACE, THROW, REPORT
+            };
+
         private:
             CORE_EXPLICIT Foreign();
 
@@ -23,6 +37,8 @@ namespace core
 
             static String strUtf8(glong ptr, glong offset, glong count);
 
+            static String strUtf8(glong ptr, glong offset, glong count, MalformedAction action, gint &errorOffset);
+
             static String strUtf16(glong ptr, glong offset, glong count);
 
             static String strUtf32(glong ptr, glong offset, glong count);
@@ -62,13 +78,32 @@ namespace core
                 try {
                     Precondition::checkIndexFromSize(offset, count, count0);
                     return isLatin1
-                           ? strLatin1(CORE_CAST(glong, str), 0, count)
-                           : strUtf8(CORE_CAST(glong, str), 0, count);
+                           ? strLatin1(CORE_CAST(glong, str), offset, count)
+                           : strUtf8(CORE_CAST(glong, str), offset, count);
                 } catch (Throwable const &ex) {
                     ex.throws(Trace("core::misc::Foreign"_S, str(CORE_FUNCTION), str(CORE_FILE), CORE_LINE));
                 }
             }
 
+            /**
+             * Returns the string decoded from the given utf8 characters, the malformed
+             * sequences are handled with the given action. The offset of the first
+             * malformed sequence is stored in the given variable (-1 if there is none).
+             * <p>
+             * The characters are validated and counted in a first pass that selects
+             * the coder of the string, and are decoded in its buffer in a second pass.
+             */
+            template<class Str,
+                    ClassOf(1)::OnlyIf<Class<Str>::isArray()> = 1,
+                    class ChrT = typename Class<Str>::ArrayElement,
+                    ClassOf(1)::OnlyIf<Class<ChrT>::isCharacter() && sizeof(ChrT) == 1> = 1>
+            static String str(Str &&str, gint offset, gint count, MalformedAction action, gint &errorOffset)
+            {
+                gint count0 = Class<Str>::MEMORY_SIZE;
+                Precondition::checkIndexFromSize(offset, count, count0);
+                return strUtf8(CORE_CAST(glong, str), offset, count, action, errorOffset);
+            }
+
             template<class Str,
                     ClassOf(1)::OnlyIf<Class<Str>::isString() && Class<Str>::isArray()> = 1,
                     class CharT = typename Class<Str>::ArrayElement
@@ -122,6 +157,15 @@ namespace core
                        : strUtf8(CORE_CAST(glong, str), offset, count);
             }
 
+            template<class Str,
+                    ClassOf(1)::OnlyIf<Class<Str>::isPointer()> = 1,
+                    class ChrT = typename Class<Str>::PointerTarget,
+                    ClassOf(1)::OnlyIf<Class<ChrT>::isCharacter() && sizeof(ChrT) == 1> = 1>
+            static String str(Str &&str, gint offset, gint count, MalformedAction action, gint &errorOffset)
+            {
+                return strUtf8(CORE_CAST(glong, str), offset, count, action, errorOffset);
+            }
+
             template<class Str,
                     ClassOf(1)::OnlyIf<Class<Str>::isString() && Class<Str>::isPointer()> = 1,
                     class CharT = typename Class<Str>::ArrayElement
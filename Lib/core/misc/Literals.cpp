@@ -9,6 +9,7 @@
 #include <core/Complex.h>
 #include <core/Throwable.h>
 #include <core/misc/Foreign.h>
+#include <meta/StringUtils.h>
 
 namespace core
 {
@@ -16,26 +17,58 @@ namespace core
     {
     } // misc
 
+    /**
+     * Return the number of ascii characters at the beginning of the given literal,
+     * and store the hash of these characters in the given variable (the same as
+     * the one returned by @c String::hash). The characters are checked by words
+     * of 8 bytes when possible.
+     */
+    static gint asciiLength(misc::__literal_chr_t const *str, gint length, gint &hash)
+    {
+        gint i = 0;
+        misc::__uint32_t h = 0;
+        if ((CORE_CAST(glong, str) & 7) == 0) {
+            for (; i + 8 <= length; i += 8) {
+                if ((*CORE_CAST(glong const *, str + i) & (glong) 0x8080808080808080ULL) != 0) {
+                    break;
+                }
+                for (int j = 0; j < 8; ++j) {
+                    h = h * 31 + (misc::__uint32_t) str[i + j];
+                }
+            }
+        }
+        while (i < length && (str[i] & 0x80) == 0) {
+            h = h * 31 + (misc::__uint32_t) str[i];
+            i += 1;
+        }
+        hash = (gint) h;
+        return i;
+    }
+
     String operator ""_S(misc::__literal_chr_t const *str, misc::__memory_size_t size)
     {
         gint length = (gint) (size & 0x7fffffff);
         if (length == 0) {
             return String();
         }
-        gbool isAscii = true;
-        gint i = 0;
-        for (; i < length; ++i) {
-            if (str[i] < 0) {
-                isAscii = false;
-                break;
+        gint hash = 0;
+        gint i = asciiLength(str, length, hash);
+        if (i == length) {
+            String literal;
+            // The hash of the literal is computed while it is checked
+            literal.cacheHash(hash);
+            if (String::COMPACT_STRINGS) {
+                // The latin1 representation of ascii literal is the literal itself.
+                literal.value = CORE_CAST(String::BYTES, str);
+                literal.valueIsStatic = true;
+                literal.coder = String::LATIN1;
+                literal.count = length;
             }
-        }
-        if (isAscii) {
-            ByteArray array = ByteArray(length);
-            for (i = 0; i < length; ++i) {
-                array.set(i, str[i]);
+            else {
+                literal.allocate(String::UTF16, length);
+                String::StringUtils::copyLatin1ToUTF16(CORE_CAST(String::BYTES, str), 0, literal.value, 0, length);
             }
-            return String(array, 0);
+            return literal;
         }
         else {
             // utf-8 or latin-1
@@ -153,56 +186,64 @@ namespace core
     String operator ""_S(misc::__ucs2_t const *str, misc::__memory_size_t size)
     {
         gint length = (gint) (size & 0x7fffffff);
-        gint hibyte = 0;
+        if (length == 0) {
+            return String();
+        }
+        String literal;
+        // The hash of the literal is computed while it is checked
+        misc::__uint32_t hash = 0;
         gint i = 0;
-        for (; i < length; ++i) {
-            if (str[i] > 0x7f) {
-                if (i > 0 && str[i] >> 8 != hibyte)
-                    break;
-                hibyte = str[i] >> 8;
+        if (String::COMPACT_STRINGS) {
+            while (i < length && String::StringUtils::isLatin1(str[i])) {
+                hash = hash * 31 + str[i];
+                i += 1;
+            }
+            if (i == length) {
+                // Compressible literal
+                literal.allocate(String::LATIN1, length);
+                String::StringUtils::copyUTF16ToLatin1(CORE_CAST(String::CHARS, str), 0, literal.value, 0, length);
+                literal.cacheHash((gint) hash);
+                return literal;
             }
         }
-
-        if (i == length) {
-            ByteArray array = ByteArray(length);
-            for (i = 0; i < length; ++i)
-                array.set(i, (gbyte) (str[i] & 0xff));
-            return String(array, hibyte);
-        }
-        else {
-            CharArray array = CharArray(length);
-            for (i = 0; i < length; ++i)
-                array.set(i, str[i]);
-            return String(array);
+        for (; i < length; ++i) {
+            hash = hash * 31 + str[i];
         }
+        literal.cacheHash((gint) hash);
+        // The utf16 representation of the literal is the literal itself.
+        literal.value = CORE_CAST(String::BYTES, str);
+        literal.valueIsStatic = true;
+        literal.coder = String::UTF16;
+        literal.count = length;
+        return literal;
     }
 
     String operator ""_S(misc::__ucs4_t const *str, misc::__memory_size_t size)
     {
-        gint length = (gint) size;
-        gint hibyte = 0;
-        gint i = 0;
-        for (; i < length; ++i) {
-            if (str[i] > 0x7f) {
-                if (i > 0 && str[i] >> 8 != hibyte)
-                    break;
-                hibyte = str[i] >> 8;
-                if (hibyte > 0xff)
-                    break;
-            }
-        }
-        if (i == length) {
-            ByteArray array = ByteArray(length);
-            for (i = 0; i < length; ++i)
-                array.set(i, (gbyte) (str[i] & 0xff));
-            return String(array, hibyte);
+        gint length = (gint) (size & 0x7fffffff);
+        if (length == 0) {
+            return String();
         }
-        else {
-            IntArray array = IntArray(length);
-            for (i = 0; i < length; ++i)
-                array.set(i, str[i] > 0x10ffff ? 63 : (gint) str[i]);
-            return String(array, 0, length);
+        String literal;
+        if (String::COMPACT_STRINGS) {
+            gint i = 0;
+            while (i < length && String::StringUtils::isLatin1(str[i])) {
+                i += 1;
+            }
+            if (i == length) {
+                // Compressible literal
+                literal.allocate(String::LATIN1, length);
+                for (i = 0; i < length; ++i) {
+                    String::StringUtils::writeLatin1CharAt(literal.value, i, (gchar) str[i]);
+                }
+                return literal;
+            }
         }
+        gint count = 0;
+        literal.value = String::StringUtils::copyOfUTF32ToUTF16(CORE_CAST(String::INTS, str), 0, length, count);
+        literal.coder = String::UTF16;
+        literal.count = count;
+        return literal;
     }
 
     String operator ""_S(wchar_t const *str, misc::__memory_size_t size)
@@ -212,218 +253,218 @@ namespace core
                : operator ""_S(CORE_CAST(misc::__ucs4_t const *, str), size);
     }
 
-    String operator+(String const &lhs, String const &rhs)
+    StringConcat< String const &, String const & > operator+(String const &lhs, String const &rhs)
     {
         try {
-            return lhs.concat(rhs);
+            return {lhs, rhs};
         }
         catch (Throwable const &ex) {
             ex.throws($ftrace(""_S));
         }
     }
 
-    String core::operator+(String const &lhs, Object const &rhs)
+    StringConcat< String const &, String > core::operator+(String const &lhs, Object const &rhs)
     {
         try {
-            return lhs.concat(String::valueOf(rhs));
+            return {lhs, String::valueOf(rhs)};
         }
         catch (Throwable const &ex) {
             ex.throws($ftrace(""_S));
         }
     }
 
-    String core::operator+(Object const &lhs, String const &rhs)
+    StringConcat< String, String const & > core::operator+(Object const &lhs, String const &rhs)
     {
         try {
-            return String::valueOf(lhs).concat(rhs);
+            return {String::valueOf(lhs), rhs};
         }
         catch (Throwable const &ex) {
             ex.throws($ftrace(""_S));
         }
     }
 
-    String core::operator+(String const &lhs, gint rhs)
+    StringConcat< String const &, String > core::operator+(String const &lhs, gint rhs)
     {
         try {
-            return lhs.concat(String::valueOf(rhs));
+            return {lhs, String::valueOf(rhs)};
         }
         catch (Throwable const &ex) {
             ex.throws($ftrace(""_S));
         }
     }
 
-    String core::operator+(String const &lhs, gfloat rhs)
+    StringConcat< String const &, String > core::operator+(String const &lhs, gfloat rhs)
     {
         try {
-            return lhs.concat(String::valueOf(rhs));
+            return {lhs, String::valueOf(rhs)};
         }
         catch (Throwable const &ex) {
             ex.throws($ftrace(""_S));
         }
     }
 
-    String core::operator+(String const &lhs, gdouble rhs)
+    StringConcat< String const &, String > core::operator+(String const &lhs, gdouble rhs)
     {
         try {
-            return lhs.concat(String::valueOf(rhs));
+            return {lhs, String::valueOf(rhs)};
         }
         catch (Throwable const &ex) {
             ex.throws($ftrace(""_S));
         }
     }
 
-    String core::operator+(String const &lhs, void *rhs)
+    StringConcat< String const &, String > core::operator+(String const &lhs, void *rhs)
     {
         try {
-            return lhs.concat(("0x"_S + Long::toHexString((glong) rhs)));
+            return {lhs, "0x"_S + Long::toHexString((glong) rhs)};
         }
         catch (Throwable const &ex) {
             ex.throws($ftrace(""_S));
         }
     }
 
-    String core::operator+(String const &lhs, unsigned int rhs)
+    StringConcat< String const &, String > core::operator+(String const &lhs, unsigned int rhs)
     {
         try {
-            return lhs.concat(Integer::toUnsignedString((gint) rhs));
+            return {lhs, Integer::toUnsignedString((gint) rhs)};
         }
         catch (Throwable const &ex) {
             ex.throws($ftrace(""_S));
         }
     }
 
-    String core::operator+(String const &lhs, long rhs)
+    StringConcat< String const &, String > core::operator+(String const &lhs, long rhs)
     {
         try {
-            return lhs.concat((ClassOf(rhs)::MEMORY_SIZE == 8
-                               ? String::valueOf((glong) rhs)
-                               : String::valueOf((gint) rhs)));
+            return {lhs, ClassOf(rhs)::MEMORY_SIZE == 8
+                    ? String::valueOf((glong) rhs)
+                    : String::valueOf((gint) rhs)};
         }
         catch (Throwable const &ex) {
             ex.throws($ftrace(""_S));
         }
     }
 
-    String core::operator+(String const &lhs, unsigned long rhs)
+    StringConcat< String const &, String > core::operator+(String const &lhs, unsigned long rhs)
     {
         try {
-            return lhs.concat((ClassOf(rhs)::MEMORY_SIZE == 8
-                               ? Long::toUnsignedString((glong) rhs)
-                               : Integer::toUnsignedString((gint) rhs)));
+            return {lhs, ClassOf(rhs)::MEMORY_SIZE == 8
+                    ? Long::toUnsignedString((glong) rhs)
+                    : Integer::toUnsignedString((gint) rhs)};
         }
         catch (Throwable const &ex) {
             ex.throws($ftrace(""_S));
         }
     }
 
-    String core::operator+(String const &lhs, long long rhs)
+    StringConcat< String const &, String > core::operator+(String const &lhs, long long rhs)
     {
         try {
-            return lhs.concat(String::valueOf((glong) rhs));
+            return {lhs, String::valueOf((glong) rhs)};
         }
         catch (Throwable const &ex) {
             ex.throws($ftrace(""_S));
         }
     }
 
-    String core::operator+(String const &lhs, unsigned long long rhs)
+    StringConcat< String const &, String > core::operator+(String const &lhs, unsigned long long rhs)
     {
         try {
-            return lhs.concat(Long::toUnsignedString((glong) rhs));
+            return {lhs, Long::toUnsignedString((glong) rhs)};
         }
         catch (Throwable const &ex) {
             ex.throws($ftrace(""_S));
         }
     }
 
-    String core::operator+(gint lhs, String const &rhs)
+    StringConcat< String, String const & > core::operator+(gint lhs, String const &rhs)
     {
         try {
-            return String::valueOf(lhs).concat(rhs);
+            return {String::valueOf(lhs), rhs};
         }
         catch (Throwable const &ex) {
             ex.throws($ftrace(""_S));
         }
     }
 
-    String core::operator+(unsigned int lhs, String const &rhs)
+    StringConcat< String, String const & > core::operator+(unsigned int lhs, String const &rhs)
     {
         try {
-            return Integer::toUnsignedString((gint) lhs).concat(rhs);
+            return {Integer::toUnsignedString((gint) lhs), rhs};
         }
         catch (Throwable const &ex) {
             ex.throws($ftrace(""_S));
         }
     }
 
-    String core::operator+(long lhs, String const &rhs)
+    StringConcat< String, String const & > core::operator+(long lhs, String const &rhs)
     {
         try {
-            return (ClassOf(lhs)::MEMORY_SIZE == 8
-                    ? String::valueOf((glong) lhs)
-                    : String::valueOf((gint) lhs)).concat(rhs);
+            return {(ClassOf(lhs)::MEMORY_SIZE == 8
+                     ? String::valueOf((glong) lhs)
+                     : String::valueOf((gint) lhs)), rhs};
         }
         catch (Throwable const &ex) {
             ex.throws($ftrace(""_S));
         }
     }
 
-    String core::operator+(unsigned long lhs, String const &rhs)
+    StringConcat< String, String const & > core::operator+(unsigned long lhs, String const &rhs)
     {
         try {
-            return (ClassOf(lhs)::MEMORY_SIZE == 8
-                    ? Long::toUnsignedString((glong) lhs)
-                    : Integer::toUnsignedString((gint) lhs)).concat(rhs);
+            return {(ClassOf(lhs)::MEMORY_SIZE == 8
+                     ? Long::toUnsignedString((glong) lhs)
+                     : Integer::toUnsignedString((gint) lhs)), rhs};
         }
         catch (Throwable const &ex) {
             ex.throws($ftrace(""_S));
         }
     }
 
-    String core::operator+(long long lhs, String const &rhs)
+    StringConcat< String, String const & > core::operator+(long long lhs, String const &rhs)
     {
         try {
-            return String::valueOf((glong) lhs).concat(rhs);
+            return {String::valueOf((glong) lhs), rhs};
         }
         catch (Throwable const &ex) {
             ex.throws($ftrace(""_S));
         }
     }
 
-    String core::operator+(unsigned long long lhs, String const &rhs)
+    StringConcat< String, String const & > core::operator+(unsigned long long lhs, String const &rhs)
     {
         try {
-            return Long::toUnsignedString((glong) lhs).concat(rhs);
+            return {Long::toUnsignedString((glong) lhs), rhs};
         }
         catch (Throwable const &ex) {
             ex.throws($ftrace(""_S));
         }
     }
 
-    String core::operator+(gfloat lhs, String const &rhs)
+    StringConcat< String, String const & > core::operator+(gfloat lhs, String const &rhs)
     {
         try {
-            return String::valueOf(lhs).concat(rhs);
+            return {String::valueOf(lhs), rhs};
         }
         catch (Throwable const &ex) {
             ex.throws($ftrace(""_S));
         }
     }
 
-    String core::operator+(gdouble lhs, String const &rhs)
+    StringConcat< String, String const & > core::operator+(gdouble lhs, String const &rhs)
     {
         try {
-            return String::valueOf(lhs).concat(rhs);
+            return {String::valueOf(lhs), rhs};
         }
         catch (Throwable const &ex) {
             ex.throws($ftrace(""_S));
         }
     }
 
-    String core::operator+(void *lhs, String const &rhs)
+    StringConcat< String, String const & > core::operator+(void *lhs, String const &rhs)
     {
         try {
-            return String::valueOf(lhs).concat(rhs);
+            return {String::valueOf(lhs), rhs};
         }
         catch (Throwable const &ex) {
             ex.throws($ftrace(""_S));
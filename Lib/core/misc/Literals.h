@@ -18,6 +18,13 @@ namespace core
 
     class XString;
 
+    class StringSlice;
+
+    class SegmentedXString;
+
+    template<class Lhs, class Rhs>
+    class StringConcat;
+
     class BooleanArray;
 
     class ByteArray;
@@ -229,52 +236,52 @@ namespace core
 #endif
 
     /**
-     * Obtain newly created @c String that contains the
-     * concatenation of given strings
+     * Obtain the lazy concatenation of given strings. The result
+     * is converted to @c String with a single allocation.
      */
-    extern String operator+(String const &, String const &);
+    extern StringConcat< String const &, String const & > operator+(String const &, String const &);
 
-    extern String operator+(String const &, Object const &);
+    extern StringConcat< String const &, String > operator+(String const &, Object const &);
 
-    extern String operator+(Object const &, String const &);
+    extern StringConcat< String, String const & > operator+(Object const &, String const &);
 
-    extern String operator+(String const &, gint);
+    extern StringConcat< String const &, String > operator+(String const &, gint);
 
-    extern String operator+(String const &, gfloat);
+    extern StringConcat< String const &, String > operator+(String const &, gfloat);
 
-    extern String operator+(String const &, gdouble);
+    extern StringConcat< String const &, String > operator+(String const &, gdouble);
 
-    extern String operator+(String const &, void *);
+    extern StringConcat< String const &, String > operator+(String const &, void *);
 
-    extern String operator+(gint, String const &);
+    extern StringConcat< String, String const & > operator+(gint, String const &);
 
-    extern String operator+(gfloat, String const &);
+    extern StringConcat< String, String const & > operator+(gfloat, String const &);
 
-    extern String operator+(gdouble, String const &);
+    extern StringConcat< String, String const & > operator+(gdouble, String const &);
 
-    extern String operator+(void *, String const &);
+    extern StringConcat< String, String const & > operator+(void *, String const &);
 
     // Specials Case.
 
-    extern String operator+(String const &, unsigned int);
+    extern StringConcat< String const &, String > operator+(String const &, unsigned int);
 
-    extern String operator+(String const &, long);
+    extern StringConcat< String const &, String > operator+(String const &, long);
 
-    extern String operator+(String const &, unsigned long);
+    extern StringConcat< String const &, String > operator+(String const &, unsigned long);
 
-    extern String operator+(String const &, long long);
+    extern StringConcat< String const &, String > operator+(String const &, long long);
 
-    extern String operator+(String const &, unsigned long long);
+    extern StringConcat< String const &, String > operator+(String const &, unsigned long long);
 
-    extern String operator+(unsigned int, String const &);
+    extern StringConcat< String, String const & > operator+(unsigned int, String const &);
 
-    extern String operator+(long, String const &);
+    extern StringConcat< String, String const & > operator+(long, String const &);
 
-    extern String operator+(unsigned long, String const &);
+    extern StringConcat< String, String const & > operator+(unsigned long, String const &);
 
-    extern String operator+(long long, String const &);
+    extern StringConcat< String, String const & > operator+(long long, String const &);
 
-    extern String operator+(unsigned long long, String const &);
+    extern StringConcat< String, String const & > operator+(unsigned long long, String const &);
 
     extern String &operator+=(String &lhs, String const &rhs);
 
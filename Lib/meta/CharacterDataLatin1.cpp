@@ -117,7 +117,7 @@ namespace core
 
     gbool CharacterDataLatin1::isWhitespace(gint ch)
     {
-        return (properties(ch) & 0x00007000) != 0;
+        return (properties(ch) & 0x00007000) == 0x00004000;
     }
 
     gbyte CharacterDataLatin1::directionality(gint ch)
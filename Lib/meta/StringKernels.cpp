@@ -0,0 +1,2690 @@
+//
+// Created by bruns on 21/06/2024.
+//
+
+#include "StringKernels.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__)) \
+ || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CORE_STRING_KERNELS_X86 1
+
+#if CORE_COMPILER_MSVC
+#include <intrin.h>
+#define CORE_TARGET_AVX2
+#else
+#include <immintrin.h>
+#define CORE_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+#else
+#define CORE_STRING_KERNELS_X86 0
+#endif
+
+extern "C" void *memmove(void *, void const *, core::misc::__memory_size_t);
+
+namespace core
+{
+    static StringKernels::Features detectFeatures()
+    {
+#if CORE_STRING_KERNELS_X86 && CORE_COMPILER_MSVC
+        int info[4] = {};
+        __cpuid(info, 0);
+        gint maxLeaf = info[0];
+        __cpuid(info, 1);
+        // The ymm registers must be saved by the operating system
+        gbool osxsave = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0;
+        if (maxLeaf >= 7 && osxsave && (_xgetbv(0) & 6) == 6) {
+            __cpuidex(info, 7, 0);
+            if ((info[1] & (1 << 5)) != 0) {
+                return StringKernels::AVX2;
+            }
+        }
+        return StringKernels::SSE2;
+#elif CORE_STRING_KERNELS_X86
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") ? StringKernels::AVX2 : StringKernels::SSE2;
+#else
+        return StringKernels::SCALAR;
+#endif
+    }
+
+    /**
+     * The best instructions set allowed by restrictFeatures.
+     */
+    static gint volatile allowedFeatures = StringKernels::AVX2;
+
+    StringKernels::Features StringKernels::features()
+    {
+        static Features const features = detectFeatures();
+        gint allowed = allowedFeatures;
+        return features < allowed ? features : CORE_FCAST(Features, allowed);
+    }
+
+    void StringKernels::restrictFeatures(Features features)
+    {
+        allowedFeatures = features;
+    }
+
+    void StringKernels::copyBytes(BYTES src, BYTES dst, glong size)
+    {
+        if (size > 0 && src != dst) {
+            memmove(dst, src, (misc::__memory_size_t) size);
+        }
+    }
+
+#if CORE_STRING_KERNELS_X86
+
+    static gint widenLatin1SSE2(StringKernels::BYTES src, StringKernels::CHARS dst, gint count)
+    {
+        __m128i const zero = _mm_setzero_si128();
+        gint i = 0;
+        for (; i + 16 <= count; i += 16) {
+            __m128i bytes = _mm_loadu_si128(CORE_CAST(__m128i const *, src + i));
+            _mm_storeu_si128(CORE_CAST(__m128i *, dst + i), _mm_unpacklo_epi8(bytes, zero));
+            _mm_storeu_si128(CORE_CAST(__m128i *, dst + i + 8), _mm_unpackhi_epi8(bytes, zero));
+        }
+        return i;
+    }
+
+    CORE_TARGET_AVX2
+    static gint widenLatin1AVX2(StringKernels::BYTES src, StringKernels::CHARS dst, gint count)
+    {
+        gint i = 0;
+        for (; i + 32 <= count; i += 32) {
+            __m128i bytes1 = _mm_loadu_si128(CORE_CAST(__m128i const *, src + i));
+            __m128i bytes2 = _mm_loadu_si128(CORE_CAST(__m128i const *, src + i + 16));
+            _mm256_storeu_si256(CORE_CAST(__m256i *, dst + i), _mm256_cvtepu8_epi16(bytes1));
+            _mm256_storeu_si256(CORE_CAST(__m256i *, dst + i + 16), _mm256_cvtepu8_epi16(bytes2));
+        }
+        return i;
+    }
+
+    static gint narrowUTF16SSE2(StringKernels::CHARS src, StringKernels::BYTES dst, gint count)
+    {
+        __m128i const mask = _mm_set1_epi16(0xff);
+        gint i = 0;
+        for (; i + 16 <= count; i += 16) {
+            __m128i chars1 = _mm_and_si128(_mm_loadu_si128(CORE_CAST(__m128i const *, src + i)), mask);
+            __m128i chars2 = _mm_and_si128(_mm_loadu_si128(CORE_CAST(__m128i const *, src + i + 8)), mask);
+            _mm_storeu_si128(CORE_CAST(__m128i *, dst + i), _mm_packus_epi16(chars1, chars2));
+        }
+        return i;
+    }
+
+    CORE_TARGET_AVX2
+    static gint narrowUTF16AVX2(StringKernels::CHARS src, StringKernels::BYTES dst, gint count)
+    {
+        __m256i const mask = _mm256_set1_epi16(0xff);
+        gint i = 0;
+        for (; i + 32 <= count; i += 32) {
+            __m256i chars1 = _mm256_and_si256(_mm256_loadu_si256(CORE_CAST(__m256i const *, src + i)), mask);
+            __m256i chars2 = _mm256_and_si256(_mm256_loadu_si256(CORE_CAST(__m256i const *, src + i + 16)), mask);
+            // packus works on each 128 bits lane, the permutation restores the order
+            __m256i bytes = _mm256_permute4x64_epi64(_mm256_packus_epi16(chars1, chars2), 0xd8);
+            _mm256_storeu_si256(CORE_CAST(__m256i *, dst + i), bytes);
+        }
+        return i;
+    }
+
+    static gint compressUTF16SSE2(StringKernels::CHARS src, StringKernels::BYTES dst, gint count)
+    {
+        __m128i const mask = _mm_set1_epi16((gshort) 0xff00);
+        __m128i const zero = _mm_setzero_si128();
+        gint i = 0;
+        for (; i + 16 <= count; i += 16) {
+            __m128i chars1 = _mm_loadu_si128(CORE_CAST(__m128i const *, src + i));
+            __m128i chars2 = _mm_loadu_si128(CORE_CAST(__m128i const *, src + i + 8));
+            __m128i high = _mm_and_si128(_mm_or_si128(chars1, chars2), mask);
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(high, zero)) != 0xffff) {
+                // a character above 0xFF, located by the scalar loop
+                break;
+            }
+            _mm_storeu_si128(CORE_CAST(__m128i *, dst + i), _mm_packus_epi16(chars1, chars2));
+        }
+        return i;
+    }
+
+    CORE_TARGET_AVX2
+    static gint compressUTF16AVX2(StringKernels::CHARS src, StringKernels::BYTES dst, gint count)
+    {
+        __m256i const mask = _mm256_set1_epi16((gshort) 0xff00);
+        gint i = 0;
+        for (; i + 32 <= count; i += 32) {
+            __m256i chars1 = _mm256_loadu_si256(CORE_CAST(__m256i const *, src + i));
+            __m256i chars2 = _mm256_loadu_si256(CORE_CAST(__m256i const *, src + i + 16));
+            if (!_mm256_testz_si256(_mm256_or_si256(chars1, chars2), mask)) {
+                // a character above 0xFF, located by the scalar loop
+                break;
+            }
+            __m256i bytes = _mm256_permute4x64_epi64(_mm256_packus_epi16(chars1, chars2), 0xd8);
+            _mm256_storeu_si256(CORE_CAST(__m256i *, dst + i), bytes);
+        }
+        return i;
+    }
+
+#endif
+
+    void StringKernels::widenLatin1(BYTES src, CHARS dst, gint count)
+    {
+        gint i = 0;
+#if CORE_STRING_KERNELS_X86
+        i = features() == AVX2 ? widenLatin1AVX2(src, dst, count) : widenLatin1SSE2(src, dst, count);
+#endif
+        for (; i < count; ++i) {
+            dst[i] = (gchar) (src[i] & 0xff);
+        }
+    }
+
+    void StringKernels::narrowUTF16(CHARS src, BYTES dst, gint count)
+    {
+        gint i = 0;
+#if CORE_STRING_KERNELS_X86
+        i = features() == AVX2 ? narrowUTF16AVX2(src, dst, count) : narrowUTF16SSE2(src, dst, count);
+#endif
+        for (; i < count; ++i) {
+            dst[i] = (gbyte) (src[i] & 0xff);
+        }
+    }
+
+    gint StringKernels::compressUTF16(CHARS src, BYTES dst, gint count)
+    {
+        gint i = 0;
+#if CORE_STRING_KERNELS_X86
+        i = features() == AVX2 ? compressUTF16AVX2(src, dst, count) : compressUTF16SSE2(src, dst, count);
+#endif
+        for (; i < count; ++i) {
+            if ((src[i] >> 8) != 0) {
+                break;
+            }
+            dst[i] = (gbyte) src[i];
+        }
+        return i;
+    }
+
+    /**
+     * The longest strings searched by blocks of characters, the longer
+     * ones are searched with the Two-Way algorithm.
+     */
+    static CORE_FAST gint SHORT_STRING_LENGTH = 32;
+
+    static gint charOf(gbyte b)
+    {
+        return b & 0xff;
+    }
+
+    static gint charOf(gchar c)
+    {
+        return c;
+    }
+
+    /**
+     * The characters read from the first one.
+     */
+    template<class T>
+    struct Forward
+    {
+        T const *chars;
+
+        gint operator[](gint index) const
+        {
+            return charOf(chars[index]);
+        }
+    };
+
+    /**
+     * The characters read from the last one.
+     */
+    template<class T>
+    struct Backward
+    {
+        T const *chars;
+        gint count;
+
+        gint operator[](gint index) const
+        {
+            return charOf(chars[count - 1 - index]);
+        }
+    };
+
+    /**
+     * Return the index preceding the maximal suffix of the given string, for the
+     * natural order of the characters or for the reversed one, and store the
+     * period of this suffix in the given variable.
+     */
+    template<class N>
+    static gint maximalSuffix(N const &str, gint length, gbool reversed, gint &period)
+    {
+        gint ip = -1;
+        gint jp = 0;
+        gint k = 1;
+        gint p = 1;
+        while (jp + k < length) {
+            gint a = str[ip + k];
+            gint b = str[jp + k];
+            if (a == b) {
+                if (k == p) {
+                    jp += p;
+                    k = 1;
+                }
+                else {
+                    k += 1;
+                }
+            }
+            else if (reversed ? a < b : a > b) {
+                jp += k;
+                k = 1;
+                p = jp - ip;
+            }
+            else {
+                ip = jp;
+                jp += 1;
+                k = p = 1;
+            }
+        }
+        period = p;
+        return ip;
+    }
+
+    /**
+     * Search the given string in the given characters from the given index,
+     * with the Two-Way algorithm of Crochemore and Perrin: linear time and
+     * constant space.
+     */
+    template<class H, class N>
+    static gint twoWaySearch(H const &src, gint count, N const &str, gint length, gint from)
+    {
+        // critical factorization of the string
+        gint period = 1;
+        gint period2 = 1;
+        gint split = maximalSuffix(str, length, false, period);
+        gint split2 = maximalSuffix(str, length, true, period2);
+        if (split2 > split) {
+            split = split2;
+            period = period2;
+        }
+
+        gbool periodic = split + 1 + period <= length;
+        for (gint i = 0; periodic && i <= split; ++i) {
+            periodic = str[i] == str[i + period];
+        }
+
+        gint memory0 = 0;
+        if (periodic) {
+            // the prefix already matched after a shift of one period
+            memory0 = length - period;
+        }
+        else {
+            period = (split > length - split - 1 ? split : length - split - 1) + 1;
+        }
+
+        gint memory = 0;
+        gint i = from;
+        while (i <= count - length) {
+            // right half of the string
+            gint k = split + 1 > memory ? split + 1 : memory;
+            while (k < length && str[k] == src[i + k]) {
+                k += 1;
+            }
+            if (k < length) {
+                i += k - split;
+                memory = 0;
+                continue;
+            }
+            // left half of the string
+            k = split + 1;
+            while (k > memory && str[k - 1] == src[i + k - 1]) {
+                k -= 1;
+            }
+            if (k <= memory) {
+                return i;
+            }
+            i += period;
+            memory = memory0;
+        }
+        return -1;
+    }
+
+    /**
+     * Return true if the given string is found at the given index of the given
+     * characters, knowing that its first and last characters are found. The
+     * number of compared characters is added to the given counter.
+     */
+    template<class T, class N>
+    static gbool matches(T const *src, gint index, N const *str, gint length, glong &work)
+    {
+        gint j = 1;
+        while (j < length - 1 && charOf(src[index + j]) == charOf(str[j])) {
+            j += 1;
+        }
+        work += j;
+        return j >= length - 1;
+    }
+
+    /**
+     * Return true if the work of the searches by blocks is too high compared
+     * to the number of characters already scanned, then the search continues
+     * with the Two-Way algorithm to keep it linear.
+     */
+    static gbool tooMuchWork(glong work, gint scanned)
+    {
+        return work > ((glong) scanned << 2) + 256;
+    }
+
+#if CORE_STRING_KERNELS_X86
+
+    static gint lowestBit(gint mask)
+    {
+#if CORE_COMPILER_MSVC
+        unsigned long index = 0;
+        _BitScanForward(&index, (unsigned long) mask);
+        return (gint) index;
+#else
+        return __builtin_ctz((unsigned) mask);
+#endif
+    }
+
+    static gint highestBit(gint mask)
+    {
+#if CORE_COMPILER_MSVC
+        unsigned long index = 0;
+        _BitScanReverse(&index, (unsigned long) mask);
+        return (gint) index;
+#else
+        return 31 - __builtin_clz((unsigned) mask);
+#endif
+    }
+
+    /**
+     * Count the bits set in the movemask (without the popcnt instruction,
+     * that is not part of SSE2).
+     */
+    static gint bitCount(gint mask)
+    {
+        misc::__uint32_t i = (misc::__uint32_t) mask;
+        i = i - ((i >> 1) & 0x55555555u);
+        i = (i & 0x33333333u) + ((i >> 2) & 0x33333333u);
+        i = (i + (i >> 4)) & 0x0F0F0F0Fu;
+        return (gint) ((i * 0x01010101u) >> 24);
+    }
+
+    /**
+     * Clear the bits of the movemask that belong to the given element.
+     */
+    template<class T>
+    static gint clearElement(gint mask, gint index)
+    {
+        return mask & ~CORE_CAST(gint, ((1u << sizeof(T)) - 1) << (index * sizeof(T)));
+    }
+
+    template<class T>
+    static __m128i broadcastSSE2(gint c)
+    {
+        return sizeof(T) == 1 ? _mm_set1_epi8((gbyte) c) : _mm_set1_epi16((gshort) c);
+    }
+
+    template<class T>
+    static __m128i equalsSSE2(__m128i a, __m128i b)
+    {
+        return sizeof(T) == 1 ? _mm_cmpeq_epi8(a, b) : _mm_cmpeq_epi16(a, b);
+    }
+
+    template<class T>
+    CORE_TARGET_AVX2
+    static __m256i broadcastAVX2(gint c)
+    {
+        return sizeof(T) == 1 ? _mm256_set1_epi8((gbyte) c) : _mm256_set1_epi16((gshort) c);
+    }
+
+    template<class T>
+    CORE_TARGET_AVX2
+    static __m256i equalsAVX2(__m256i a, __m256i b)
+    {
+        return sizeof(T) == 1 ? _mm256_cmpeq_epi8(a, b) : _mm256_cmpeq_epi16(a, b);
+    }
+
+    /**
+     * Search the given string by blocks of characters starting at the given index,
+     * using the first and last characters of the string as filter. Return the
+     * index of the occurrence found, otherwise -1 and the index of the first
+     * position not yet checked is stored in the given variable.
+     */
+    template<class T, class N>
+    static gint searchSSE2(T const *src, gint count, N const *str, gint length, gint &from)
+    {
+        CORE_FAST gint BLOCK = 16 / sizeof(T);
+        __m128i const first = broadcastSSE2< T >(charOf(str[0]));
+        __m128i const last = broadcastSSE2< T >(charOf(str[length - 1]));
+        glong work = 0;
+        gint i = from;
+        for (; i + BLOCK - 1 <= count - length && !tooMuchWork(work, i - from); i += BLOCK) {
+            __m128i block1 = _mm_loadu_si128(CORE_CAST(__m128i const *, src + i));
+            __m128i block2 = _mm_loadu_si128(CORE_CAST(__m128i const *, src + i + length - 1));
+            gint mask = _mm_movemask_epi8(_mm_and_si128(equalsSSE2< T >(block1, first),
+                                                        equalsSSE2< T >(block2, last)));
+            while (mask != 0) {
+                gint k = lowestBit(mask) / (gint) sizeof(T);
+                if (matches(src, i + k, str, length, work)) {
+                    return i + k;
+                }
+                mask = clearElement< T >(mask, k);
+            }
+        }
+        from = i;
+        return -1;
+    }
+
+    template<class T, class N>
+    CORE_TARGET_AVX2
+    static gint searchAVX2(T const *src, gint count, N const *str, gint length, gint &from)
+    {
+        CORE_FAST gint BLOCK = 32 / sizeof(T);
+        __m256i const first = broadcastAVX2< T >(charOf(str[0]));
+        __m256i const last = broadcastAVX2< T >(charOf(str[length - 1]));
+        glong work = 0;
+        gint i = from;
+        for (; i + BLOCK - 1 <= count - length && !tooMuchWork(work, i - from); i += BLOCK) {
+            __m256i block1 = _mm256_loadu_si256(CORE_CAST(__m256i const *, src + i));
+            __m256i block2 = _mm256_loadu_si256(CORE_CAST(__m256i const *, src + i + length - 1));
+            gint mask = _mm256_movemask_epi8(_mm256_and_si256(equalsAVX2< T >(block1, first),
+                                                              equalsAVX2< T >(block2, last)));
+            while (mask != 0) {
+                gint k = lowestBit(mask) / (gint) sizeof(T);
+                if (matches(src, i + k, str, length, work)) {
+                    return i + k;
+                }
+                mask = clearElement< T >(mask, k);
+            }
+        }
+        from = i;
+        return -1;
+    }
+
+    /**
+     * Same as searchSSE2 but from the end: the positions before the given
+     * index are checked, and when the search is not completed the number of
+     * positions not yet checked is stored in the given variable.
+     */
+    template<class T, class N>
+    static gint searchBackwardSSE2(T const *src, N const *str, gint length, gint &end)
+    {
+        CORE_FAST gint BLOCK = 16 / sizeof(T);
+        __m128i const first = broadcastSSE2< T >(charOf(str[0]));
+        __m128i const last = broadcastSSE2< T >(charOf(str[length - 1]));
+        glong work = 0;
+        gint i = end - BLOCK;
+        for (; i >= 0 && !tooMuchWork(work, end - i - BLOCK); i -= BLOCK) {
+            __m128i block1 = _mm_loadu_si128(CORE_CAST(__m128i const *, src + i));
+            __m128i block2 = _mm_loadu_si128(CORE_CAST(__m128i const *, src + i + length - 1));
+            gint mask = _mm_movemask_epi8(_mm_and_si128(equalsSSE2< T >(block1, first),
+                                                        equalsSSE2< T >(block2, last)));
+            while (mask != 0) {
+                gint k = highestBit(mask) / (gint) sizeof(T);
+                if (matches(src, i + k, str, length, work)) {
+                    return i + k;
+                }
+                mask = clearElement< T >(mask, k);
+            }
+        }
+        end = i + BLOCK;
+        return -1;
+    }
+
+    template<class T, class N>
+    CORE_TARGET_AVX2
+    static gint searchBackwardAVX2(T const *src, N const *str, gint length, gint &end)
+    {
+        CORE_FAST gint BLOCK = 32 / sizeof(T);
+        __m256i const first = broadcastAVX2< T >(charOf(str[0]));
+        __m256i const last = broadcastAVX2< T >(charOf(str[length - 1]));
+        glong work = 0;
+        gint i = end - BLOCK;
+        for (; i >= 0 && !tooMuchWork(work, end - i - BLOCK); i -= BLOCK) {
+            __m256i block1 = _mm256_loadu_si256(CORE_CAST(__m256i const *, src + i));
+            __m256i block2 = _mm256_loadu_si256(CORE_CAST(__m256i const *, src + i + length - 1));
+            gint mask = _mm256_movemask_epi8(_mm256_and_si256(equalsAVX2< T >(block1, first),
+                                                              equalsAVX2< T >(block2, last)));
+            while (mask != 0) {
+                gint k = highestBit(mask) / (gint) sizeof(T);
+                if (matches(src, i + k, str, length, work)) {
+                    return i + k;
+                }
+                mask = clearElement< T >(mask, k);
+            }
+        }
+        end = i + BLOCK;
+        return -1;
+    }
+
+    /**
+     * Search the given character by blocks of characters starting at the given
+     * index. Return the index of the character found, otherwise -1 and the index
+     * of the first character not yet checked is stored in the given variable.
+     */
+    template<class T>
+    static gint findSSE2(T const *src, gint count, gint ch, gint &from)
+    {
+        CORE_FAST gint BLOCK = 16 / sizeof(T);
+        __m128i const c = broadcastSSE2< T >(ch);
+        gint i = from;
+        for (; i + BLOCK <= count; i += BLOCK) {
+            __m128i block = _mm_loadu_si128(CORE_CAST(__m128i const *, src + i));
+            gint mask = _mm_movemask_epi8(equalsSSE2< T >(block, c));
+            if (mask != 0) {
+                return i + lowestBit(mask) / (gint) sizeof(T);
+            }
+        }
+        from = i;
+        return -1;
+    }
+
+    template<class T>
+    CORE_TARGET_AVX2
+    static gint findAVX2(T const *src, gint count, gint ch, gint &from)
+    {
+        CORE_FAST gint BLOCK = 32 / sizeof(T);
+        __m256i const c = broadcastAVX2< T >(ch);
+        gint i = from;
+        for (; i + BLOCK <= count; i += BLOCK) {
+            __m256i block = _mm256_loadu_si256(CORE_CAST(__m256i const *, src + i));
+            gint mask = _mm256_movemask_epi8(equalsAVX2< T >(block, c));
+            if (mask != 0) {
+                return i + lowestBit(mask) / (gint) sizeof(T);
+            }
+        }
+        from = i;
+        return -1;
+    }
+
+    /**
+     * Same as findSSE2 but from the end: the characters before the given index
+     * are checked, and when the character is not found the number of characters
+     * not yet checked is stored in the given variable.
+     */
+    template<class T>
+    static gint findBackwardSSE2(T const *src, gint ch, gint &end)
+    {
+        CORE_FAST gint BLOCK = 16 / sizeof(T);
+        __m128i const c = broadcastSSE2< T >(ch);
+        gint i = end - BLOCK;
+        for (; i >= 0; i -= BLOCK) {
+            __m128i block = _mm_loadu_si128(CORE_CAST(__m128i const *, src + i));
+            gint mask = _mm_movemask_epi8(equalsSSE2< T >(block, c));
+            if (mask != 0) {
+                return i + highestBit(mask) / (gint) sizeof(T);
+            }
+        }
+        end = i + BLOCK;
+        return -1;
+    }
+
+    template<class T>
+    CORE_TARGET_AVX2
+    static gint findBackwardAVX2(T const *src, gint ch, gint &end)
+    {
+        CORE_FAST gint BLOCK = 32 / sizeof(T);
+        __m256i const c = broadcastAVX2< T >(ch);
+        gint i = end - BLOCK;
+        for (; i >= 0; i -= BLOCK) {
+            __m256i block = _mm256_loadu_si256(CORE_CAST(__m256i const *, src + i));
+            gint mask = _mm256_movemask_epi8(equalsAVX2< T >(block, c));
+            if (mask != 0) {
+                return i + highestBit(mask) / (gint) sizeof(T);
+            }
+        }
+        end = i + BLOCK;
+        return -1;
+    }
+
+    /**
+     * Search any of the given characters by blocks of characters.
+     *
+     * @see findSSE2
+     */
+    template<class T>
+    static gint findAnySSE2(T const *src, gint count, gint const *set, gint length, gint &from)
+    {
+        CORE_FAST gint BLOCK = 16 / sizeof(T);
+        __m128i chars[8];
+        for (int j = 0; j < length; ++j) {
+            chars[j] = broadcastSSE2< T >(set[j]);
+        }
+        gint i = from;
+        for (; i + BLOCK <= count; i += BLOCK) {
+            __m128i block = _mm_loadu_si128(CORE_CAST(__m128i const *, src + i));
+            __m128i found = equalsSSE2< T >(block, chars[0]);
+            for (int j = 1; j < length; ++j) {
+                found = _mm_or_si128(found, equalsSSE2< T >(block, chars[j]));
+            }
+            gint mask = _mm_movemask_epi8(found);
+            if (mask != 0) {
+                return i + lowestBit(mask) / (gint) sizeof(T);
+            }
+        }
+        from = i;
+        return -1;
+    }
+
+    template<class T>
+    CORE_TARGET_AVX2
+    static gint findAnyAVX2(T const *src, gint count, gint const *set, gint length, gint &from)
+    {
+        CORE_FAST gint BLOCK = 32 / sizeof(T);
+        __m256i chars[8];
+        for (int j = 0; j < length; ++j) {
+            chars[j] = broadcastAVX2< T >(set[j]);
+        }
+        gint i = from;
+        for (; i + BLOCK <= count; i += BLOCK) {
+            __m256i block = _mm256_loadu_si256(CORE_CAST(__m256i const *, src + i));
+            __m256i found = equalsAVX2< T >(block, chars[0]);
+            for (int j = 1; j < length; ++j) {
+                found = _mm256_or_si256(found, equalsAVX2< T >(block, chars[j]));
+            }
+            gint mask = _mm256_movemask_epi8(found);
+            if (mask != 0) {
+                return i + lowestBit(mask) / (gint) sizeof(T);
+            }
+        }
+        from = i;
+        return -1;
+    }
+
+    /**
+     * Compare the given characters by blocks of characters. Return the index
+     * of the first different character found, otherwise -1 and the index of the
+     * first character not yet compared is stored in the given variable.
+     */
+    template<class T>
+    static gint mismatchSSE2(T const *src1, T const *src2, gint count, gint &from)
+    {
+        CORE_FAST gint BLOCK = 16 / sizeof(T);
+        gint i = from;
+        for (; i + BLOCK <= count; i += BLOCK) {
+            __m128i block1 = _mm_loadu_si128(CORE_CAST(__m128i const *, src1 + i));
+            __m128i block2 = _mm_loadu_si128(CORE_CAST(__m128i const *, src2 + i));
+            gint mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block1, block2)) ^ 0xffff;
+            if (mask != 0) {
+                return i + lowestBit(mask) / (gint) sizeof(T);
+            }
+        }
+        from = i;
+        return -1;
+    }
+
+    template<class T>
+    CORE_TARGET_AVX2
+    static gint mismatchAVX2(T const *src1, T const *src2, gint count, gint &from)
+    {
+        CORE_FAST gint BLOCK = 32 / sizeof(T);
+        gint i = from;
+        for (; i + BLOCK <= count; i += BLOCK) {
+            __m256i block1 = _mm256_loadu_si256(CORE_CAST(__m256i const *, src1 + i));
+            __m256i block2 = _mm256_loadu_si256(CORE_CAST(__m256i const *, src2 + i));
+            gint mask = ~_mm256_movemask_epi8(_mm256_cmpeq_epi8(block1, block2));
+            if (mask != 0) {
+                return i + lowestBit(mask) / (gint) sizeof(T);
+            }
+        }
+        from = i;
+        return -1;
+    }
+
+    /**
+     * Compare utf16 characters to latin1 characters, the latin1 characters
+     * are widened in the registers.
+     *
+     * @see mismatchSSE2
+     */
+    static gint mismatchSSE2(gchar const *src1, gbyte const *src2, gint count, gint &from)
+    {
+        __m128i const zero = _mm_setzero_si128();
+        gint i = from;
+        for (; i + 16 <= count; i += 16) {
+            __m128i bytes = _mm_loadu_si128(CORE_CAST(__m128i const *, src2 + i));
+            __m128i chars1 = _mm_loadu_si128(CORE_CAST(__m128i const *, src1 + i));
+            __m128i chars2 = _mm_loadu_si128(CORE_CAST(__m128i const *, src1 + i + 8));
+            gint mask1 = _mm_movemask_epi8(_mm_cmpeq_epi16(chars1, _mm_unpacklo_epi8(bytes, zero)));
+            gint mask2 = _mm_movemask_epi8(_mm_cmpeq_epi16(chars2, _mm_unpackhi_epi8(bytes, zero)));
+            gint mask = (mask1 | (mask2 << 16)) ^ CORE_CAST(gint, 0xffffffffu);
+            if (mask != 0) {
+                return i + (lowestBit(mask) >> 1);
+            }
+        }
+        from = i;
+        return -1;
+    }
+
+    CORE_TARGET_AVX2
+    static gint mismatchAVX2(gchar const *src1, gbyte const *src2, gint count, gint &from)
+    {
+        gint i = from;
+        for (; i + 16 <= count; i += 16) {
+            __m256i chars2 = _mm256_cvtepu8_epi16(_mm_loadu_si128(CORE_CAST(__m128i const *, src2 + i)));
+            __m256i chars1 = _mm256_loadu_si256(CORE_CAST(__m256i const *, src1 + i));
+            gint mask = ~_mm256_movemask_epi8(_mm256_cmpeq_epi16(chars1, chars2));
+            if (mask != 0) {
+                return i + (lowestBit(mask) >> 1);
+            }
+        }
+        from = i;
+        return -1;
+    }
+
+#endif
+
+    template<class T, class U>
+    static gint mismatchOf(T const *src1, U const *src2, gint count)
+    {
+        gint i = 0;
+#if CORE_STRING_KERNELS_X86
+        gint index = StringKernels::features() == StringKernels::AVX2
+                     ? mismatchAVX2(src1, src2, count, i)
+                     : mismatchSSE2(src1, src2, count, i);
+        if (index >= 0) {
+            return index;
+        }
+#endif
+        for (; i < count; ++i) {
+            if (charOf(src1[i]) != charOf(src2[i])) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    /**
+     * The powers of 31 modulo 2^32 in descending order, from 31^32 to 31^0.
+     */
+    static misc::__uint32_t const POWERS_OF_31[33] = {
+            0x7DD7BC01U, 0x88303FDFU, 0x14E8C841U, 0x00ACAB9FU,
+            0x294FE481U, 0xF0D1075FU, 0x395110C1U, 0x01D9531FU,
+            0x84304D01U, 0xFC018EDFU, 0x4A319941U, 0x8685BA9FU,
+            0x0C98F581U, 0xE7A1D65FU, 0xCDAA61C1U, 0xC491E21FU,
+            0x50A9DE01U, 0xE191DDDFU, 0x59DB6A41U, 0xE1DDC99FU,
+            0xEE830681U, 0x07B1A55FU, 0x94E4B2C1U, 0xF449711FU,
+            0x94446F01U, 0x67E12CDFU, 0x34E63B41U, 0x01B4D89FU,
+            0x000E1781U, 0x0000745FU, 0x000003C1U, 0x0000001FU,
+            0x00000001U
+    };
+
+    static misc::__uint32_t powerOf31(gint exponent)
+    {
+        return POWERS_OF_31[32 - exponent];
+    }
+
+#if CORE_STRING_KERNELS_X86
+
+    CORE_TARGET_AVX2
+    static __m256i widenAVX2(gbyte const *src)
+    {
+        return _mm256_cvtepu8_epi32(_mm_loadl_epi64(CORE_CAST(__m128i const *, src)));
+    }
+
+    CORE_TARGET_AVX2
+    static __m256i widenAVX2(gchar const *src)
+    {
+        return _mm256_cvtepu16_epi32(_mm_loadu_si128(CORE_CAST(__m128i const *, src)));
+    }
+
+    /**
+     * Multiplies the four 32 bits lanes of the given vectors modulo 2^32 (SSE2 has
+     * no such instruction, the even and the odd lanes are multiplied in 64 bits).
+     */
+    static __m128i mulloSSE2(__m128i a, __m128i b)
+    {
+        __m128i even = _mm_mul_epu32(a, b);
+        __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+        return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, 0x08), _mm_shuffle_epi32(odd, 0x08));
+    }
+
+    /**
+     * Loads 16 characters as four vectors of four 32 bits lanes.
+     */
+    static void widenSSE2(gbyte const *src, __m128i chars[4])
+    {
+        __m128i const zero = _mm_setzero_si128();
+        __m128i bytes = _mm_loadu_si128(CORE_CAST(__m128i const *, src));
+        __m128i low = _mm_unpacklo_epi8(bytes, zero);
+        __m128i high = _mm_unpackhi_epi8(bytes, zero);
+        chars[0] = _mm_unpacklo_epi16(low, zero);
+        chars[1] = _mm_unpackhi_epi16(low, zero);
+        chars[2] = _mm_unpacklo_epi16(high, zero);
+        chars[3] = _mm_unpackhi_epi16(high, zero);
+    }
+
+    static void widenSSE2(gchar const *src, __m128i chars[4])
+    {
+        __m128i const zero = _mm_setzero_si128();
+        __m128i low = _mm_loadu_si128(CORE_CAST(__m128i const *, src));
+        __m128i high = _mm_loadu_si128(CORE_CAST(__m128i const *, src + 8));
+        chars[0] = _mm_unpacklo_epi16(low, zero);
+        chars[1] = _mm_unpackhi_epi16(low, zero);
+        chars[2] = _mm_unpacklo_epi16(high, zero);
+        chars[3] = _mm_unpackhi_epi16(high, zero);
+    }
+
+    /**
+     * Hash the given characters by blocks of 16 characters spread over four
+     * accumulators of four lanes, each lane is multiplied by 31^16 at each
+     * block. The lanes are weighted by their powers of 31 at the end, as
+     * @c hashAVX2 does.
+     */
+    template<class T>
+    static misc::__uint32_t hashSSE2(T const *src, gint count, misc::__uint32_t hash, gint &from)
+    {
+        gint i = from;
+        if (count - i < 16) {
+            return hash;
+        }
+        __m128i const step = _mm_set1_epi32(CORE_CAST(gint, powerOf31(16)));
+        __m128i acc0 = _mm_setzero_si128();
+        __m128i acc1 = _mm_setzero_si128();
+        __m128i acc2 = _mm_setzero_si128();
+        __m128i acc3 = _mm_setzero_si128();
+        __m128i chars[4];
+        for (; i + 16 <= count; i += 16) {
+            widenSSE2(src + i, chars);
+            acc0 = _mm_add_epi32(mulloSSE2(acc0, step), chars[0]);
+            acc1 = _mm_add_epi32(mulloSSE2(acc1, step), chars[1]);
+            acc2 = _mm_add_epi32(mulloSSE2(acc2, step), chars[2]);
+            acc3 = _mm_add_epi32(mulloSSE2(acc3, step), chars[3]);
+            hash *= powerOf31(16);
+        }
+        // The lane j of the accumulator k holds the characters at 4k+j of each block
+        __m128i const *weights = CORE_CAST(__m128i const *, POWERS_OF_31 + 17);
+        __m128i lanes = _mm_add_epi32(
+                _mm_add_epi32(mulloSSE2(acc0, _mm_loadu_si128(weights)),
+                              mulloSSE2(acc1, _mm_loadu_si128(weights + 1))),
+                _mm_add_epi32(mulloSSE2(acc2, _mm_loadu_si128(weights + 2)),
+                              mulloSSE2(acc3, _mm_loadu_si128(weights + 3))));
+        lanes = _mm_add_epi32(lanes, _mm_shuffle_epi32(lanes, 0x4E));
+        lanes = _mm_add_epi32(lanes, _mm_shuffle_epi32(lanes, 0xB1));
+        from = i;
+        return hash + CORE_CAST(misc::__uint32_t, _mm_cvtsi128_si32(lanes));
+    }
+
+    /**
+     * Hash the given characters by blocks of 32 characters spread over four
+     * accumulators of eight lanes, each lane is multiplied by 31^32 at each
+     * block. The lanes are weighted by their powers of 31 at the end, which
+     * gives exactly the value of the serial computation. The index of the first
+     * character not yet hashed is stored in the given variable.
+     */
+    template<class T>
+    CORE_TARGET_AVX2
+    static misc::__uint32_t hashAVX2(T const *src, gint count, misc::__uint32_t hash, gint &from)
+    {
+        gint i = from;
+        if (count - i < 32) {
+            return hash;
+        }
+        __m256i const step = _mm256_set1_epi32(CORE_CAST(gint, powerOf31(32)));
+        __m256i acc0 = _mm256_setzero_si256();
+        __m256i acc1 = _mm256_setzero_si256();
+        __m256i acc2 = _mm256_setzero_si256();
+        __m256i acc3 = _mm256_setzero_si256();
+        for (; i + 32 <= count; i += 32) {
+            acc0 = _mm256_add_epi32(_mm256_mullo_epi32(acc0, step), widenAVX2(src + i));
+            acc1 = _mm256_add_epi32(_mm256_mullo_epi32(acc1, step), widenAVX2(src + i + 8));
+            acc2 = _mm256_add_epi32(_mm256_mullo_epi32(acc2, step), widenAVX2(src + i + 16));
+            acc3 = _mm256_add_epi32(_mm256_mullo_epi32(acc3, step), widenAVX2(src + i + 24));
+            hash *= powerOf31(32);
+        }
+        // The lane j of the accumulator k holds the characters at 8k+j of each block
+        __m256i const *weights = CORE_CAST(__m256i const *, POWERS_OF_31 + 1);
+        __m256i sum = _mm256_add_epi32(
+                _mm256_add_epi32(_mm256_mullo_epi32(acc0, _mm256_loadu_si256(weights)),
+                                 _mm256_mullo_epi32(acc1, _mm256_loadu_si256(weights + 1))),
+                _mm256_add_epi32(_mm256_mullo_epi32(acc2, _mm256_loadu_si256(weights + 2)),
+                                 _mm256_mullo_epi32(acc3, _mm256_loadu_si256(weights + 3))));
+        __m128i lanes = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+        lanes = _mm_add_epi32(lanes, _mm_shuffle_epi32(lanes, 0x4E));
+        lanes = _mm_add_epi32(lanes, _mm_shuffle_epi32(lanes, 0xB1));
+        from = i;
+        return hash + CORE_CAST(misc::__uint32_t, _mm_cvtsi128_si32(lanes));
+    }
+
+#endif
+
+    template<class T>
+    static gint hashOf(T const *src, gint count, gint hash)
+    {
+        misc::__uint32_t h = CORE_CAST(misc::__uint32_t, hash);
+        gint i = 0;
+#if CORE_STRING_KERNELS_X86
+        StringKernels::Features features = StringKernels::features();
+        if (features == StringKernels::AVX2) {
+            h = hashAVX2(src, count, h, i);
+        }
+        else if (features == StringKernels::SSE2) {
+            h = hashSSE2(src, count, h, i);
+        }
+#endif
+        // Four characters by step, only the multiplication of the hash is serial
+        for (; i + 4 <= count; i += 4) {
+            h = h * powerOf31(4)
+                + CORE_CAST(misc::__uint32_t, charOf(src[i])) * powerOf31(3)
+                + CORE_CAST(misc::__uint32_t, charOf(src[i + 1])) * powerOf31(2)
+                + CORE_CAST(misc::__uint32_t, charOf(src[i + 2])) * 31U
+                + CORE_CAST(misc::__uint32_t, charOf(src[i + 3]));
+        }
+        for (; i < count; ++i) {
+            h = h * 31U + CORE_CAST(misc::__uint32_t, charOf(src[i]));
+        }
+        return CORE_CAST(gint, h);
+    }
+
+    /**
+     * Tests if the given character is a latin1 letter of the case given by its
+     * first letter: 'A' for A-Z and 0xC0-0xDE without 0xD7, 'a' for a-z and
+     * 0xE0-0xFE without 0xF7. The case of these letters is switched by the bit 0x20.
+     */
+    static gbool isLetter(gint ch, gint first)
+    {
+        return (ch >= first && ch <= first + 25) || (ch >= first + 0x7F && ch <= first + 0x9D && ch != first + 0x96);
+    }
+
+    /**
+     * Tests if the case mapping of the given character is not a latin1 letter
+     * switch: the characters above 0xFF, and 0xB5 and 0xFF for the upper case.
+     */
+    static gbool isCaseStop(gint ch, gbool upper)
+    {
+        return ch > 0xFF || (upper && (ch == 0xB5 || ch == 0xFF));
+    }
+
+    static gint foldCase(gint ch)
+    {
+        return isLetter(ch, 'A') ? ch | 0x20 : ch;
+    }
+
+#if CORE_STRING_KERNELS_X86
+
+    template<class T>
+    static __m128i inRangeSSE2(__m128i block, gint low, gint high)
+    {
+        // unsigned (block - low) <= (high - low)
+        __m128i offset = sizeof(T) == 1
+                         ? _mm_sub_epi8(block, broadcastSSE2< T >(low))
+                         : _mm_sub_epi16(block, broadcastSSE2< T >(low));
+        __m128i excess = sizeof(T) == 1
+                         ? _mm_subs_epu8(offset, broadcastSSE2< T >(high - low))
+                         : _mm_subs_epu16(offset, broadcastSSE2< T >(high - low));
+        return equalsSSE2< T >(excess, _mm_setzero_si128());
+    }
+
+    /**
+     * @see isLetter
+     */
+    template<class T>
+    static __m128i lettersSSE2(__m128i block, gint first)
+    {
+        __m128i ascii = inRangeSSE2< T >(block, first, first + 25);
+        __m128i latin1 = _mm_andnot_si128(equalsSSE2< T >(block, broadcastSSE2< T >(first + 0x96)),
+                                          inRangeSSE2< T >(block, first + 0x7F, first + 0x9D));
+        return _mm_or_si128(ascii, latin1);
+    }
+
+    /**
+     * @see isCaseStop
+     */
+    template<class T>
+    static __m128i caseStopsSSE2(__m128i block, gbool upper)
+    {
+        __m128i stops = _mm_setzero_si128();
+        if (sizeof(T) == 2) {
+            __m128i latin1 = equalsSSE2< T >(_mm_subs_epu16(block, broadcastSSE2< T >(0xFF)), stops);
+            stops = _mm_xor_si128(latin1, _mm_cmpeq_epi8(stops, stops));
+        }
+        if (upper) {
+            stops = _mm_or_si128(stops, _mm_or_si128(equalsSSE2< T >(block, broadcastSSE2< T >(0xB5)),
+                                                     equalsSSE2< T >(block, broadcastSSE2< T >(0xFF))));
+        }
+        return stops;
+    }
+
+    template<class T>
+    static __m128i foldCaseSSE2(__m128i block)
+    {
+        return _mm_or_si128(block, _mm_and_si128(lettersSSE2< T >(block, 'A'), broadcastSSE2< T >(0x20)));
+    }
+
+    /**
+     * Switch the case of the letters of the given characters by blocks of
+     * characters until the first block containing a character whose case
+     * mapping is not a letter switch. The index of the first character not yet
+     * converted is stored in the given variable.
+     */
+    template<class T>
+    static void convertCaseSSE2(T const *src, T *dst, gint count, gbool upper, gint &from)
+    {
+        CORE_FAST gint BLOCK = 16 / sizeof(T);
+        __m128i const bit = broadcastSSE2< T >(0x20);
+        gint const first = upper ? 'a' : 'A';
+        gint i = from;
+        for (; i + BLOCK <= count; i += BLOCK) {
+            __m128i block = _mm_loadu_si128(CORE_CAST(__m128i const *, src + i));
+            if (_mm_movemask_epi8(caseStopsSSE2< T >(block, upper)) != 0) {
+                break;
+            }
+            __m128i letters = lettersSSE2< T >(block, first);
+            _mm_storeu_si128(CORE_CAST(__m128i *, dst + i), _mm_xor_si128(block, _mm_and_si128(letters, bit)));
+        }
+        from = i;
+    }
+
+    /**
+     * Search the first character changed by the case mapping by blocks of characters.
+     *
+     * @see findSSE2
+     */
+    template<class T>
+    static gint findCasedSSE2(T const *src, gint count, gbool upper, gint &from)
+    {
+        CORE_FAST gint BLOCK = 16 / sizeof(T);
+        gint const first = upper ? 'a' : 'A';
+        gint i = from;
+        for (; i + BLOCK <= count; i += BLOCK) {
+            __m128i block = _mm_loadu_si128(CORE_CAST(__m128i const *, src + i));
+            gint mask = _mm_movemask_epi8(_mm_or_si128(lettersSSE2< T >(block, first),
+                                                       caseStopsSSE2< T >(block, upper)));
+            if (mask != 0) {
+                return i + lowestBit(mask) / (gint) sizeof(T);
+            }
+        }
+        from = i;
+        return -1;
+    }
+
+    /**
+     * Compare the given characters folded to lower case by blocks of characters.
+     *
+     * @see mismatchSSE2
+     */
+    template<class T>
+    static gint mismatchIgnoreCaseSSE2(T const *src1, T const *src2, gint count, gint &from)
+    {
+        CORE_FAST gint BLOCK = 16 / sizeof(T);
+        gint i = from;
+        for (; i + BLOCK <= count; i += BLOCK) {
+            __m128i block1 = foldCaseSSE2< T >(_mm_loadu_si128(CORE_CAST(__m128i const *, src1 + i)));
+            __m128i block2 = foldCaseSSE2< T >(_mm_loadu_si128(CORE_CAST(__m128i const *, src2 + i)));
+            gint mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block1, block2)) ^ 0xffff;
+            if (mask != 0) {
+                return i + lowestBit(mask) / (gint) sizeof(T);
+            }
+        }
+        from = i;
+        return -1;
+    }
+
+    static gint mismatchIgnoreCaseSSE2(gchar const *src1, gbyte const *src2, gint count, gint &from)
+    {
+        __m128i const zero = _mm_setzero_si128();
+        gint i = from;
+        for (; i + 16 <= count; i += 16) {
+            __m128i bytes = _mm_loadu_si128(CORE_CAST(__m128i const *, src2 + i));
+            __m128i chars1 = foldCaseSSE2< gchar >(_mm_loadu_si128(CORE_CAST(__m128i const *, src1 + i)));
+            __m128i chars2 = foldCaseSSE2< gchar >(_mm_loadu_si128(CORE_CAST(__m128i const *, src1 + i + 8)));
+            gint mask1 = _mm_movemask_epi8(
+                    _mm_cmpeq_epi16(chars1, foldCaseSSE2< gchar >(_mm_unpacklo_epi8(bytes, zero))));
+            gint mask2 = _mm_movemask_epi8(
+                    _mm_cmpeq_epi16(chars2, foldCaseSSE2< gchar >(_mm_unpackhi_epi8(bytes, zero))));
+            gint mask = (mask1 | (mask2 << 16)) ^ CORE_CAST(gint, 0xffffffffu);
+            if (mask != 0) {
+                return i + (lowestBit(mask) >> 1);
+            }
+        }
+        from = i;
+        return -1;
+    }
+
+    template<class T>
+    CORE_TARGET_AVX2
+    static __m256i inRangeAVX2(__m256i block, gint low, gint high)
+    {
+        __m256i offset = sizeof(T) == 1
+                         ? _mm256_sub_epi8(block, broadcastAVX2< T >(low))
+                         : _mm256_sub_epi16(block, broadcastAVX2< T >(low));
+        __m256i excess = sizeof(T) == 1
+                         ? _mm256_subs_epu8(offset, broadcastAVX2< T >(high - low))
+                         : _mm256_subs_epu16(offset, broadcastAVX2< T >(high - low));
+        return equalsAVX2< T >(excess, _mm256_setzero_si256());
+    }
+
+    template<class T>
+    CORE_TARGET_AVX2
+    static __m256i lettersAVX2(__m256i block, gint first)
+    {
+        __m256i ascii = inRangeAVX2< T >(block, first, first + 25);
+        __m256i latin1 = _mm256_andnot_si256(equalsAVX2< T >(block, broadcastAVX2< T >(first + 0x96)),
+                                             inRangeAVX2< T >(block, first + 0x7F, first + 0x9D));
+        return _mm256_or_si256(ascii, latin1);
+    }
+
+    template<class T>
+    CORE_TARGET_AVX2
+    static __m256i caseStopsAVX2(__m256i block, gbool upper)
+    {
+        __m256i stops = _mm256_setzero_si256();
+        if (sizeof(T) == 2) {
+            __m256i latin1 = equalsAVX2< T >(_mm256_subs_epu16(block, broadcastAVX2< T >(0xFF)), stops);
+            stops = _mm256_xor_si256(latin1, _mm256_cmpeq_epi8(stops, stops));
+        }
+        if (upper) {
+            stops = _mm256_or_si256(stops, _mm256_or_si256(equalsAVX2< T >(block, broadcastAVX2< T >(0xB5)),
+                                                           equalsAVX2< T >(block, broadcastAVX2< T >(0xFF))));
+        }
+        return stops;
+    }
+
+    template<class T>
+    CORE_TARGET_AVX2
+    static __m256i foldCaseAVX2(__m256i block)
+    {
+        return _mm256_or_si256(block, _mm256_and_si256(lettersAVX2< T >(block, 'A'), broadcastAVX2< T >(0x20)));
+    }
+
+    template<class T>
+    CORE_TARGET_AVX2
+    static void convertCaseAVX2(T const *src, T *dst, gint count, gbool upper, gint &from)
+    {
+        CORE_FAST gint BLOCK = 32 / sizeof(T);
+        __m256i const bit = broadcastAVX2< T >(0x20);
+        gint const first = upper ? 'a' : 'A';
+        gint i = from;
+        for (; i + BLOCK <= count; i += BLOCK) {
+            __m256i block = _mm256_loadu_si256(CORE_CAST(__m256i const *, src + i));
+            if (_mm256_movemask_epi8(caseStopsAVX2< T >(block, upper)) != 0) {
+                break;
+            }
+            __m256i letters = lettersAVX2< T >(block, first);
+            _mm256_storeu_si256(CORE_CAST(__m256i *, dst + i), _mm256_xor_si256(block, _mm256_and_si256(letters, bit)));
+        }
+        from = i;
+    }
+
+    template<class T>
+    CORE_TARGET_AVX2
+    static gint findCasedAVX2(T const *src, gint count, gbool upper, gint &from)
+    {
+        CORE_FAST gint BLOCK = 32 / sizeof(T);
+        gint const first = upper ? 'a' : 'A';
+        gint i = from;
+        for (; i + BLOCK <= count; i += BLOCK) {
+            __m256i block = _mm256_loadu_si256(CORE_CAST(__m256i const *, src + i));
+            gint mask = _mm256_movemask_epi8(_mm256_or_si256(lettersAVX2< T >(block, first),
+                                                             caseStopsAVX2< T >(block, upper)));
+            if (mask != 0) {
+                return i + lowestBit(mask) / (gint) sizeof(T);
+            }
+        }
+        from = i;
+        return -1;
+    }
+
+    template<class T>
+    CORE_TARGET_AVX2
+    static gint mismatchIgnoreCaseAVX2(T const *src1, T const *src2, gint count, gint &from)
+    {
+        CORE_FAST gint BLOCK = 32 / sizeof(T);
+        gint i = from;
+        for (; i + BLOCK <= count; i += BLOCK) {
+            __m256i block1 = foldCaseAVX2< T >(_mm256_loadu_si256(CORE_CAST(__m256i const *, src1 + i)));
+            __m256i block2 = foldCaseAVX2< T >(_mm256_loadu_si256(CORE_CAST(__m256i const *, src2 + i)));
+            gint mask = ~_mm256_movemask_epi8(_mm256_cmpeq_epi8(block1, block2));
+            if (mask != 0) {
+                return i + lowestBit(mask) / (gint) sizeof(T);
+            }
+        }
+        from = i;
+        return -1;
+    }
+
+    CORE_TARGET_AVX2
+    static gint mismatchIgnoreCaseAVX2(gchar const *src1, gbyte const *src2, gint count, gint &from)
+    {
+        gint i = from;
+        for (; i + 16 <= count; i += 16) {
+            __m256i chars2 = _mm256_cvtepu8_epi16(_mm_loadu_si128(CORE_CAST(__m128i const *, src2 + i)));
+            __m256i chars1 = _mm256_loadu_si256(CORE_CAST(__m256i const *, src1 + i));
+            gint mask = ~_mm256_movemask_epi8(_mm256_cmpeq_epi16(foldCaseAVX2< gchar >(chars1),
+                                                                 foldCaseAVX2< gchar >(chars2)));
+            if (mask != 0) {
+                return i + (lowestBit(mask) >> 1);
+            }
+        }
+        from = i;
+        return -1;
+    }
+
+#endif
+
+    template<class T>
+    static gint convertCase(T const *src, T *dst, gint count, gbool upper)
+    {
+        gint i = 0;
+#if CORE_STRING_KERNELS_X86
+        StringKernels::features() == StringKernels::AVX2
+        ? convertCaseAVX2(src, dst, count, upper, i)
+        : convertCaseSSE2(src, dst, count, upper, i);
+#endif
+        gint const first = upper ? 'a' : 'A';
+        for (; i < count; ++i) {
+            gint ch = charOf(src[i]);
+            if (isCaseStop(ch, upper)) {
+                break;
+            }
+            dst[i] = isLetter(ch, first) ? CORE_CAST(T, ch ^ 0x20) : src[i];
+        }
+        return i;
+    }
+
+    template<class T>
+    static gint findCased(T const *src, gint count, gbool upper)
+    {
+        gint i = 0;
+#if CORE_STRING_KERNELS_X86
+        gint index = StringKernels::features() == StringKernels::AVX2
+                     ? findCasedAVX2(src, count, upper, i)
+                     : findCasedSSE2(src, count, upper, i);
+        if (index >= 0) {
+            return index;
+        }
+#endif
+        gint const first = upper ? 'a' : 'A';
+        for (; i < count; ++i) {
+            gint ch = charOf(src[i]);
+            if (isLetter(ch, first) || isCaseStop(ch, upper)) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    template<class T, class U>
+    static gint mismatchIgnoreCaseOf(T const *src1, U const *src2, gint count)
+    {
+        gint i = 0;
+#if CORE_STRING_KERNELS_X86
+        gint index = StringKernels::features() == StringKernels::AVX2
+                     ? mismatchIgnoreCaseAVX2(src1, src2, count, i)
+                     : mismatchIgnoreCaseSSE2(src1, src2, count, i);
+        if (index >= 0) {
+            return index;
+        }
+#endif
+        for (; i < count; ++i) {
+            if (foldCase(charOf(src1[i])) != foldCase(charOf(src2[i]))) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    /**
+     * Tests if the given character is a space: a character up to ' ' for the
+     * trimming, otherwise an ascii whitespace (0x09-0x0D, 0x1C-0x20).
+     */
+    static gbool isSpace(gint ch, gbool whitespace)
+    {
+        return whitespace ? (ch >= 0x09 && ch <= 0x0D) || (ch >= 0x1C && ch <= 0x20) : ch <= 0x20;
+    }
+
+#if CORE_STRING_KERNELS_X86
+
+    /**
+     * @see isSpace
+     */
+    template<class T>
+    static __m128i spacesSSE2(__m128i block, gbool whitespace)
+    {
+        return whitespace
+               ? _mm_or_si128(inRangeSSE2< T >(block, 0x09, 0x0D), inRangeSSE2< T >(block, 0x1C, 0x20))
+               : inRangeSSE2< T >(block, 0x00, 0x20);
+    }
+
+    /**
+     * Search the first character that is not a space by blocks of characters.
+     *
+     * @see findSSE2
+     */
+    template<class T>
+    static gint findNonSpaceSSE2(T const *src, gint count, gbool whitespace, gint &from)
+    {
+        CORE_FAST gint BLOCK = 16 / sizeof(T);
+        gint i = from;
+        for (; i + BLOCK <= count; i += BLOCK) {
+            __m128i block = _mm_loadu_si128(CORE_CAST(__m128i const *, src + i));
+            gint mask = _mm_movemask_epi8(spacesSSE2< T >(block, whitespace)) ^ 0xffff;
+            if (mask != 0) {
+                return i + lowestBit(mask) / (gint) sizeof(T);
+            }
+        }
+        from = i;
+        return -1;
+    }
+
+    /**
+     * Search the last character that is not a space by blocks of characters.
+     *
+     * @see findBackwardSSE2
+     */
+    template<class T>
+    static gint findNonSpaceBackwardSSE2(T const *src, gbool whitespace, gint &end)
+    {
+        CORE_FAST gint BLOCK = 16 / sizeof(T);
+        gint i = end - BLOCK;
+        for (; i >= 0; i -= BLOCK) {
+            __m128i block = _mm_loadu_si128(CORE_CAST(__m128i const *, src + i));
+            gint mask = _mm_movemask_epi8(spacesSSE2< T >(block, whitespace)) ^ 0xffff;
+            if (mask != 0) {
+                return i + highestBit(mask) / (gint) sizeof(T);
+            }
+        }
+        end = i + BLOCK;
+        return -1;
+    }
+
+    template<class T>
+    CORE_TARGET_AVX2
+    static __m256i spacesAVX2(__m256i block, gbool whitespace)
+    {
+        return whitespace
+               ? _mm256_or_si256(inRangeAVX2< T >(block, 0x09, 0x0D), inRangeAVX2< T >(block, 0x1C, 0x20))
+               : inRangeAVX2< T >(block, 0x00, 0x20);
+    }
+
+    template<class T>
+    CORE_TARGET_AVX2
+    static gint findNonSpaceAVX2(T const *src, gint count, gbool whitespace, gint &from)
+    {
+        CORE_FAST gint BLOCK = 32 / sizeof(T);
+        gint i = from;
+        for (; i + BLOCK <= count; i += BLOCK) {
+            __m256i block = _mm256_loadu_si256(CORE_CAST(__m256i const *, src + i));
+            gint mask = ~_mm256_movemask_epi8(spacesAVX2< T >(block, whitespace));
+            if (mask != 0) {
+                return i + lowestBit(mask) / (gint) sizeof(T);
+            }
+        }
+        from = i;
+        return -1;
+    }
+
+    template<class T>
+    CORE_TARGET_AVX2
+    static gint findNonSpaceBackwardAVX2(T const *src, gbool whitespace, gint &end)
+    {
+        CORE_FAST gint BLOCK = 32 / sizeof(T);
+        gint i = end - BLOCK;
+        for (; i >= 0; i -= BLOCK) {
+            __m256i block = _mm256_loadu_si256(CORE_CAST(__m256i const *, src + i));
+            gint mask = ~_mm256_movemask_epi8(spacesAVX2< T >(block, whitespace));
+            if (mask != 0) {
+                return i + highestBit(mask) / (gint) sizeof(T);
+            }
+        }
+        end = i + BLOCK;
+        return -1;
+    }
+
+#endif
+
+    template<class T>
+    static gint findNonSpace(T const *src, gint count, gbool whitespace)
+    {
+        gint i = 0;
+#if CORE_STRING_KERNELS_X86
+        gint index = StringKernels::features() == StringKernels::AVX2
+                     ? findNonSpaceAVX2(src, count, whitespace, i)
+                     : findNonSpaceSSE2(src, count, whitespace, i);
+        if (index >= 0) {
+            return index;
+        }
+#endif
+        for (; i < count; ++i) {
+            if (!isSpace(charOf(src[i]), whitespace)) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    template<class T>
+    static gint findNonSpaceBackward(T const *src, gint count, gbool whitespace)
+    {
+        gint i = count;
+#if CORE_STRING_KERNELS_X86
+        gint index = StringKernels::features() == StringKernels::AVX2
+                     ? findNonSpaceBackwardAVX2(src, whitespace, i)
+                     : findNonSpaceBackwardSSE2(src, whitespace, i);
+        if (index >= 0) {
+            return index;
+        }
+#endif
+        for (; i > 0; --i) {
+            if (!isSpace(charOf(src[i - 1]), whitespace)) {
+                return i - 1;
+            }
+        }
+        return -1;
+    }
+
+    template<class T>
+    static gint find(T const *src, gint count, gint ch)
+    {
+        gint i = 0;
+#if CORE_STRING_KERNELS_X86
+        gint index = StringKernels::features() == StringKernels::AVX2
+                     ? findAVX2(src, count, ch, i)
+                     : findSSE2(src, count, ch, i);
+        if (index >= 0) {
+            return index;
+        }
+#endif
+        for (; i < count; ++i) {
+            if (charOf(src[i]) == ch) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    template<class T>
+    static gint findBackward(T const *src, gint count, gint ch)
+    {
+        gint i = count;
+#if CORE_STRING_KERNELS_X86
+        gint index = StringKernels::features() == StringKernels::AVX2
+                     ? findBackwardAVX2(src, ch, i)
+                     : findBackwardSSE2(src, ch, i);
+        if (index >= 0) {
+            return index;
+        }
+#endif
+        while (i > 0) {
+            i -= 1;
+            if (charOf(src[i]) == ch) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    /**
+     * The largest sets of characters searched by blocks.
+     */
+    static CORE_FAST gint SMALL_SET_LENGTH = 8;
+
+    template<class T, class S>
+    static gint findAny(T const *src, gint count, S const *set, gint length)
+    {
+        // The distinct characters of the set that may be found in the source
+        gint chars[SMALL_SET_LENGTH] = {};
+        gint n = 0;
+        gbool small = true;
+        for (int j = 0; j < length && small; ++j) {
+            gint c = charOf(set[j]);
+            gbool found = sizeof(T) == 1 && c > 0xff;
+            for (int k = 0; k < n && !found; ++k) {
+                found = chars[k] == c;
+            }
+            if (!found) {
+                small = n < SMALL_SET_LENGTH;
+                if (small) {
+                    chars[n++] = c;
+                }
+            }
+        }
+        if (n == 0) {
+            return -1;
+        }
+        gint i = 0;
+#if CORE_STRING_KERNELS_X86
+        if (small) {
+            gint index = StringKernels::features() == StringKernels::AVX2
+                         ? findAnyAVX2(src, count, chars, n, i)
+                         : findAnySSE2(src, count, chars, n, i);
+            if (index >= 0) {
+                return index;
+            }
+        }
+#endif
+        // The latin1 characters of the set, as a bitmap
+        glong latin1[4] = {};
+        for (int j = 0; j < length; ++j) {
+            gint c = charOf(set[j]);
+            if (c <= 0xff) {
+                latin1[c >> 6] |= 1LL << (c & 63);
+            }
+        }
+        for (; i < count; ++i) {
+            gint c = charOf(src[i]);
+            if (c <= 0xff) {
+                if ((latin1[c >> 6] & (1LL << (c & 63))) != 0) {
+                    return i;
+                }
+            }
+            else {
+                for (int j = 0; j < length; ++j) {
+                    if (charOf(set[j]) == c) {
+                        return i;
+                    }
+                }
+            }
+        }
+        return -1;
+    }
+
+    template<class T, class N>
+    static gint search(T const *src, gint count, N const *str, gint length)
+    {
+        if (length == 0) {
+            return 0;
+        }
+        if (length > count) {
+            return -1;
+        }
+        gint from = 0;
+#if CORE_STRING_KERNELS_X86
+        if (length <= SHORT_STRING_LENGTH) {
+            gint index = StringKernels::features() == StringKernels::AVX2
+                         ? searchAVX2(src, count, str, length, from)
+                         : searchSSE2(src, count, str, length, from);
+            if (index >= 0) {
+                return index;
+            }
+        }
+#endif
+        Forward< T > chars1 = {src};
+        Forward< N > chars2 = {str};
+        return twoWaySearch(chars1, count, chars2, length, from);
+    }
+
+    template<class T, class N>
+    static gint searchBackward(T const *src, gint count, N const *str, gint length)
+    {
+        if (length == 0) {
+            return count;
+        }
+        if (length > count) {
+            return -1;
+        }
+        // The number of positions where the string may start
+        gint end = count - length + 1;
+#if CORE_STRING_KERNELS_X86
+        if (length <= SHORT_STRING_LENGTH) {
+            gint index = StringKernels::features() == StringKernels::AVX2
+                         ? searchBackwardAVX2(src, str, length, end)
+                         : searchBackwardSSE2(src, str, length, end);
+            if (index >= 0) {
+                return index;
+            }
+        }
+#endif
+        // The reversed string is searched in the reversed characters
+        gint n = end + length - 1;
+        Backward< T > chars1 = {src, n};
+        Backward< N > chars2 = {str, length};
+        gint index = twoWaySearch(chars1, n, chars2, length, 0);
+        return index < 0 ? -1 : n - index - length;
+    }
+
+    gint StringKernels::indexOf(BYTES src, gint count, BYTES str, gint length)
+    {
+        return search(src, count, str, length);
+    }
+
+    gint StringKernels::indexOf(CHARS src, gint count, CHARS str, gint length)
+    {
+        return search(src, count, str, length);
+    }
+
+    gint StringKernels::indexOf(CHARS src, gint count, BYTES str, gint length)
+    {
+        return search(src, count, str, length);
+    }
+
+    gint StringKernels::lastIndexOf(BYTES src, gint count, BYTES str, gint length)
+    {
+        return searchBackward(src, count, str, length);
+    }
+
+    gint StringKernels::lastIndexOf(CHARS src, gint count, CHARS str, gint length)
+    {
+        return searchBackward(src, count, str, length);
+    }
+
+    gint StringKernels::lastIndexOf(CHARS src, gint count, BYTES str, gint length)
+    {
+        return searchBackward(src, count, str, length);
+    }
+
+    gint StringKernels::indexOf(BYTES src, gint count, gchar ch)
+    {
+        return find(src, count, ch);
+    }
+
+    gint StringKernels::indexOf(CHARS src, gint count, gchar ch)
+    {
+        return find(src, count, ch);
+    }
+
+    gint StringKernels::lastIndexOf(BYTES src, gint count, gchar ch)
+    {
+        return findBackward(src, count, ch);
+    }
+
+    gint StringKernels::lastIndexOf(CHARS src, gint count, gchar ch)
+    {
+        return findBackward(src, count, ch);
+    }
+
+    gint StringKernels::indexOfAny(BYTES src, gint count, BYTES set, gint length)
+    {
+        return findAny(src, count, set, length);
+    }
+
+    gint StringKernels::indexOfAny(BYTES src, gint count, CHARS set, gint length)
+    {
+        return findAny(src, count, set, length);
+    }
+
+    gint StringKernels::indexOfAny(CHARS src, gint count, BYTES set, gint length)
+    {
+        return findAny(src, count, set, length);
+    }
+
+    gint StringKernels::indexOfAny(CHARS src, gint count, CHARS set, gint length)
+    {
+        return findAny(src, count, set, length);
+    }
+
+    gint StringKernels::mismatch(BYTES src1, BYTES src2, gint count)
+    {
+        return mismatchOf(src1, src2, count);
+    }
+
+    gint StringKernels::mismatch(CHARS src1, CHARS src2, gint count)
+    {
+        return mismatchOf(src1, src2, count);
+    }
+
+    gint StringKernels::mismatch(CHARS src1, BYTES src2, gint count)
+    {
+        return mismatchOf(src1, src2, count);
+    }
+
+    gint StringKernels::hash(BYTES src, gint count, gint hash)
+    {
+        return hashOf(src, count, hash);
+    }
+
+    gint StringKernels::hash(CHARS src, gint count, gint hash)
+    {
+        return hashOf(src, count, hash);
+    }
+
+    gint StringKernels::toLowerCase(BYTES src, BYTES dst, gint count)
+    {
+        return convertCase(src, dst, count, false);
+    }
+
+    gint StringKernels::toLowerCase(CHARS src, CHARS dst, gint count)
+    {
+        return convertCase(src, dst, count, false);
+    }
+
+    gint StringKernels::toUpperCase(BYTES src, BYTES dst, gint count)
+    {
+        return convertCase(src, dst, count, true);
+    }
+
+    gint StringKernels::toUpperCase(CHARS src, CHARS dst, gint count)
+    {
+        return convertCase(src, dst, count, true);
+    }
+
+    gint StringKernels::indexOfUpperCase(BYTES src, gint count)
+    {
+        return findCased(src, count, false);
+    }
+
+    gint StringKernels::indexOfUpperCase(CHARS src, gint count)
+    {
+        return findCased(src, count, false);
+    }
+
+    gint StringKernels::indexOfLowerCase(BYTES src, gint count)
+    {
+        return findCased(src, count, true);
+    }
+
+    gint StringKernels::indexOfLowerCase(CHARS src, gint count)
+    {
+        return findCased(src, count, true);
+    }
+
+    gint StringKernels::mismatchIgnoreCase(BYTES src1, BYTES src2, gint count)
+    {
+        return mismatchIgnoreCaseOf(src1, src2, count);
+    }
+
+    gint StringKernels::mismatchIgnoreCase(CHARS src1, CHARS src2, gint count)
+    {
+        return mismatchIgnoreCaseOf(src1, src2, count);
+    }
+
+    gint StringKernels::mismatchIgnoreCase(CHARS src1, BYTES src2, gint count)
+    {
+        return mismatchIgnoreCaseOf(src1, src2, count);
+    }
+
+    gint StringKernels::indexOfNonSpace(BYTES src, gint count)
+    {
+        return findNonSpace(src, count, false);
+    }
+
+    gint StringKernels::indexOfNonSpace(CHARS src, gint count)
+    {
+        return findNonSpace(src, count, false);
+    }
+
+    gint StringKernels::lastIndexOfNonSpace(BYTES src, gint count)
+    {
+        return findNonSpaceBackward(src, count, false);
+    }
+
+    gint StringKernels::lastIndexOfNonSpace(CHARS src, gint count)
+    {
+        return findNonSpaceBackward(src, count, false);
+    }
+
+    gint StringKernels::indexOfNonWhitespace(BYTES src, gint count)
+    {
+        return findNonSpace(src, count, true);
+    }
+
+    gint StringKernels::indexOfNonWhitespace(CHARS src, gint count)
+    {
+        return findNonSpace(src, count, true);
+    }
+
+    gint StringKernels::lastIndexOfNonWhitespace(BYTES src, gint count)
+    {
+        return findNonSpaceBackward(src, count, true);
+    }
+
+    gint StringKernels::lastIndexOfNonWhitespace(CHARS src, gint count)
+    {
+        return findNonSpaceBackward(src, count, true);
+    }
+
+#if CORE_STRING_KERNELS_X86
+
+    /**
+     * Search the first byte above 0x7F by blocks of bytes.
+     *
+     * @see findSSE2
+     */
+    static gint findNonAsciiSSE2(StringKernels::BYTES src, gint count, gint &from)
+    {
+        gint i = from;
+        for (; i + 16 <= count; i += 16) {
+            gint mask = _mm_movemask_epi8(_mm_loadu_si128(CORE_CAST(__m128i const *, src + i)));
+            if (mask != 0) {
+                return i + lowestBit(mask);
+            }
+        }
+        from = i;
+        return -1;
+    }
+
+    CORE_TARGET_AVX2
+    static gint findNonAsciiAVX2(StringKernels::BYTES src, gint count, gint &from)
+    {
+        gint i = from;
+        for (; i + 32 <= count; i += 32) {
+            gint mask = _mm256_movemask_epi8(_mm256_loadu_si256(CORE_CAST(__m256i const *, src + i)));
+            if (mask != 0) {
+                return i + lowestBit(mask);
+            }
+        }
+        from = i;
+        return -1;
+    }
+
+#endif
+
+    gint StringKernels::indexOfNonAscii(BYTES src, gint count)
+    {
+        gint i = 0;
+#if CORE_STRING_KERNELS_X86
+        gint index = features() == AVX2 ? findNonAsciiAVX2(src, count, i) : findNonAsciiSSE2(src, count, i);
+        if (index >= 0) {
+            return index;
+        }
+#endif
+        for (; i < count; ++i) {
+            if (src[i] < 0) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    /**
+     * Decode the utf8 sequence at the beginning of the given bytes (RFC 3629: no
+     * overlong form, no surrogate and nothing above U+10FFFF). Return the length
+     * of the sequence and store its code point in the given variable, or for a
+     * malformed sequence return the opposite of the length of its longest prefix
+     * that could start a valid sequence (at least one byte).
+     */
+    static gint sequenceOf(StringKernels::BYTES src, gint count, gint &ch)
+    {
+        gint b0 = src[0] & 0xFF;
+        gint length = 0;
+        gint low = 0x80;
+        gint high = 0xBF;
+        if (b0 < 0x80) {
+            ch = b0;
+            return 1;
+        }
+        else if (b0 < 0xC2) {
+            return -1;
+        }
+        else if (b0 < 0xE0) {
+            length = 2;
+            ch = b0 & 0x1F;
+        }
+        else if (b0 < 0xF0) {
+            length = 3;
+            ch = b0 & 0x0F;
+            if (b0 == 0xE0) low = 0xA0;
+            if (b0 == 0xED) high = 0x9F;
+        }
+        else if (b0 < 0xF5) {
+            length = 4;
+            ch = b0 & 0x07;
+            if (b0 == 0xF0) low = 0x90;
+            if (b0 == 0xF4) high = 0x8F;
+        }
+        else {
+            return -1;
+        }
+        for (gint j = 1; j < length; ++j) {
+            gint b = j < count ? src[j] & 0xFF : -1;
+            if (b < low || b > high) {
+                return -j;
+            }
+            ch = (ch << 6) | (b & 0x3F);
+            low = 0x80;
+            high = 0xBF;
+        }
+        return length;
+    }
+
+    /**
+     * Return the number of the ascii bytes at the beginning of the given bytes.
+     */
+    static gint asciiRunOf(StringKernels::BYTES src, gint count)
+    {
+        gint index = StringKernels::indexOfNonAscii(src, count);
+        return index < 0 ? count : index;
+    }
+
+    gint StringKernels::scanUTF8(BYTES src, gint count, gint &length, gbool &latin1)
+    {
+        gint i = 0;
+        gint n = 0;
+        gbool isLatin1 = latin1;
+        while (i < count) {
+            if (src[i] >= 0) {
+                gint run = asciiRunOf(src + i, count - i);
+                n += run;
+                i += run;
+                continue;
+            }
+            gint ch = 0;
+            gint k = sequenceOf(src + i, count - i, ch);
+            if (k < 0) {
+                break;
+            }
+            n += ch > 0xFFFF ? 2 : 1;
+            isLatin1 = isLatin1 && ch <= 0xFF;
+            i += k;
+        }
+        length += n;
+        latin1 = isLatin1;
+        return i;
+    }
+
+    gint StringKernels::malformedUTF8(BYTES src, gint count)
+    {
+        gint ch = 0;
+        gint k = sequenceOf(src, count, ch);
+        return k < 0 ? -k : 0;
+    }
+
+    gint StringKernels::decodeUTF8(BYTES src, gint count, BYTES dst, gint &length)
+    {
+        gint i = 0;
+        gint k = 0;
+        while (i < count) {
+            if (src[i] >= 0) {
+                gint run = asciiRunOf(src + i, count - i);
+                copyBytes(src + i, dst + k, run);
+                i += run;
+                k += run;
+                continue;
+            }
+            gint ch = 0;
+            gint n = sequenceOf(src + i, count - i, ch);
+            if (n < 0 || ch > 0xFF) {
+                break;
+            }
+            dst[k++] = (gbyte) ch;
+            i += n;
+        }
+        length = k;
+        return i;
+    }
+
+    gint StringKernels::decodeUTF8(BYTES src, gint count, CHARS dst, gint &length)
+    {
+        gint i = 0;
+        gint k = 0;
+        while (i < count) {
+            if (src[i] >= 0) {
+                gint run = asciiRunOf(src + i, count - i);
+                widenLatin1(src + i, dst + k, run);
+                i += run;
+                k += run;
+                continue;
+            }
+            gint ch = 0;
+            gint n = sequenceOf(src + i, count - i, ch);
+            if (n < 0) {
+                break;
+            }
+            if (ch > 0xFFFF) {
+                dst[k++] = (gchar) ((ch >> 10) + (0xD800 - (0x10000 >> 10)));
+                dst[k++] = (gchar) ((ch & 0x3FF) + 0xDC00);
+            }
+            else {
+                dst[k++] = (gchar) ch;
+            }
+            i += n;
+        }
+        length = k;
+        return i;
+    }
+
+#if CORE_STRING_KERNELS_X86
+
+    /**
+     * Search the first character above 0x7F by blocks of characters.
+     *
+     * @see findSSE2
+     */
+    static gint findNonAsciiSSE2(StringKernels::CHARS src, gint count, gint &from)
+    {
+        __m128i const high = _mm_set1_epi16((gshort) 0xFF80);
+        __m128i const zero = _mm_setzero_si128();
+        gint i = from;
+        for (; i + 8 <= count; i += 8) {
+            __m128i chars = _mm_loadu_si128(CORE_CAST(__m128i const *, src + i));
+            gint mask = _mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(chars, high), zero)) ^ 0xFFFF;
+            if (mask != 0) {
+                return i + lowestBit(mask) / 2;
+            }
+        }
+        from = i;
+        return -1;
+    }
+
+    CORE_TARGET_AVX2
+    static gint findNonAsciiAVX2(StringKernels::CHARS src, gint count, gint &from)
+    {
+        __m256i const high = _mm256_set1_epi16((gshort) 0xFF80);
+        __m256i const zero = _mm256_setzero_si256();
+        gint i = from;
+        for (; i + 16 <= count; i += 16) {
+            __m256i chars = _mm256_loadu_si256(CORE_CAST(__m256i const *, src + i));
+            gint mask = ~_mm256_movemask_epi8(_mm256_cmpeq_epi16(_mm256_and_si256(chars, high), zero));
+            if (mask != 0) {
+                return i + lowestBit(mask) / 2;
+            }
+        }
+        from = i;
+        return -1;
+    }
+
+    /**
+     * Count the utf8 bytes of the latin1 characters by blocks: one byte
+     * per character, and one more for the characters above 0x7F.
+     */
+    static glong utf8LengthSSE2(StringKernels::BYTES src, gint count, gint &from)
+    {
+        glong length = 0;
+        gint i = from;
+        for (; i + 16 <= count; i += 16) {
+            length += 16 + bitCount(_mm_movemask_epi8(_mm_loadu_si128(CORE_CAST(__m128i const *, src + i))));
+        }
+        from = i;
+        return length;
+    }
+
+    CORE_TARGET_AVX2
+    static glong utf8LengthAVX2(StringKernels::BYTES src, gint count, gint &from)
+    {
+        glong length = 0;
+        gint i = from;
+        for (; i + 32 <= count; i += 32) {
+            length += 32 + bitCount(_mm256_movemask_epi8(_mm256_loadu_si256(CORE_CAST(__m256i const *, src + i))));
+        }
+        from = i;
+        return length;
+    }
+
+    /**
+     * Count the utf8 bytes of the utf16 characters by blocks: three bytes per
+     * character, one less for the characters below 0x800 and one less again
+     * for the characters below 0x80. Stop on the blocks that contain surrogates.
+     */
+    static glong utf8LengthSSE2(StringKernels::CHARS src, gint count, gint &from)
+    {
+        __m128i const ascii = _mm_set1_epi16((gshort) 0xFF80);
+        __m128i const plane = _mm_set1_epi16((gshort) 0xF800);
+        __m128i const surrogate = _mm_set1_epi16((gshort) 0xD800);
+        __m128i const zero = _mm_setzero_si128();
+        glong length = 0;
+        gint i = from;
+        for (; i + 8 <= count; i += 8) {
+            __m128i chars = _mm_loadu_si128(CORE_CAST(__m128i const *, src + i));
+            __m128i highBits = _mm_and_si128(chars, plane);
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(highBits, surrogate)) != 0) {
+                break;
+            }
+            gint small = bitCount(_mm_movemask_epi8(_mm_cmpeq_epi16(highBits, zero)));
+            gint tiny = bitCount(_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(chars, ascii), zero)));
+            length += 24 - (small + tiny) / 2;
+        }
+        from = i;
+        return length;
+    }
+
+    CORE_TARGET_AVX2
+    static glong utf8LengthAVX2(StringKernels::CHARS src, gint count, gint &from)
+    {
+        __m256i const ascii = _mm256_set1_epi16((gshort) 0xFF80);
+        __m256i const plane = _mm256_set1_epi16((gshort) 0xF800);
+        __m256i const surrogate = _mm256_set1_epi16((gshort) 0xD800);
+        __m256i const zero = _mm256_setzero_si256();
+        glong length = 0;
+        gint i = from;
+        for (; i + 16 <= count; i += 16) {
+            __m256i chars = _mm256_loadu_si256(CORE_CAST(__m256i const *, src + i));
+            __m256i highBits = _mm256_and_si256(chars, plane);
+            if (_mm256_movemask_epi8(_mm256_cmpeq_epi16(highBits, surrogate)) != 0) {
+                break;
+            }
+            gint small = bitCount(_mm256_movemask_epi8(_mm256_cmpeq_epi16(highBits, zero)));
+            gint tiny = bitCount(_mm256_movemask_epi8(_mm256_cmpeq_epi16(_mm256_and_si256(chars, ascii), zero)));
+            length += 48 - (small + tiny) / 2;
+        }
+        from = i;
+        return length;
+    }
+
+#endif
+
+    gint StringKernels::indexOfNonAscii(CHARS src, gint count)
+    {
+        gint i = 0;
+#if CORE_STRING_KERNELS_X86
+        gint index = features() == AVX2 ? findNonAsciiAVX2(src, count, i) : findNonAsciiSSE2(src, count, i);
+        if (index >= 0) {
+            return index;
+        }
+#endif
+        for (; i < count; ++i) {
+            if (src[i] >= 0x80) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    glong StringKernels::utf8Length(BYTES src, gint count)
+    {
+        gint i = 0;
+        glong length = 0;
+#if CORE_STRING_KERNELS_X86
+        length = features() == AVX2 ? utf8LengthAVX2(src, count, i) : utf8LengthSSE2(src, count, i);
+#endif
+        for (; i < count; ++i) {
+            length += src[i] < 0 ? 2 : 1;
+        }
+        return length;
+    }
+
+    /**
+     * Return the code point of the surrogate pair at the given index, or -1
+     * if the character at the given index does not start a surrogate pair.
+     */
+    static gint surrogatePairOf(StringKernels::CHARS src, gint count, gint index)
+    {
+        gchar high = src[index];
+        if (high >= 0xD800 && high <= 0xDBFF && index + 1 < count) {
+            gchar low = src[index + 1];
+            if (low >= 0xDC00 && low <= 0xDFFF) {
+                return ((high - 0xD800) << 10) + (low - 0xDC00) + 0x10000;
+            }
+        }
+        return -1;
+    }
+
+    glong StringKernels::utf8Length(CHARS src, gint count)
+    {
+        gint i = 0;
+        glong length = 0;
+        while (i < count) {
+#if CORE_STRING_KERNELS_X86
+            length += features() == AVX2 ? utf8LengthAVX2(src, count, i) : utf8LengthSSE2(src, count, i);
+#endif
+            // the surrogates, and the characters after the last block
+            gint end = count - i > 16 ? i + 16 : count;
+            for (; i < end; ++i) {
+                gchar ch = src[i];
+                if (ch < 0x80) {
+                    length += 1;
+                }
+                else if (ch < 0x800) {
+                    length += 2;
+                }
+                else if (ch < 0xD800 || ch > 0xDFFF) {
+                    length += 3;
+                }
+                else if (surrogatePairOf(src, count, i) >= 0) {
+                    length += 4;
+                    i += 1;
+                }
+                else {
+                    // unpaired surrogate, replaced by '?'
+                    length += 1;
+                }
+            }
+        }
+        return length;
+    }
+
+    glong StringKernels::encodeUTF8(BYTES src, gint count, BYTES dst)
+    {
+        gint i = 0;
+        glong k = 0;
+        while (i < count) {
+            if (src[i] >= 0) {
+                gint run = asciiRunOf(src + i, count - i);
+                copyBytes(src + i, dst + k, run);
+                i += run;
+                k += run;
+                continue;
+            }
+            gint ch = src[i++] & 0xFF;
+            dst[k++] = (gbyte) (0xC0 | (ch >> 6));
+            dst[k++] = (gbyte) (0x80 | (ch & 0x3F));
+        }
+        return k;
+    }
+
+    glong StringKernels::encodeUTF8(CHARS src, gint count, BYTES dst)
+    {
+        gint i = 0;
+        glong k = 0;
+        while (i < count) {
+            if (src[i] < 0x80) {
+                gint run = indexOfNonAscii(src + i, count - i);
+                if (run < 0) {
+                    run = count - i;
+                }
+                narrowUTF16(src + i, dst + k, run);
+                i += run;
+                k += run;
+                continue;
+            }
+            gint ch = src[i++];
+            if (ch < 0x800) {
+                dst[k++] = (gbyte) (0xC0 | (ch >> 6));
+            }
+            else if (ch < 0xD800 || ch > 0xDFFF) {
+                dst[k++] = (gbyte) (0xE0 | (ch >> 12));
+                dst[k++] = (gbyte) (0x80 | ((ch >> 6) & 0x3F));
+            }
+            else if ((ch = surrogatePairOf(src, count, i - 1)) >= 0) {
+                i += 1;
+                dst[k++] = (gbyte) (0xF0 | (ch >> 18));
+                dst[k++] = (gbyte) (0x80 | ((ch >> 12) & 0x3F));
+                dst[k++] = (gbyte) (0x80 | ((ch >> 6) & 0x3F));
+            }
+            else {
+                // unpaired surrogate
+                dst[k++] = '?';
+                continue;
+            }
+            dst[k++] = (gbyte) (0x80 | (ch & 0x3F));
+        }
+        return k;
+    }
+
+#if CORE_STRING_KERNELS_X86
+
+    /**
+     * Count the surrogate pairs by blocks of characters: the high surrogates
+     * of the block followed by a low surrogate, loaded one character further.
+     */
+    static gint surrogatePairsSSE2(StringKernels::CHARS src, gint count, gint &from)
+    {
+        __m128i const bits = _mm_set1_epi16((gshort) 0xFC00);
+        __m128i const high = _mm_set1_epi16((gshort) 0xD800);
+        __m128i const low = _mm_set1_epi16((gshort) 0xDC00);
+        gint pairs = 0;
+        gint i = from;
+        for (; i + 9 <= count; i += 8) {
+            __m128i chars = _mm_loadu_si128(CORE_CAST(__m128i const *, src + i));
+            __m128i next = _mm_loadu_si128(CORE_CAST(__m128i const *, src + i + 1));
+            __m128i starts = _mm_and_si128(_mm_cmpeq_epi16(_mm_and_si128(chars, bits), high),
+                                           _mm_cmpeq_epi16(_mm_and_si128(next, bits), low));
+            pairs += bitCount(_mm_movemask_epi8(starts)) / 2;
+        }
+        from = i;
+        return pairs;
+    }
+
+    CORE_TARGET_AVX2
+    static gint surrogatePairsAVX2(StringKernels::CHARS src, gint count, gint &from)
+    {
+        __m256i const bits = _mm256_set1_epi16((gshort) 0xFC00);
+        __m256i const high = _mm256_set1_epi16((gshort) 0xD800);
+        __m256i const low = _mm256_set1_epi16((gshort) 0xDC00);
+        gint pairs = 0;
+        gint i = from;
+        for (; i + 17 <= count; i += 16) {
+            __m256i chars = _mm256_loadu_si256(CORE_CAST(__m256i const *, src + i));
+            __m256i next = _mm256_loadu_si256(CORE_CAST(__m256i const *, src + i + 1));
+            __m256i starts = _mm256_and_si256(_mm256_cmpeq_epi16(_mm256_and_si256(chars, bits), high),
+                                              _mm256_cmpeq_epi16(_mm256_and_si256(next, bits), low));
+            pairs += bitCount(_mm256_movemask_epi8(starts)) / 2;
+        }
+        from = i;
+        return pairs;
+    }
+
+    /**
+     * Return true if the given block of characters contains a surrogate.
+     */
+    static gbool hasSurrogateSSE2(__m128i chars)
+    {
+        __m128i highBits = _mm_and_si128(chars, _mm_set1_epi16((gshort) 0xF800));
+        return _mm_movemask_epi8(_mm_cmpeq_epi16(highBits, _mm_set1_epi16((gshort) 0xD800))) != 0;
+    }
+
+    CORE_TARGET_AVX2
+    static gbool hasSurrogateAVX2(__m256i chars)
+    {
+        __m256i highBits = _mm256_and_si256(chars, _mm256_set1_epi16((gshort) 0xF800));
+        return _mm256_movemask_epi8(_mm256_cmpeq_epi16(highBits, _mm256_set1_epi16((gshort) 0xD800))) != 0;
+    }
+
+    /**
+     * Skip the blocks of characters without surrogates while the number
+     * of code points to skip covers them.
+     */
+    static void skipCodePointsSSE2(StringKernels::CHARS src, gint count, gint &n, gint &from)
+    {
+        gint i = from;
+        for (; n >= 8 && i + 8 <= count; i += 8, n -= 8) {
+            if (hasSurrogateSSE2(_mm_loadu_si128(CORE_CAST(__m128i const *, src + i)))) {
+                break;
+            }
+        }
+        from = i;
+    }
+
+    CORE_TARGET_AVX2
+    static void skipCodePointsAVX2(StringKernels::CHARS src, gint count, gint &n, gint &from)
+    {
+        gint i = from;
+        for (; n >= 16 && i + 16 <= count; i += 16, n -= 16) {
+            if (hasSurrogateAVX2(_mm256_loadu_si256(CORE_CAST(__m256i const *, src + i)))) {
+                break;
+            }
+        }
+        from = i;
+    }
+
+    /**
+     * Widen the blocks of characters without surrogates to code points.
+     */
+    static void toCodePointsSSE2(StringKernels::CHARS src, gint count, StringKernels::INTS dst, gint &from, gint &to)
+    {
+        __m128i const zero = _mm_setzero_si128();
+        gint i = from;
+        gint k = to;
+        for (; i + 8 <= count; i += 8, k += 8) {
+            __m128i chars = _mm_loadu_si128(CORE_CAST(__m128i const *, src + i));
+            if (hasSurrogateSSE2(chars)) {
+                break;
+            }
+            _mm_storeu_si128(CORE_CAST(__m128i *, dst + k), _mm_unpacklo_epi16(chars, zero));
+            _mm_storeu_si128(CORE_CAST(__m128i *, dst + k + 4), _mm_unpackhi_epi16(chars, zero));
+        }
+        from = i;
+        to = k;
+    }
+
+    CORE_TARGET_AVX2
+    static void toCodePointsAVX2(StringKernels::CHARS src, gint count, StringKernels::INTS dst, gint &from, gint &to)
+    {
+        gint i = from;
+        gint k = to;
+        for (; i + 16 <= count; i += 16, k += 16) {
+            __m256i chars = _mm256_loadu_si256(CORE_CAST(__m256i const *, src + i));
+            if (hasSurrogateAVX2(chars)) {
+                break;
+            }
+            _mm256_storeu_si256(CORE_CAST(__m256i *, dst + k), _mm256_cvtepu16_epi32(_mm256_castsi256_si128(chars)));
+            _mm256_storeu_si256(CORE_CAST(__m256i *, dst + k + 8),
+                                _mm256_cvtepu16_epi32(_mm256_extracti128_si256(chars, 1)));
+        }
+        from = i;
+        to = k;
+    }
+
+    static void toCodePointsSSE2(StringKernels::BYTES src, gint count, StringKernels::INTS dst, gint &from)
+    {
+        __m128i const zero = _mm_setzero_si128();
+        gint i = from;
+        for (; i + 16 <= count; i += 16) {
+            __m128i bytes = _mm_loadu_si128(CORE_CAST(__m128i const *, src + i));
+            __m128i low = _mm_unpacklo_epi8(bytes, zero);
+            __m128i high = _mm_unpackhi_epi8(bytes, zero);
+            _mm_storeu_si128(CORE_CAST(__m128i *, dst + i), _mm_unpacklo_epi16(low, zero));
+            _mm_storeu_si128(CORE_CAST(__m128i *, dst + i + 4), _mm_unpackhi_epi16(low, zero));
+            _mm_storeu_si128(CORE_CAST(__m128i *, dst + i + 8), _mm_unpacklo_epi16(high, zero));
+            _mm_storeu_si128(CORE_CAST(__m128i *, dst + i + 12), _mm_unpackhi_epi16(high, zero));
+        }
+        from = i;
+    }
+
+    CORE_TARGET_AVX2
+    static void toCodePointsAVX2(StringKernels::BYTES src, gint count, StringKernels::INTS dst, gint &from)
+    {
+        gint i = from;
+        for (; i + 16 <= count; i += 16) {
+            __m128i bytes = _mm_loadu_si128(CORE_CAST(__m128i const *, src + i));
+            _mm256_storeu_si256(CORE_CAST(__m256i *, dst + i), _mm256_cvtepu8_epi32(bytes));
+            _mm256_storeu_si256(CORE_CAST(__m256i *, dst + i + 8), _mm256_cvtepu8_epi32(_mm_srli_si128(bytes, 8)));
+        }
+        from = i;
+    }
+
+    /**
+     * Count the utf16 characters of the code points by blocks: one per code
+     * point, and one more for the supplementary code points. The flag is
+     * cleared if one of the code points is not latin1.
+     */
+    static gint utf16LengthSSE2(StringKernels::INTS src, gint count, gbool &latin1, gint &from)
+    {
+        __m128i const bmp = _mm_set1_epi32(0xFFFF);
+        __m128i const limit = _mm_set1_epi32(0x110000);
+        __m128i const nonLatin1 = _mm_set1_epi32(~0xFF);
+        __m128i others = _mm_setzero_si128();
+        gint length = 0;
+        gint i = from;
+        for (; i + 4 <= count; i += 4) {
+            __m128i codePoints = _mm_loadu_si128(CORE_CAST(__m128i const *, src + i));
+            __m128i supplementary = _mm_and_si128(_mm_cmpgt_epi32(codePoints, bmp),
+                                                  _mm_cmplt_epi32(codePoints, limit));
+            length += 4 + bitCount(_mm_movemask_epi8(supplementary)) / 4;
+            others = _mm_or_si128(others, _mm_and_si128(codePoints, nonLatin1));
+        }
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(others, _mm_setzero_si128())) != 0xFFFF) {
+            latin1 = false;
+        }
+        from = i;
+        return length;
+    }
+
+    CORE_TARGET_AVX2
+    static gint utf16LengthAVX2(StringKernels::INTS src, gint count, gbool &latin1, gint &from)
+    {
+        __m256i const bmp = _mm256_set1_epi32(0xFFFF);
+        __m256i const limit = _mm256_set1_epi32(0x110000);
+        __m256i const nonLatin1 = _mm256_set1_epi32(~0xFF);
+        __m256i others = _mm256_setzero_si256();
+        gint length = 0;
+        gint i = from;
+        for (; i + 8 <= count; i += 8) {
+            __m256i codePoints = _mm256_loadu_si256(CORE_CAST(__m256i const *, src + i));
+            __m256i supplementary = _mm256_and_si256(_mm256_cmpgt_epi32(codePoints, bmp),
+                                                     _mm256_cmpgt_epi32(limit, codePoints));
+            length += 8 + bitCount(_mm256_movemask_epi8(supplementary)) / 4;
+            others = _mm256_or_si256(others, _mm256_and_si256(codePoints, nonLatin1));
+        }
+        if (!_mm256_testz_si256(others, others)) {
+            latin1 = false;
+        }
+        from = i;
+        return length;
+    }
+
+    /**
+     * Narrow the blocks of code points of the basic multilingual plane to
+     * utf16 characters. The packing instructions saturate as signed numbers,
+     * so the code points are biased by 0x8000.
+     */
+    static void fromCodePointsSSE2(StringKernels::INTS src, gint count, StringKernels::CHARS dst, gint &from, gint &to)
+    {
+        __m128i const nonBmp = _mm_set1_epi32(~0xFFFF);
+        __m128i const bias32 = _mm_set1_epi32(0x8000);
+        __m128i const bias16 = _mm_set1_epi16((gshort) 0x8000);
+        __m128i const zero = _mm_setzero_si128();
+        gint i = from;
+        gint k = to;
+        for (; i + 8 <= count; i += 8, k += 8) {
+            __m128i first = _mm_loadu_si128(CORE_CAST(__m128i const *, src + i));
+            __m128i second = _mm_loadu_si128(CORE_CAST(__m128i const *, src + i + 4));
+            __m128i others = _mm_and_si128(_mm_or_si128(first, second), nonBmp);
+            if (_mm_movemask_epi8(_mm_cmpeq_epi32(others, zero)) != 0xFFFF) {
+                break;
+            }
+            __m128i chars = _mm_packs_epi32(_mm_sub_epi32(first, bias32), _mm_sub_epi32(second, bias32));
+            _mm_storeu_si128(CORE_CAST(__m128i *, dst + k), _mm_add_epi16(chars, bias16));
+        }
+        from = i;
+        to = k;
+    }
+
+    CORE_TARGET_AVX2
+    static void fromCodePointsAVX2(StringKernels::INTS src, gint count, StringKernels::CHARS dst, gint &from, gint &to)
+    {
+        __m256i const nonBmp = _mm256_set1_epi32(~0xFFFF);
+        __m256i const bias32 = _mm256_set1_epi32(0x8000);
+        __m256i const bias16 = _mm256_set1_epi16((gshort) 0x8000);
+        gint i = from;
+        gint k = to;
+        for (; i + 16 <= count; i += 16, k += 16) {
+            __m256i first = _mm256_loadu_si256(CORE_CAST(__m256i const *, src + i));
+            __m256i second = _mm256_loadu_si256(CORE_CAST(__m256i const *, src + i + 8));
+            if (!_mm256_testz_si256(_mm256_or_si256(first, second), nonBmp)) {
+                break;
+            }
+            // the packing works on the 128-bit lanes
+            __m256i chars = _mm256_packs_epi32(_mm256_sub_epi32(first, bias32), _mm256_sub_epi32(second, bias32));
+            chars = _mm256_permute4x64_epi64(chars, 0xD8);
+            _mm256_storeu_si256(CORE_CAST(__m256i *, dst + k), _mm256_add_epi16(chars, bias16));
+        }
+        from = i;
+        to = k;
+    }
+
+    static void fromCodePointsSSE2(StringKernels::INTS src, gint count, StringKernels::BYTES dst, gint &from)
+    {
+        gint i = from;
+        for (; i + 16 <= count; i += 16) {
+            __m128i low = _mm_packs_epi32(_mm_loadu_si128(CORE_CAST(__m128i const *, src + i)),
+                                          _mm_loadu_si128(CORE_CAST(__m128i const *, src + i + 4)));
+            __m128i high = _mm_packs_epi32(_mm_loadu_si128(CORE_CAST(__m128i const *, src + i + 8)),
+                                           _mm_loadu_si128(CORE_CAST(__m128i const *, src + i + 12)));
+            _mm_storeu_si128(CORE_CAST(__m128i *, dst + i), _mm_packus_epi16(low, high));
+        }
+        from = i;
+    }
+
+    CORE_TARGET_AVX2
+    static void fromCodePointsAVX2(StringKernels::INTS src, gint count, StringKernels::BYTES dst, gint &from)
+    {
+        gint i = from;
+        for (; i + 16 <= count; i += 16) {
+            __m256i chars = _mm256_packs_epi32(_mm256_loadu_si256(CORE_CAST(__m256i const *, src + i)),
+                                               _mm256_loadu_si256(CORE_CAST(__m256i const *, src + i + 8)));
+            chars = _mm256_permute4x64_epi64(chars, 0xD8);
+            __m128i bytes = _mm_packus_epi16(_mm256_castsi256_si128(chars), _mm256_extracti128_si256(chars, 1));
+            _mm_storeu_si128(CORE_CAST(__m128i *, dst + i), bytes);
+        }
+        from = i;
+    }
+
+#endif
+
+    static gbool isHighSurrogate(gchar ch)
+    {
+        return (ch & 0xFC00) == 0xD800;
+    }
+
+    static gbool isLowSurrogate(gchar ch)
+    {
+        return (ch & 0xFC00) == 0xDC00;
+    }
+
+    gint StringKernels::codePointCount(CHARS src, gint count)
+    {
+        gint i = 0;
+        gint pairs = 0;
+#if CORE_STRING_KERNELS_X86
+        pairs = features() == AVX2 ? surrogatePairsAVX2(src, count, i) : surrogatePairsSSE2(src, count, i);
+#endif
+        for (; i + 1 < count; ++i) {
+            if (isHighSurrogate(src[i]) && isLowSurrogate(src[i + 1])) {
+                pairs += 1;
+            }
+        }
+        return count - pairs;
+    }
+
+    gint StringKernels::skipCodePoints(CHARS src, gint count, gint n)
+    {
+        gint i = 0;
+        while (n > 0) {
+#if CORE_STRING_KERNELS_X86
+            features() == AVX2 ? skipCodePointsAVX2(src, count, n, i) : skipCodePointsSSE2(src, count, n, i);
+#endif
+            // the blocks with surrogates, and the code points after the last block
+            for (gint j = 0; j < 16 && n > 0; ++j, --n) {
+                if (i >= count) {
+                    return -1;
+                }
+                i += isHighSurrogate(src[i]) && i + 1 < count && isLowSurrogate(src[i + 1]) ? 2 : 1;
+            }
+        }
+        return i;
+    }
+
+    gint StringKernels::toCodePoints(BYTES src, gint count, INTS dst)
+    {
+        gint i = 0;
+#if CORE_STRING_KERNELS_X86
+        features() == AVX2 ? toCodePointsAVX2(src, count, dst, i) : toCodePointsSSE2(src, count, dst, i);
+#endif
+        for (; i < count; ++i) {
+            dst[i] = src[i] & 0xFF;
+        }
+        return count;
+    }
+
+    gint StringKernels::toCodePoints(CHARS src, gint count, INTS dst)
+    {
+        gint i = 0;
+        gint k = 0;
+        while (i < count) {
+#if CORE_STRING_KERNELS_X86
+            features() == AVX2 ? toCodePointsAVX2(src, count, dst, i, k) : toCodePointsSSE2(src, count, dst, i, k);
+#endif
+            gint end = count - i > 16 ? i + 16 : count;
+            while (i < end) {
+                gchar ch = src[i++];
+                if (isHighSurrogate(ch) && i < count && isLowSurrogate(src[i])) {
+                    dst[k++] = ((ch - 0xD800) << 10) + (src[i++] - 0xDC00) + 0x10000;
+                }
+                else {
+                    dst[k++] = ch;
+                }
+            }
+        }
+        return k;
+    }
+
+    gint StringKernels::utf16Length(INTS src, gint count, gbool &latin1)
+    {
+        gint i = 0;
+        gint length = 0;
+#if CORE_STRING_KERNELS_X86
+        length = features() == AVX2 ? utf16LengthAVX2(src, count, latin1, i) : utf16LengthSSE2(src, count, latin1, i);
+#endif
+        for (; i < count; ++i) {
+            gint cp = src[i];
+            length += cp > 0xFFFF && cp <= 0x10FFFF ? 2 : 1;
+            latin1 = latin1 && (cp & ~0xFF) == 0;
+        }
+        return length;
+    }
+
+    void StringKernels::fromCodePoints(INTS src, gint count, BYTES dst)
+    {
+        gint i = 0;
+#if CORE_STRING_KERNELS_X86
+        features() == AVX2 ? fromCodePointsAVX2(src, count, dst, i) : fromCodePointsSSE2(src, count, dst, i);
+#endif
+        for (; i < count; ++i) {
+            dst[i] = (gbyte) src[i];
+        }
+    }
+
+    gint StringKernels::fromCodePoints(INTS src, gint count, CHARS dst)
+    {
+        gint i = 0;
+        gint k = 0;
+        while (i < count) {
+#if CORE_STRING_KERNELS_X86
+            features() == AVX2 ? fromCodePointsAVX2(src, count, dst, i, k) : fromCodePointsSSE2(src, count, dst, i, k);
+#endif
+            gint end = count - i > 16 ? i + 16 : count;
+            for (; i < end; ++i) {
+                gint cp = src[i];
+                if ((cp & ~0xFFFF) == 0) {
+                    dst[k++] = (gchar) cp;
+                }
+                else if (cp < 0 || cp > 0x10FFFF) {
+                    dst[k++] = '?';
+                }
+                else {
+                    dst[k++] = (gchar) ((cp >> 10) + (0xD800 - (0x10000 >> 10)));
+                    dst[k++] = (gchar) ((cp & 0x3FF) + 0xDC00);
+                }
+            }
+        }
+        return k;
+    }
+} // core
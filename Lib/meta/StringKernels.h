@@ -0,0 +1,364 @@
+//
+// Created by bruns on 21/06/2024.
+//
+
+#ifndef CORE24_STRINGKERNELS_H
+#define CORE24_STRINGKERNELS_H
+
+#include <core/Class.h>
+
+namespace core
+{
+    /**
+     * The class @c StringKernels contains the loops on the characters
+     * of the strings that are vectorized. Each kernel has a scalar
+     * implementation, an SSE2 implementation and an AVX2 implementation,
+     * the one used is selected at runtime from the features of the processor.
+     * <p>
+     * The kernels work on raw pointers: the offsets and the bounds
+     * are checked by the callers.
+     */
+    class StringKernels final : public virtual Object
+    {
+    public:
+        CORE_ALIAS(CHARS, Class< gchar >::Pointer);
+        CORE_ALIAS(BYTES, Class< gbyte >::Pointer);
+        CORE_ALIAS(INTS, Class< gint >::Pointer);
+
+        /**
+         * The instructions sets used by the kernels.
+         */
+        enum Features
+        {
+            SCALAR = 0, SSE2 = 1, AVX2 = 2
+        };
+
+        /**
+         * Returns the best instructions set supported by the processor.
+         */
+        static Features features();
+
+        /**
+         * Restricts the instructions set used by the kernels to the given one, so
+         * that the benchmarks can measure and check each path. The x86 kernels keep
+         * their SSE2 path below AVX2, except @c hash that has a scalar path.
+         * It must be called before the kernels are used by other threads.
+         */
+        static void restrictFeatures(Features features);
+
+        /**
+         * Copies the given number of bytes, the two regions may overlap.
+         */
+        static void copyBytes(BYTES src, BYTES dst, glong size);
+
+        /**
+         * Copies the given latin1 characters as utf16 characters.
+         */
+        static void widenLatin1(BYTES src, CHARS dst, gint count);
+
+        /**
+         * Copies the low byte of each of the given utf16 characters.
+         */
+        static void narrowUTF16(CHARS src, BYTES dst, gint count);
+
+        /**
+         * Copies the given utf16 characters as latin1 characters until
+         * the first character above 0xFF, and returns the number of copied
+         * characters (the given count if all the characters are latin1).
+         */
+        static gint compressUTF16(CHARS src, BYTES dst, gint count);
+
+        /**
+         * Returns the index of the first byte above 0x7F of the given bytes,
+         * or -1 if all the bytes are ascii.
+         */
+        static gint indexOfNonAscii(BYTES src, gint count);
+
+        static gint indexOfNonAscii(CHARS src, gint count);
+
+        /**
+         * Validates the given utf8 bytes until the first malformed sequence and
+         * returns its index (the given count if all the bytes are well-formed).
+         * The number of utf16 characters of the validated bytes is added to the
+         * given length, and the given flag is cleared if one of them is above 0xFF.
+         * The ascii runs are skipped by blocks.
+         */
+        static gint scanUTF8(BYTES src, gint count, gint &length, gbool &latin1);
+
+        /**
+         * Returns the length of the malformed utf8 sequence at the beginning of
+         * the given bytes: its longest prefix that could start a valid sequence,
+         * at least one byte. Returns 0 if the sequence is well-formed.
+         */
+        static gint malformedUTF8(BYTES src, gint count);
+
+        /**
+         * Decodes the given utf8 bytes until the first malformed sequence (or the
+         * first character above 0xFF for latin1) and returns its index. The number
+         * of written characters is stored in the given variable. The ascii runs
+         * are copied by blocks.
+         *
+         * @see scanUTF8
+         */
+        static gint decodeUTF8(BYTES src, gint count, BYTES dst, gint &length);
+
+        static gint decodeUTF8(BYTES src, gint count, CHARS dst, gint &length);
+
+        /**
+         * Returns the number of bytes of the given characters encoded in utf8.
+         * The unpaired surrogates are encoded as @c '?'. The characters are
+         * counted by blocks until the first surrogate.
+         */
+        static glong utf8Length(BYTES src, gint count);
+
+        static glong utf8Length(CHARS src, gint count);
+
+        /**
+         * Encodes the given characters in utf8 and returns the number of written
+         * bytes. The destination must hold the number of bytes returned by
+         * @c utf8Length. The ascii runs are copied by blocks.
+         *
+         * @see utf8Length(BYTES, gint)
+         */
+        static glong encodeUTF8(BYTES src, gint count, BYTES dst);
+
+        static glong encodeUTF8(CHARS src, gint count, BYTES dst);
+
+        /**
+         * Returns the number of code points of the given utf16 characters, each
+         * unpaired surrogate counting as one code point. The surrogate pairs are
+         * counted by blocks.
+         */
+        static gint codePointCount(CHARS src, gint count);
+
+        /**
+         * Returns the index of the character that follows the given number of code
+         * points from the beginning of the given utf16 characters, or -1 if there
+         * are fewer code points. The blocks without surrogates are skipped at once.
+         */
+        static gint skipCodePoints(CHARS src, gint count, gint n);
+
+        /**
+         * Copies the code points of the given characters and returns their number.
+         * The blocks without surrogates are widened at once.
+         */
+        static gint toCodePoints(BYTES src, gint count, INTS dst);
+
+        static gint toCodePoints(CHARS src, gint count, INTS dst);
+
+        /**
+         * Returns the number of utf16 characters of the given code points, the
+         * invalid ones counting as one character. The given flag is cleared
+         * if one of the code points is not latin1.
+         */
+        static gint utf16Length(INTS src, gint count, gbool &latin1);
+
+        /**
+         * Copies the given latin1 code points as latin1 characters.
+         */
+        static void fromCodePoints(INTS src, gint count, BYTES dst);
+
+        /**
+         * Copies the given code points as utf16 characters and returns the number
+         * of written characters, the invalid code points are written as @c '?'.
+         *
+         * @see utf16Length
+         */
+        static gint fromCodePoints(INTS src, gint count, CHARS dst);
+
+        /**
+         * Returns the index of the first character that differs between the
+         * two given sequences of characters, or -1 if all the characters are equal.
+         *
+         * @param src1 The first characters
+         * @param src2 The second characters
+         * @param count The number of characters to compare
+         */
+        static gint mismatch(BYTES src1, BYTES src2, gint count);
+
+        static gint mismatch(CHARS src1, CHARS src2, gint count);
+
+        static gint mismatch(CHARS src1, BYTES src2, gint count);
+
+        /**
+         * Returns the index of the first character that differs between the two
+         * given sequences of characters when the latin1 letters are folded to lower
+         * case, or -1 if there is no such character. The characters above 0xFF are
+         * compared as is: the caller checks the returned character with the case
+         * mapping tables.
+         *
+         * @see mismatch(BYTES, BYTES, gint)
+         */
+        static gint mismatchIgnoreCase(BYTES src1, BYTES src2, gint count);
+
+        static gint mismatchIgnoreCase(CHARS src1, CHARS src2, gint count);
+
+        static gint mismatchIgnoreCase(CHARS src1, BYTES src2, gint count);
+
+        /**
+         * Converts the given characters to lower case until the first character
+         * above 0xFF, and returns the number of converted characters (the given
+         * count if all the characters are latin1). The two regions may be the same.
+         */
+        static gint toLowerCase(BYTES src, BYTES dst, gint count);
+
+        static gint toLowerCase(CHARS src, CHARS dst, gint count);
+
+        /**
+         * Converts the given characters to upper case until the first character
+         * whose upper case is not latin1 (0xB5, 0xFF and the characters above 0xFF),
+         * and returns the number of converted characters.
+         *
+         * @see toLowerCase(BYTES, BYTES, gint)
+         */
+        static gint toUpperCase(BYTES src, BYTES dst, gint count);
+
+        static gint toUpperCase(CHARS src, CHARS dst, gint count);
+
+        /**
+         * Returns the index of the first character changed by the conversion to
+         * lower case, or -1 if there is no such character. The characters above 0xFF
+         * are returned too, their case is given by the case mapping tables.
+         */
+        static gint indexOfUpperCase(BYTES src, gint count);
+
+        static gint indexOfUpperCase(CHARS src, gint count);
+
+        /**
+         * Returns the index of the first character changed by the conversion to
+         * upper case, or -1 if there is no such character.
+         *
+         * @see indexOfUpperCase(BYTES, gint)
+         */
+        static gint indexOfLowerCase(BYTES src, gint count);
+
+        static gint indexOfLowerCase(CHARS src, gint count);
+
+        /**
+         * Returns the index of the first character of the given characters that
+         * is not a space (a character up to ' ' as removed by @c String::trim),
+         * or -1 if all the characters are spaces.
+         */
+        static gint indexOfNonSpace(BYTES src, gint count);
+
+        static gint indexOfNonSpace(CHARS src, gint count);
+
+        /**
+         * Returns the index of the last character of the given characters that
+         * is not a space, or -1 if all the characters are spaces.
+         *
+         * @see indexOfNonSpace(BYTES, gint)
+         */
+        static gint lastIndexOfNonSpace(BYTES src, gint count);
+
+        static gint lastIndexOfNonSpace(CHARS src, gint count);
+
+        /**
+         * Returns the index of the first character of the given characters that
+         * is not an ascii whitespace (0x09-0x0D and 0x1C-0x20), or -1 if there is
+         * no such character. These are all the latin1 whitespaces, the characters
+         * above 0x7F are returned too: their class is given by the tables.
+         */
+        static gint indexOfNonWhitespace(BYTES src, gint count);
+
+        static gint indexOfNonWhitespace(CHARS src, gint count);
+
+        /**
+         * Returns the index of the last character of the given characters that
+         * is not an ascii whitespace, or -1 if there is no such character.
+         *
+         * @see indexOfNonWhitespace(BYTES, gint)
+         */
+        static gint lastIndexOfNonWhitespace(BYTES src, gint count);
+
+        static gint lastIndexOfNonWhitespace(CHARS src, gint count);
+
+        /**
+         * Returns the hash of the given characters continuing the given hash, that
+         * is the value of @c hash*31^count+src[0]*31^(count-1)+...+src[count-1]
+         * with the overflows of the @c String::hash. The characters are hashed
+         * by several lanes multiplied by precomputed powers of 31 (32 characters
+         * per block with AVX2, 16 with SSE2, 4 with the scalar path), the result
+         * is identical to the one of the serial computation.
+         *
+         * @param src The characters to hash
+         * @param count The number of characters to hash
+         * @param hash The hash of the preceding characters (0 for none)
+         */
+        static gint hash(BYTES src, gint count, gint hash);
+
+        static gint hash(CHARS src, gint count, gint hash);
+
+        /**
+         * Returns the index of the first occurrence of the given character in
+         * the given characters, or -1 if there is no such occurrence.
+         *
+         * @param src The characters to search in
+         * @param count The number of characters to search in
+         * @param ch The character to search for (a latin1 character for BYTES)
+         */
+        static gint indexOf(BYTES src, gint count, gchar ch);
+
+        static gint indexOf(CHARS src, gint count, gchar ch);
+
+        /**
+         * Returns the index of the last occurrence of the given character in
+         * the given characters, or -1 if there is no such occurrence.
+         *
+         * @see indexOf(BYTES, gint, gchar)
+         */
+        static gint lastIndexOf(BYTES src, gint count, gchar ch);
+
+        static gint lastIndexOf(CHARS src, gint count, gchar ch);
+
+        /**
+         * Returns the index of the first character of the given characters that
+         * is one of the characters of the given set, or -1 if there is no such
+         * character. The sets of up to 8 distinct characters are searched by blocks.
+         *
+         * @param src The characters to search in
+         * @param count The number of characters to search in
+         * @param set The characters to search for
+         * @param length The number of characters to search for
+         */
+        static gint indexOfAny(BYTES src, gint count, BYTES set, gint length);
+
+        static gint indexOfAny(BYTES src, gint count, CHARS set, gint length);
+
+        static gint indexOfAny(CHARS src, gint count, BYTES set, gint length);
+
+        static gint indexOfAny(CHARS src, gint count, CHARS set, gint length);
+
+        /**
+         * Returns the index of the first occurrence of the given string in the
+         * given characters, or -1 if there is no such occurrence. The short strings
+         * are located by comparing their first and last characters to blocks of
+         * characters, the other ones with the Two-Way algorithm. The search is
+         * linear in the worst case.
+         *
+         * @param src The characters to search in
+         * @param count The number of characters to search in
+         * @param str The characters of the string to search for
+         * @param length The number of characters of the string to search for
+         */
+        static gint indexOf(BYTES src, gint count, BYTES str, gint length);
+
+        static gint indexOf(CHARS src, gint count, CHARS str, gint length);
+
+        static gint indexOf(CHARS src, gint count, BYTES str, gint length);
+
+        /**
+         * Returns the index of the last occurrence of the given string in the
+         * given characters, or -1 if there is no such occurrence.
+         *
+         * @see indexOf(BYTES, gint, BYTES, gint)
+         */
+        static gint lastIndexOf(BYTES src, gint count, BYTES str, gint length);
+
+        static gint lastIndexOf(CHARS src, gint count, CHARS str, gint length);
+
+        static gint lastIndexOf(CHARS src, gint count, BYTES str, gint length);
+    };
+} // core
+
+#endif // CORE24_STRINGKERNELS_H
@@ -0,0 +1,192 @@
+//
+// Created by bruns on 18/06/2024.
+//
+
+#include <meta/StringTable.h>
+#include <meta/StringUtils.h>
+
+#if CORE_COMPILER_MSVC
+#include <intrin.h>
+#endif
+
+namespace core
+{
+    struct StringEntry
+    {
+        Class< gbyte >::Pointer value; // the shared characters
+        gint count;                    // the number of characters
+        gint coder;                    // the coder of the characters
+        gint hash;                     // the hash of the characters
+        StringEntry *next;             // the next entry of the same bucket
+    };
+
+    struct StringStripe
+    {
+        gint volatile lock;   // 0 if unlocked, 1 otherwise
+        gint size;            // the number of entries
+        gint capacity;        // the number of buckets (power of two)
+        StringEntry **buckets;
+    };
+
+    static CORE_FAST gint STRIPES = 64;
+
+    static CORE_FAST gint INITIAL_CAPACITY = 16;
+
+    static StringStripe stripes[STRIPES] = {};
+
+    static void lockStripe(StringStripe &stripe)
+    {
+#if CORE_COMPILER_MSVC
+        while (_InterlockedExchange(CORE_CAST(long volatile *, &stripe.lock), 1) != 0) {
+            while (stripe.lock != 0) {
+                _mm_pause();
+            }
+        }
+#else
+        while (__atomic_exchange_n(&stripe.lock, 1, __ATOMIC_ACQUIRE) != 0) {
+            while (__atomic_load_n(&stripe.lock, __ATOMIC_RELAXED) != 0) {
+#if defined(__i386__) || defined(__x86_64__)
+                __builtin_ia32_pause();
+#endif
+            }
+        }
+#endif
+    }
+
+    static void unlockStripe(StringStripe &stripe)
+    {
+#if CORE_COMPILER_MSVC
+        _InterlockedExchange(CORE_CAST(long volatile *, &stripe.lock), 0);
+#else
+        __atomic_store_n(&stripe.lock, 0, __ATOMIC_RELEASE);
+#endif
+    }
+
+    static gint spread(gint hash)
+    {
+        return hash ^ (gint) ((hash + 0u) >> 16);
+    }
+
+    static StringStripe &stripeOf(gint hash)
+    {
+        return stripes[spread(hash) & (STRIPES - 1)];
+    }
+
+    static gint bucketOf(StringStripe const &stripe, gint hash)
+    {
+        // The low bits are already used to select the stripe
+        return (gint) ((spread(hash) + 0u) >> 6) & (stripe.capacity - 1);
+    }
+
+    static void growStripe(StringStripe &stripe)
+    {
+        gint oldCapacity = stripe.capacity;
+        StringEntry **oldBuckets = stripe.buckets;
+
+        stripe.capacity = oldCapacity == 0 ? INITIAL_CAPACITY : oldCapacity << 1;
+        stripe.buckets = new StringEntry *[stripe.capacity]();
+
+        for (int i = 0; i < oldCapacity; ++i) {
+            StringEntry *entry = oldBuckets[i];
+            while (entry != null) {
+                StringEntry *next = entry->next;
+                gint index = bucketOf(stripe, entry->hash);
+                entry->next = stripe.buckets[index];
+                stripe.buckets[index] = entry;
+                entry = next;
+            }
+        }
+        delete[] oldBuckets;
+    }
+
+    String String::StringTable::intern(String const &str)
+    {
+        gint hash = str.hash();
+        gint count = str.length();
+        Coder coder = str.coding();
+
+        StringEntry *newEntry = new StringEntry();
+        StringStripe &stripe = stripeOf(hash);
+
+        lockStripe(stripe);
+
+        if (stripe.capacity > 0) {
+            for (StringEntry *entry = stripe.buckets[bucketOf(stripe, hash)]; entry != null; entry = entry->next) {
+                if (entry->hash != hash || entry->count != count || entry->coder != coder) {
+                    continue;
+                }
+                gint res = coder == LATIN1
+                           ? StringUtils::compareToLatin1(entry->value, 0, str.value, 0, count)
+                           : StringUtils::compareToUTF16(entry->value, 0, str.value, 0, count);
+                if (res == 0 && StringUtils::tryShareString(entry->value)) {
+                    unlockStripe(stripe);
+                    delete newEntry;
+
+                    String canonical;
+                    canonical.value = entry->value;
+                    canonical.coder = coder;
+                    canonical.count = count;
+                    canonical.hashValue = hash;
+                    canonical.hashIsZero = hash == 0;
+                    return canonical;
+                }
+            }
+        }
+
+        String canonical;
+        canonical.coder = coder;
+        canonical.count = count;
+        canonical.hashValue = hash;
+        canonical.hashIsZero = hash == 0;
+        if (!str.valueIsStatic && StringUtils::markInternedString(str.value, hash)) {
+            canonical.value = StringUtils::shareString(str.value);
+        }
+        else {
+            // Static characters, or characters already registered
+            // with another length: the pool uses its own copy.
+            canonical.value = coder == LATIN1
+                              ? StringUtils::copyOfLatin1(str.value, 0, count)
+                              : StringUtils::copyOfUTF16(str.value, 0, count);
+            StringUtils::markInternedString(canonical.value, hash);
+        }
+
+        if (stripe.size >= stripe.capacity) {
+            growStripe(stripe);
+        }
+        gint index = bucketOf(stripe, hash);
+        newEntry->value = canonical.value;
+        newEntry->count = count;
+        newEntry->coder = coder;
+        newEntry->hash = hash;
+        newEntry->next = stripe.buckets[index];
+        stripe.buckets[index] = newEntry;
+        stripe.size += 1;
+
+        unlockStripe(stripe);
+        return canonical;
+    }
+
+    void String::StringTable::remove(BYTES val, gint hash)
+    {
+        StringStripe &stripe = stripeOf(hash);
+
+        lockStripe(stripe);
+
+        if (stripe.capacity > 0) {
+            StringEntry **link = &stripe.buckets[bucketOf(stripe, hash)];
+            while (*link != null) {
+                StringEntry *entry = *link;
+                if (entry->value == val) {
+                    *link = entry->next;
+                    stripe.size -= 1;
+                    delete entry;
+                    break;
+                }
+                link = &entry->next;
+            }
+        }
+
+        unlockStripe(stripe);
+    }
+
+} // core
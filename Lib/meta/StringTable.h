@@ -0,0 +1,31 @@
+//
+// Created by bruns on 18/06/2024.
+//
+
+#ifndef CORE24_STRINGTABLE_H
+#define CORE24_STRINGTABLE_H
+
+#include <core/String.h>
+
+namespace core
+{
+    /**
+     * The pool of the interned strings. The pool is split on several stripes
+     * selected with the hash of the strings, each stripe is protected by its
+     * own lock so that the threads interning different strings rarely wait.
+     * <p>
+     * The pool does not own the strings characters: an entry is removed
+     * when the last string using its characters is destroyed.
+     */
+    class String::StringTable final : public virtual Object
+    {
+    public:
+        CORE_ALIAS(BYTES, Class< gbyte >::Pointer);
+
+        static String intern(String const &str);
+
+        static void remove(BYTES val, gint hash);
+    };
+} // core
+
+#endif // CORE24_STRINGTABLE_H
@@ -3,43 +3,28 @@
 //
 
 #include <meta/StringUtils.h>
+#include <meta/StringTable.h>
+#include <meta/StringKernels.h>
 #include <core/Character.h>
 #include <core/Math.h>
+#include <core/misc/Allocator.h>
+
+#if CORE_COMPILER_MSVC
+#include <intrin.h>
+#endif
 
 namespace core
 {
+    using misc::Allocator;
+
     void String::StringUtils::copyLatin1(BYTES val1, gint off1, BYTES val2, gint off2, gint count)
     {
         off1 = Math::max(off1, 0);
         off2 = Math::max(off2, 0);
         count = Math::max(count, 0);
 
-        if (count == 0) {
-            return;
-        }
-        if (val1 == val2) {
-            if (off1 == off2) {
-                return;
-            }
-            if (off2 > off1) {
-                for (gint i = count - 1; i >= 0; --i) {
-                    gchar c = readLatin1CharAt(val1, i + off1);
-                    writeLatin1CharAt(val2, i + off2, c);
-                }
-            }
-            else {
-                for (int i = 0; i < count; ++i) {
-                    gchar c = readLatin1CharAt(val1, i + off1);
-                    writeLatin1CharAt(val2, i + off2, c);
-                }
-            }
-        }
-        else {
-            for (int i = 0; i < count; ++i) {
-                gchar c = readLatin1CharAt(val1, i + off1);
-                writeLatin1CharAt(val2, i + off2, c);
-            }
-        }
+        // The regions may overlap when val1 and val2 are the same buffer
+        StringKernels::copyBytes(val1 + off1, val2 + off2, count);
     }
 
     void String::StringUtils::copyLatin1ToUTF16(BYTES val1, gint off1, BYTES val2, gint off2, gint count)
@@ -50,8 +35,8 @@ namespace core
 
     void String::StringUtils::copyLatin1ToUTF16(BYTES val1, gint off1, CHARS val2, gint off2, gint count)
     {
-        for (int i = 0; i < count; ++i) {
-            val2[off2++] = (gchar) (val1[off1++] & 0xff);
+        if (count > 0) {
+            StringKernels::widenLatin1(val1 + off1, val2 + off2, count);
         }
     }
 
@@ -74,48 +59,20 @@ namespace core
         off2 = Math::max(off2, 0);
         count = Math::max(count, 0);
 
-        if (count == 0) {
-            return;
-        }
-        if (val1 == val2) {
-            if (off1 == off2) {
-                return;
-            }
-            if (off2 > off1) {
-                for (gint i = count - 1; i >= 0; --i) {
-                    gchar c = readUTF16CharAt(val1, i + off1);
-                    writeUTF16CharAt(val2, i + off2, c);
-                }
-            }
-            else {
-                for (int i = 0; i < count; ++i) {
-                    gchar c = readUTF16CharAt(val1, i + off1);
-                    writeUTF16CharAt(val2, i + off2, c);
-                }
-            }
-        }
-        else {
-            for (int i = 0; i < count; ++i) {
-                gchar c = readUTF16CharAt(val1, i + off1);
-                writeUTF16CharAt(val2, i + off2, c);
-            }
-        }
+        // The regions may overlap when val1 and val2 are the same buffer
+        StringKernels::copyBytes(val1 + ((glong) off1 << 1), val2 + ((glong) off2 << 1), (glong) count << 1);
     }
 
     void String::StringUtils::copyUTF16(BYTES val1, gint off1, CHARS val2, gint off2, gint count)
     {
-        CHARS chars1 = CORE_FCAST(CHARS, val1);
-        for (int i = 0; i < count; ++i) {
-            val2[off2++] = chars1[off1++];
-        }
+        BYTES bytes = CORE_FCAST(BYTES, val2);
+        copyUTF16(val1, off1, bytes, off2, count);
     }
 
     void String::StringUtils::copyUTF16(CHARS val1, gint off1, BYTES val2, gint off2, gint count)
     {
-        CHARS chars = CORE_FCAST(CHARS, val2);
-        for (int i = 0; i < count; ++i) {
-            chars[off2++] = val1[off1++];
-        }
+        BYTES bytes = CORE_FCAST(BYTES, val1);
+        copyUTF16(bytes, off1, val2, off2, count);
     }
 
     void String::StringUtils::copyUTF16ToLatin1(BYTES val1, gint off1, BYTES val2, gint off2, gint count)
@@ -126,8 +83,8 @@ namespace core
 
     void String::StringUtils::copyUTF16ToLatin1(CHARS val1, gint off1, BYTES val2, gint off2, gint count)
     {
-        for (int i = 0; i < count; ++i) {
-            val2[off1++] = (gbyte) (val1[off2++] & 0xff);
+        if (count > 0) {
+            StringKernels::narrowUTF16(val1 + off1, val2 + off2, count);
         }
     }
 
@@ -152,25 +109,10 @@ namespace core
 
     gint String::StringUtils::copyUTF16ToUTF32(CHARS val1, gint off1, INTS val2, gint off2, gint count)
     {
-        gint o2 = off2;
-        for (int i = 0; i < count - 1; ++i) {
-            if (isHighSurrogate(val1[off1])) {
-                if (isLowSurrogate(val1[off1 + 1])) {
-                    val2[off2++] = toCodePoint(val1[off1], val1[off1 + 1]);
-                    i += 1;
-                }
-                else {
-                    val2[off2++] = val1[off1++];
-                }
-            }
-            else {
-                val2[off2++] = val1[off1++];
-            }
-        }
-        if (off1 < count) {
-            val2[off2++] = val1[off1++];
+        if (count <= 0) {
+            return 0;
         }
-        return off2 - o2;
+        return StringKernels::toCodePoints(val1 + off1, count, val2 + off2);
     }
 
     String::StringUtils::BYTES String::StringUtils::copyOfLatin1(BYTES val, gint off, gint count)
@@ -235,75 +177,269 @@ namespace core
 
     String::StringUtils::BYTES String::StringUtils::copyOfUTF32ToUTF16(INTS val, gint off, gint count, gint &length)
     {
-        gint n = 0;
-        for (int i = 0; i < count; ++i) {
-            gint cp = val[i + off];
-            n += cp <= 0xffff || cp > 0x10ffff ? 1 : 2;
-        }
+        gbool latin1 = false;
+        gint n = StringKernels::utf16Length(val + off, count, latin1);
 
         BYTES bytes = newUTF16String(n);
-        CHARS chars = CORE_FCAST(CHARS, bytes);
+        StringKernels::fromCodePoints(val + off, count, CORE_FCAST(CHARS, bytes));
+        length = n;
+        return bytes;
+    }
 
-        for (int i = 0, j = 0; i < count; ++i) {
-            gint cp = val[i + off];
-            if (cp >= 0 && cp <= 0xffff) {
-                chars[j++] = (gchar) cp;
-            }
-            else if (cp < 0 || cp > 0x10ffff) {
-                chars[j++] = '?';
-            }
-            else {
-                chars[j++] = (cp >> 10) + 0xd800 - (0x10000 >> 10);
-                chars[j++] = (cp & 0x3ff) + 0xdc00;
-            }
+    String::StringUtils::BYTES String::StringUtils::copyOfUTF32(INTS val, gint off, gint count, Coder &coder, gint &length)
+    {
+        // A single pass sizes the string and selects its coder
+        gbool latin1 = COMPACT_STRINGS;
+        gint n = StringKernels::utf16Length(val + off, count, latin1);
+
+        if (latin1) {
+            BYTES bytes = newLatin1String(count);
+            StringKernels::fromCodePoints(val + off, count, bytes);
+            coder = LATIN1;
+            length = count;
+            return bytes;
         }
+        BYTES bytes = newUTF16String(n);
+        StringKernels::fromCodePoints(val + off, count, CORE_FCAST(CHARS, bytes));
+        coder = UTF16;
         length = n;
         return bytes;
     }
 
-    static gint EMPTY_STRING[1] = { 0 };
+    /**
+     * Each heap allocated string buffer is preceded by this header. The pointer
+     * given to the callers always refers to the first byte that follows it, so the
+     * kernels of this class never see the header.
+     * <p>
+     * Strings buffers are immutable once published, copies of a String only
+     * increment the reference count and the buffer is released by the last owner.
+     */
+    struct StringHeader
+    {
+        gint volatile refs;  // the number of owners (negative for static buffers)
+        gint volatile flags; // the storage flags
+        gint hash;           // the hash of the interned strings
+        gint length;         // the number of 8 bytes words that follow the header
+
+        enum Flags
+        {
+            INTERNED = 1,  // the buffer is registered on the intern table
+            SENSITIVE = 2, // the buffer is wiped before release
+            OWNER = 0xF0,  // the tag of the allocator that provided the buffer
+            OWNER_SHIFT = 4
+        };
+    };
+
+    // the tag of the owner must fit in the OWNER bits
+    CORE_FAST_ASSERT(Allocator::MAX_OWNERS <= 16);
+
+    static struct
+    {
+        StringHeader header;
+        glong data;
+    } EMPTY_STRING = {{-1, 0, 0, 1}, 0};
+
+    static StringHeader *headerOf(Class< gbyte >::Pointer val)
+    {
+        return CORE_CAST(StringHeader *, val) - 1;
+    }
+
+    static gint atomicIncrement(gint volatile &refs)
+    {
+#if CORE_COMPILER_MSVC
+        return (gint) _InterlockedIncrement(CORE_CAST(long volatile *, &refs));
+#else
+        return __atomic_add_fetch(&refs, 1, __ATOMIC_RELAXED);
+#endif
+    }
+
+    static gint atomicDecrement(gint volatile &refs)
+    {
+#if CORE_COMPILER_MSVC
+        return (gint) _InterlockedDecrement(CORE_CAST(long volatile *, &refs));
+#else
+        return __atomic_sub_fetch(&refs, 1, __ATOMIC_ACQ_REL);
+#endif
+    }
+
+    static gbool atomicCompareAndSet(gint volatile &refs, gint expected, gint desired)
+    {
+#if CORE_COMPILER_MSVC
+        return _InterlockedCompareExchange(CORE_CAST(long volatile *, &refs), desired, expected) == expected;
+#else
+        return __atomic_compare_exchange_n(&refs, &expected, desired, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+#endif
+    }
+
+    static gint atomicLoad(gint volatile &refs)
+    {
+#if CORE_COMPILER_MSVC
+        return refs;
+#else
+        return __atomic_load_n(&refs, __ATOMIC_ACQUIRE);
+#endif
+    }
 
     String::StringUtils::BYTES String::StringUtils::newLatin1String(gint count)
     {
-        return (BYTES) newUTF16String((gint)((count + 1LL) >> 1));
+        return (BYTES) newUTF16String((gint) ((count + 1LL) >> 1));
     }
 
     String::StringUtils::BYTES String::StringUtils::newUTF16String(gint count)
     {
         if (count > 0) {
-            glong length = count;
-            if (length % 8 == 0) length += 7;
-            CHARS chars = new gchar[count + (length % 8)];
-            for (int i = 0; i < count; i += 2) {
-                chars[i] = chars[count--] = 0;
+            // header + characters + terminal null character, rounded to 8 bytes
+            glong length = 2 + ((count + 4LL) >> 2);
+            gint owner = 0;
+            glong *words = CORE_CAST(glong *, Allocator::allocateBlock(length << 3, owner));
+            for (glong i = 0; i < length; ++i) {
+                words[i] = 0;
             }
-            for (glong i = 0; i < (length % 8) / 2; ++i) {
-                chars[count + i] = '0';
+            StringHeader *header = CORE_CAST(StringHeader *, words);
+            header->refs = 1;
+            header->flags = owner << StringHeader::OWNER_SHIFT;
+            header->hash = 0;
+            header->length = (gint) (length - 2);
+            return CORE_FCAST(BYTES, header + 1);
+        }
+        return CORE_FCAST(BYTES, &EMPTY_STRING.data);
+    }
+
+    String::StringUtils::BYTES String::StringUtils::shareString(BYTES val)
+    {
+        if (val != null) {
+            StringHeader *header = headerOf(val);
+            if (header->refs >= 0) {
+                atomicIncrement(header->refs);
             }
-            return (BYTES) chars;
         }
-        EMPTY_STRING[0] = 0;
-        return (BYTES) EMPTY_STRING;
+        return val;
+    }
+
+    gbool String::StringUtils::tryShareString(BYTES val)
+    {
+        StringHeader *header = headerOf(val);
+        for (;;) {
+            gint refs = atomicLoad(header->refs);
+            if (refs < 0) {
+                // static buffer
+                return true;
+            }
+            if (refs == 0) {
+                // the last owner is releasing this buffer
+                return false;
+            }
+            if (atomicCompareAndSet(header->refs, refs, refs + 1)) {
+                return true;
+            }
+        }
+    }
+
+    gbool String::StringUtils::markInternedString(BYTES val, gint hash)
+    {
+        StringHeader *header = headerOf(val);
+        if (header->refs < 0) {
+            return false;
+        }
+        for (;;) {
+            gint flags = atomicLoad(header->flags);
+            if ((flags & StringHeader::INTERNED) != 0) {
+                // already registered, may be with other characters
+                return false;
+            }
+            if (atomicCompareAndSet(header->flags, flags, flags | StringHeader::INTERNED)) {
+                header->hash = hash;
+                return true;
+            }
+        }
+    }
+
+    gbool String::StringUtils::markSensitiveString(BYTES val)
+    {
+        StringHeader *header = headerOf(val);
+        if (header->refs < 0) {
+            // static buffers are never released
+            return false;
+        }
+        for (;;) {
+            gint flags = atomicLoad(header->flags);
+            if ((flags & StringHeader::SENSITIVE) != 0
+                || atomicCompareAndSet(header->flags, flags, flags | StringHeader::SENSITIVE)) {
+                return true;
+            }
+        }
+    }
+
+    /**
+     * Not zero if all the buffers are wiped before release, not only the sensitive ones.
+     * It is read and written atomically, since the buffers are released by any thread.
+     */
+    static gint volatile secureWipe = CORE_HAS_SECURE_WIPE != 0 ? 1 : 0;
+
+    void String::StringUtils::enableSecureWipe(gbool enabled)
+    {
+#if CORE_COMPILER_MSVC
+        _InterlockedExchange(CORE_CAST(long volatile *, &secureWipe), enabled ? 1 : 0);
+#else
+        __atomic_store_n(&secureWipe, enabled ? 1 : 0, __ATOMIC_RELEASE);
+#endif
+    }
+
+    gbool String::StringUtils::isSecureWipeEnabled()
+    {
+        return atomicLoad(secureWipe) != 0;
+    }
+
+    void String::StringUtils::wipeString(BYTES val, glong size)
+    {
+        // The stores must survive the dead store elimination, since
+        // the buffer is released just after.
+#if CORE_COMPILER_MSVC && (defined(_M_X64) || defined(_M_IX86))
+        __stosb(CORE_CAST(unsigned char *, val), 0, (misc::__memory_size_t) size);
+#elif CORE_COMPILER_MSVC
+        gbyte volatile *bytes = val;
+        for (glong i = 0; i < size; ++i) {
+            bytes[i] = 0;
+        }
+#else
+        __builtin_memset(val, 0, (misc::__memory_size_t) size);
+        __asm__ __volatile__("" : : "r"(val) : "memory");
+#endif
+    }
+
+    gbool String::StringUtils::isSharedString(BYTES val)
+    {
+        // The interned strings are shared with the intern table
+        return val == null
+               || atomicLoad(headerOf(val)->refs) != 1
+               || (atomicLoad(headerOf(val)->flags) & StringHeader::INTERNED) != 0;
+    }
+
+    glong String::StringUtils::capacityOfString(BYTES val)
+    {
+        return val == null ? 0 : (glong) headerOf(val)->length << 3;
     }
 
     gchar String::StringUtils::readLatin1CharAt(BYTES val, gint index)
     {
-        return val[index];
+        return (gchar) (val[index] & 0xff);
     }
 
     gchar String::StringUtils::readLatin1CharAt(BYTES val, gint index, gint count)
     {
-        return val[index];
+        return (gchar) (val[index] & 0xff);
     }
 
     gchar String::StringUtils::readUTF16CharAt(BYTES val, gint index)
     {
-        return ((val[index] & 0xff) << 8) | (val[index] & 0xff);
+        CHARS chars = CORE_FCAST(CHARS, val);
+        return chars[index];
     }
 
     gchar String::StringUtils::readUTF16CharAt(BYTES val, gint index, gint count)
     {
-        return ((val[index] & 0xff) << 8) | (val[index] & 0xff);
+        CHARS chars = CORE_FCAST(CHARS, val);
+        return chars[index];
     }
 
     gchar String::StringUtils::readLatin1CodePointAt(BYTES val, gint index)
@@ -342,52 +478,60 @@ namespace core
     String::StringUtils::BYTES String::StringUtils::inflateUTF16ToLatin1(CHARS val, gint off, gint count)
     {
         BYTES bytes = newLatin1String(count);
-        for (int i = 0; i < count; ++i) {
-            if ((val[i] >> 8) != 0) {
-                destroyLatin1String(bytes, count);
-                bytes = (BYTES) EMPTY_STRING;
-                return null;
-            }
-            else {
-                bytes[i] = (gbyte) (val[off++] & 0xff);
-            }
+        if (StringKernels::compressUTF16(val + off, bytes, count) < count) {
+            destroyLatin1String(bytes, count);
+            return null;
         }
         return bytes;
     }
 
     String::StringUtils::BYTES String::StringUtils::inflateUTF32ToLatin1(INTS val, gint off, gint count)
     {
-        BYTES bytes = newLatin1String(count);
-        for (int i = 0; i < count; ++i) {
-            if (((val[i] + 0u) >> 8) != 0) {
-                destroyLatin1String(bytes, count);
-                bytes = (BYTES) EMPTY_STRING;
-                return null;
-            }
-            else {
-                bytes[i] = (gbyte) (val[off++] & 0xff);
-            }
+        gbool latin1 = true;
+        StringKernels::utf16Length(val + off, count, latin1);
+        if (!latin1) {
+            return null;
         }
+        BYTES bytes = newLatin1String(count);
+        StringKernels::fromCodePoints(val + off, count, bytes);
         return bytes;
     }
 
     void String::StringUtils::destroyLatin1String(BYTES &val, gint count)
     {
-        if (val != (BYTES) EMPTY_STRING) {
-            if (val[0] != 0) {
-                fillLatin1String(val, 0, count, 0);
+        if (val != null) {
+            StringHeader *header = headerOf(val);
+            if (header->refs >= 0 && atomicDecrement(header->refs) == 0) {
+                if ((header->flags & StringHeader::INTERNED) != 0) {
+                    // weak entry of the intern table
+                    StringTable::remove(val, header->hash);
+                }
+                if (isSecureWipeEnabled() || (header->flags & StringHeader::SENSITIVE) != 0) {
+                    wipeString(val, (glong) header->length << 3);
+                }
+                Allocator::releaseBlock(header, (header->length + 2LL) << 3,
+                                        (header->flags & StringHeader::OWNER) >> StringHeader::OWNER_SHIFT);
             }
-            delete[] val;
+            val = CORE_FCAST(BYTES, &EMPTY_STRING.data);
         }
     }
 
     void String::StringUtils::destroyUTF16String(BYTES &val, gint count)
     {
-        if (val != (BYTES) EMPTY_STRING) {
-            if (val[0] != 0) {
-                fillUTF16String(val, 0, count, 0);
+        if (val != null) {
+            StringHeader *header = headerOf(val);
+            if (header->refs >= 0 && atomicDecrement(header->refs) == 0) {
+                if ((header->flags & StringHeader::INTERNED) != 0) {
+                    // weak entry of the intern table
+                    StringTable::remove(val, header->hash);
+                }
+                if (isSecureWipeEnabled() || (header->flags & StringHeader::SENSITIVE) != 0) {
+                    wipeString(val, (glong) header->length << 3);
+                }
+                Allocator::releaseBlock(header, (header->length + 2LL) << 3,
+                                        (header->flags & StringHeader::OWNER) >> StringHeader::OWNER_SHIFT);
             }
-            delete[] val;
+            val = CORE_FCAST(BYTES, &EMPTY_STRING.data);
         }
     }
 
@@ -466,64 +610,98 @@ namespace core
         return Character::isSupplementary(codePoint);
     }
 
-    CORE_ALIAS(LONGS, Class< glong >::Pointer);
-
     gint String::StringUtils::compareToLatin1(BYTES val1, gint off1, BYTES val2, gint off2, gint count)
     {
-        gint i = 0;
-        if (count > 7) {
-            LONGS lhs = CORE_FCAST(LONGS, val1 + off1);
-            LONGS rhs = CORE_FCAST(LONGS, val2 + off2);
-            gint n = count >> 3;
-            for (; i < n; ++i) {
-                if (lhs[i] != rhs[i])
-                    break;
-            }
-            i = i << 3;
-        }
-        for (; i < count; ++i) {
-            if (val1[off1 + i] != val2[off2 + i])
-                return val1[off1 + i] - val2[off2 + i];
-        }
-        return 0;
+        gint i = StringKernels::mismatch(val1 + off1, val2 + off2, count);
+        if (i < 0)
+            return 0;
+        return readLatin1CharAt(val1, off1 + i) - readLatin1CharAt(val2, off2 + i);
     }
 
     gint String::StringUtils::compareToUTF16(BYTES val1, gint off1, BYTES val2, gint off2, gint count)
     {
-        gint i = 0;
-        if (count > 7) {
-            LONGS lhs = CORE_FCAST(LONGS, val1 + off1);
-            LONGS rhs = CORE_FCAST(LONGS, val2 + off2);
-            gint n = count >> 3;
-            for (; i < n; ++i) {
-                if (lhs[i] != rhs[i])
-                    break;
-            }
-            i = i << 2;
-        }
         CHARS lhs = CORE_FCAST(CHARS, val1);
         CHARS rhs = CORE_FCAST(CHARS, val2);
-        for (; i < count; ++i) {
-            if (lhs[off1 + i] != rhs[off2 + i])
-                return lhs[off1 + i] - rhs[off2 + i];
-        }
-        return 0;
+        gint i = StringKernels::mismatch(lhs + off1, rhs + off2, count);
+        if (i < 0)
+            return 0;
+        return lhs[off1 + i] - rhs[off2 + i];
     }
 
     gint String::StringUtils::compareUTF16ToLatin1(BYTES val1, gint off1, BYTES val2, gint off2, gint count)
     {
-        for (int i = 0; i < count; ++i) {
-            gchar c1 = readUTF16CharAt(val1, i + off1);
-            gchar c2 = readLatin1CharAt(val2, i + off2);
+        // The latin1 characters are widened in the registers, none of the strings is inflated
+        CHARS lhs = CORE_FCAST(CHARS, val1);
+        gint i = StringKernels::mismatch(lhs + off1, val2 + off2, count);
+        if (i < 0)
+            return 0;
+        return lhs[off1 + i] - readLatin1CharAt(val2, off2 + i);
+    }
+
+    gint String::StringUtils::compareLatin1ToUTF16(BYTES val1, gint off1, BYTES val2, gint off2, gint count)
+    {
+        return -compareUTF16ToLatin1(val2, off2, val1, off1, count);
+    }
+
+    /**
+     * The case insensitive comparisons compare the characters converted to
+     * upper case then to lower case. The latin1 letters are folded by the
+     * kernels, the case mapping tables are used only for the characters found
+     * different by them.
+     */
+    static gint foldCase(gbyte ch)
+    {
+        return Character::toLowerCase(Character::toUpperCase(ch & 0xFF));
+    }
+
+    static gint foldCase(gchar ch)
+    {
+        return Character::toLowerCase(Character::toUpperCase((gint) ch));
+    }
+
+    template<class T, class U>
+    static gint compareIgnoreCase(T *lhs, U *rhs, gint count)
+    {
+        gint i = 0;
+        while (i < count) {
+            gint j = StringKernels::mismatchIgnoreCase(lhs + i, rhs + i, count - i);
+            if (j < 0)
+                return 0;
+            i += j;
+            gint c1 = foldCase(lhs[i]);
+            gint c2 = foldCase(rhs[i]);
             if (c1 != c2)
                 return c1 - c2;
+            i += 1;
         }
         return 0;
     }
 
-    gint String::StringUtils::compareLatin1ToUTF16(BYTES val1, gint off1, BYTES val2, gint off2, gint count)
+    gint String::StringUtils::compareToIgnoreCaseLatin1(BYTES val1, gint off1, BYTES val2, gint off2, gint count)
     {
-        return -compareUTF16ToLatin1(val2, off2, val1, off1, count);
+        // The latin1 characters folded alike by the kernel are equal ignoring case
+        gint i = StringKernels::mismatchIgnoreCase(val1 + off1, val2 + off2, count);
+        if (i < 0)
+            return 0;
+        return foldCase(val1[off1 + i]) - foldCase(val2[off2 + i]);
+    }
+
+    gint String::StringUtils::compareToIgnoreCaseUTF16(BYTES val1, gint off1, BYTES val2, gint off2, gint count)
+    {
+        CHARS lhs = CORE_FCAST(CHARS, val1);
+        CHARS rhs = CORE_FCAST(CHARS, val2);
+        return compareIgnoreCase(lhs + off1, rhs + off2, count);
+    }
+
+    gint String::StringUtils::compareUTF16ToLatin1IgnoreCase(BYTES val1, gint off1, BYTES val2, gint off2, gint count)
+    {
+        CHARS lhs = CORE_FCAST(CHARS, val1);
+        return compareIgnoreCase(lhs + off1, val2 + off2, count);
+    }
+
+    gint String::StringUtils::compareLatin1ToUTF16IgnoreCase(BYTES val1, gint off1, BYTES val2, gint off2, gint count)
+    {
+        return -compareUTF16ToLatin1IgnoreCase(val2, off2, val1, off1, count);
     }
 
     gint String::StringUtils::readUTF32CharAt(String::BYTES val, gint index)
@@ -592,40 +770,8 @@ namespace core
         count1 = Math::max(count1, 0);
         count2 = Math::max(count2, 0);
 
-        gint count = count1 - count2;
-
-        if (count2 > count1) {
-            return -1;
-        }
-
-        if (count2 == 0) {
-            return off1;
-        }
-
-        gchar c2 = readLatin1CharAt(val2, off2);
-
-        for (int i = 0; i < count; ++i) {
-            gchar c1 = readLatin1CharAt(val1, i + off1);
-            // Look for first character.
-            if (c1 != c2) {
-                continue;
-            }
-            // Found first character, now look at the rest of value
-            gint j = i + 1;
-            for (int k = 1; k < count2; ++k, ++j) {
-                c1 = readLatin1CharAt(val1, j + off1);
-                c2 = readLatin1CharAt(val2, k + off2);
-                if (c1 != c2) {
-                    break;
-                }
-            }
-
-            if (j == i + count2) {
-                // Found whole string.
-                return i + off1;
-            }
-        }
-        return -1;
+        gint index = StringKernels::indexOf(val1 + off1, count1, val2 + off2, count2);
+        return index < 0 ? -1 : index + off1;
     }
 
     gint String::StringUtils::indexOfLatin1$UTF16(String::BYTES val1, gint off1, String::BYTES val2, gint off2,
@@ -636,40 +782,10 @@ namespace core
         count1 = Math::max(count1, 0);
         count2 = Math::max(count2, 0);
 
-        gint count = count1 - count2;
-
-        if (count2 > count1) {
-            return -1;
-        }
-
-        if (count2 == 0) {
-            return off1;
-        }
-
-        gchar c2 = readLatin1CharAt(val2, off2);
-
-        for (int i = 0; i < count; ++i) {
-            gchar c1 = readUTF16CharAt(val1, i + off1);
-            // Look for first character.
-            if (c1 != c2) {
-                continue;
-            }
-            // Found first character, now look at the rest of value
-            gint j = i + 1;
-            for (int k = 1; k < count2; ++k, ++j) {
-                c1 = readUTF16CharAt(val1, j + off1);
-                c2 = readLatin1CharAt(val2, k + off2);
-                if (c1 != c2) {
-                    break;
-                }
-            }
+        CHARS chars1 = CORE_FCAST(CHARS, val1);
 
-            if (j == i + count2) {
-                // Found whole string.
-                return i + off1;
-            }
-        }
-        return -1;
+        gint index = StringKernels::indexOf(chars1 + off1, count1, val2 + off2, count2);
+        return index < 0 ? -1 : index + off1;
     }
 
     gint String::StringUtils::indexOfUTF16(String::BYTES val1, gint off1, String::BYTES val2, gint off2, gint count1,
@@ -680,175 +796,52 @@ namespace core
         count1 = Math::max(count1, 0);
         count2 = Math::max(count2, 0);
 
-        gint count = count1 - count2;
-
-        if (count2 > count1) {
-            return -1;
-        }
-
-        if (count2 == 0) {
-            return off1;
-        }
-
-        gchar c2 = readUTF16CharAt(val2, off2);
-
-        for (int i = 0; i < count; ++i) {
-            gchar c1 = readUTF16CharAt(val1, i + off1);
-            // Look for first character.
-            if (c1 != c2) {
-                continue;
-            }
-            // Found first character, now look at the rest of value
-            gint j = i + 1;
-            for (int k = 1; k < count2; ++k, ++j) {
-                c1 = readUTF16CharAt(val1, j + off1);
-                c2 = readUTF16CharAt(val2, k + off2);
-                if (c1 != c2) {
-                    break;
-                }
-            }
+        CHARS chars1 = CORE_FCAST(CHARS, val1);
+        CHARS chars2 = CORE_FCAST(CHARS, val2);
 
-            if (j == i + count2) {
-                // Found whole string.
-                return i + off1;
-            }
-        }
-        return -1;
+        gint index = StringKernels::indexOf(chars1 + off1, count1, chars2 + off2, count2);
+        return index < 0 ? -1 : index + off1;
     }
 
     gint String::StringUtils::lastIndexOfLatin1(String::BYTES val1, gint off1, String::BYTES val2, gint off2,
                                                 gint count1, gint count2)
     {
-        count1 = Math::max(count1, 0);
-        count2 = Math::max(count2, 0);
-
         off1 = Math::max(off1, 0);
         off2 = Math::max(off2, 0);
+        count1 = Math::max(count1, 0);
+        count2 = Math::max(count2, 0);
 
-        gint count = count1 - count2;
-
-        if (count1 < count2) {
-            return -1;
-        }
-
-        if (count2 == 0) {
-            return off1;
-        }
-
-        gchar c2 = readLatin1CharAt(val2, off2);
-
-        for (int i = 0; i < count; ++i) {
-            gchar c1 = readLatin1CharAt(val1, -i + off1);
-            // Look for first character.
-            if (c1 != c2) {
-                continue;
-            }
-            // Found first character, now look at the rest of value
-            gint j = i + 1;
-            for (int k = 1; k < count2; ++k, ++j) {
-                c1 = readLatin1CharAt(val1, -j + off1);
-                c2 = readLatin1CharAt(val2, -k + off2);
-                if (c1 != c2) {
-                    break;
-                }
-            }
-
-            if (j == i + count2) {
-                // Found whole string.
-                return -j + off1;
-            }
-        }
-        return -1;
+        gint index = StringKernels::lastIndexOf(val1 + off1, count1, val2 + off2, count2);
+        return index < 0 ? -1 : index + off1;
     }
 
     gint String::StringUtils::lastIndexOfLatin1$UTF16(String::BYTES val1, gint off1, String::BYTES val2, gint off2,
                                                       gint count1, gint count2)
     {
-        count1 = Math::max(count1, 0);
-        count2 = Math::max(count2, 0);
-
         off1 = Math::max(off1, 0);
         off2 = Math::max(off2, 0);
+        count1 = Math::max(count1, 0);
+        count2 = Math::max(count2, 0);
 
-        gint count = count1 - count2;
-
-        if (count1 < count2) {
-            return -1;
-        }
-
-        if (count2 == 0) {
-            return off1;
-        }
-
-        gchar c2 = readLatin1CharAt(val2, off2);
-
-        for (int i = 0; i < count; ++i) {
-            gchar c1 = readUTF16CharAt(val1, -i + off1);
-            // Look for first character.
-            if (c1 != c2) {
-                continue;
-            }
-            // Found first character, now look at the rest of value
-            gint j = i + 1;
-            for (int k = 1; k < count2; ++k, ++j) {
-                c1 = readUTF16CharAt(val1, -j + off1);
-                c2 = readLatin1CharAt(val2, -k + off2);
-                if (c1 != c2) {
-                    break;
-                }
-            }
+        CHARS chars1 = CORE_FCAST(CHARS, val1);
 
-            if (j == i + count2) {
-                // Found whole string.
-                return -j + off1;
-            }
-        }
-        return -1;
+        gint index = StringKernels::lastIndexOf(chars1 + off1, count1, val2 + off2, count2);
+        return index < 0 ? -1 : index + off1;
     }
 
     gint String::StringUtils::lastIndexOfUTF16(String::BYTES val1, gint off1, String::BYTES val2, gint off2,
                                                gint count1, gint count2)
     {
-        count1 = Math::max(count1, 0);
-        count2 = Math::max(count2, 0);
-
         off1 = Math::max(off1, 0);
         off2 = Math::max(off2, 0);
+        count1 = Math::max(count1, 0);
+        count2 = Math::max(count2, 0);
 
-        gint count = count1 - count2;
-
-        if (count1 < count2) {
-            return -1;
-        }
-
-        if (count2 == 0) {
-            return off1;
-        }
-
-        gchar c2 = readUTF16CharAt(val2, off2);
-
-        for (int i = 0; i < count; ++i) {
-            gchar c1 = readUTF16CharAt(val1, -i + off1);
-            // Look for first character.
-            if (c1 != c2) {
-                continue;
-            }
-            // Found first character, now look at the rest of value
-            gint j = i + 1;
-            for (int k = 1; k < count2; ++k, ++j) {
-                c1 = readUTF16CharAt(val1, -j + off1);
-                c2 = readUTF16CharAt(val2, -k + off2);
-                if (c1 != c2) {
-                    break;
-                }
-            }
+        CHARS chars1 = CORE_FCAST(CHARS, val1);
+        CHARS chars2 = CORE_FCAST(CHARS, val2);
 
-            if (j == i + count2) {
-                // Found whole string.
-                return -j + off1;
-            }
-        }
-        return -1;
+        gint index = StringKernels::lastIndexOf(chars1 + off1, count1, chars2 + off2, count2);
+        return index < 0 ? -1 : index + off1;
     }
 
     gint String::StringUtils::numberOfLatin1CodePoints(String::BYTES val, gint off, gint count)
@@ -863,70 +856,46 @@ namespace core
     {
         off = Math::max(off, 0);
         count = Math::max(count, 0);
-        gint number = 0;
-
-        for (int i = 0; i < count - 1; ++i) {
-            gchar c1 = readUTF16CharAt(val, i);
-            if (Character::isHighSurrogate(c1)) {
-                gchar c2 = readLatin1CharAt(val, i + 1);
-                if (Character::isLowSurrogate(c2)) {
-                    number += 2;
-                    i += 1;
-                    continue;
-                }
-            }
-            number += 1;
-        }
+        CHARS chars = CORE_FCAST(CHARS, val);
 
-        return number;
+        return StringKernels::codePointCount(chars + off, count);
     }
 
     gint String::StringUtils::hashLatin1String(String::BYTES val, gint off, gint count)
     {
-        gint hash = 0;
-        for (int i = 0, n = count; i < count; ++i, --n) {
-            gchar c = readLatin1CharAt(val, i + off);
-            hash = (hash * 31) ^ (n - 1);
-        }
-        return hash;
+        return StringKernels::hash(val + off, count, 0);
     }
 
     gint String::StringUtils::hashUTF16String(String::BYTES val, gint off, gint count)
     {
-        gint hash = 0;
-        for (int i = 0, n = count; i < count; ++i, --n) {
-            gchar c = readUTF16CharAt(val, i + off);
-            hash = (hash * 31) ^ (n - 1);
-        }
-        return hash;
+        CHARS chars = CORE_FCAST(CHARS, val);
+        return hashUTF16String(chars, off, count);
     }
 
     gint String::StringUtils::hashUTF16String(String::CHARS val, gint off, gint count)
     {
-        gint hash = 0;
-        for (int i = 0, n = count; i < count; ++i, --n) {
-            gchar c = val[i + off];
-            hash = (hash * 31) ^ (n - 1);
-        }
-        return hash;
+        return StringKernels::hash(val + off, count, 0);
     }
 
     gint String::StringUtils::hashUTF32String(String::BYTES val, gint off, gint count)
     {
-        gint hash = 0;
-        for (int i = 0, n = count; i < count; ++i, --n) {
-            gchar c = readUTF32CharAt(val, i + off);
-            hash = (hash * 31) ^ (n - 1);
-        }
-        return hash;
+        INTS codePoints = CORE_FCAST(INTS, val);
+        return hashUTF32String(codePoints, off, count);
     }
 
     gint String::StringUtils::hashUTF32String(String::INTS val, gint off, gint count)
     {
+        // Same as the hash of the utf16 representation
         gint hash = 0;
-        for (int i = 0, n = count; i < count; ++i, --n) {
-            gchar c = val[i + off];
-            hash = (hash * 31) ^ (n - 1);
+        for (int i = 0; i < count; ++i) {
+            gint cp = val[i + off];
+            if (isSupplementary(cp)) {
+                hash = hash * 31 + highSurrogate(cp);
+                hash = hash * 31 + lowSurrogate(cp);
+            }
+            else {
+                hash = hash * 31 + (gchar) cp;
+            }
         }
         return hash;
     }
@@ -940,20 +909,12 @@ namespace core
             return -1;
         }
 
-        for (int i = 0; i < count; ++i) {
-            gchar c1 = readLatin1CharAt(val, i + off);
-            if (c1 == c2) {
-                return i + off;
-            }
-        }
-        return -1;
+        gint index = StringKernels::indexOf(val + off, count, c2);
+        return index < 0 ? -1 : index + off;
     }
 
     gint String::StringUtils::indexOfLatin1(String::BYTES val, gint off, gint c2, gint count)
     {
-        off = Math::max(off, 0);
-        count = Math::max(count, 0);
-
         if (!isLatin1(c2)) {
             return -1;
         }
@@ -966,62 +927,41 @@ namespace core
         off = Math::max(off, 0);
         count = Math::max(count, 0);
 
-        for (int i = 0; i < count; ++i) {
-            gchar c1 = readUTF16CharAt(val, i + off);
-            if (c1 == c2) {
-                return i + off;
-            }
-        }
-        return -1;
+        CHARS chars = CORE_FCAST(CHARS, val);
+        gint index = StringKernels::indexOf(chars + off, count, c2);
+        return index < 0 ? -1 : index + off;
     }
 
     gint String::StringUtils::indexOfUTF16(String::BYTES val, gint off, gint c2, gint count)
     {
-        off = Math::max(off, 0);
-        count = Math::max(count, 0);
-
         if (Character::isBmpCodePoint(c2)) {
             return indexOfUTF16(val, off, (gchar) c2, count);
         }
 
-        for (int i = 0; i < count - 1; ++i) {
-            gchar c11 = readUTF16CharAt(val, i + off);
-            if (Character::isHighSurrogate(c11)) {
-                gchar c12 = readUTF16CharAt(val, i + 1 + off);
-                if (Character::isLowSurrogate(c12)) {
-                    gint c1 = Character::toCodePoint(c11, c12);
-                    if (c1 == c2) {
-                        return i + off;
-                    }
-                }
-            }
+        if (!Character::isValidCodePoint(c2)) {
+            return -1;
         }
-        return -1;
+
+        // The supplementary characters are searched as surrogate pairs
+        gchar pair[2] = {highSurrogate(c2), lowSurrogate(c2)};
+        return indexOfUTF16(val, off, CORE_FCAST(BYTES, pair), 0, count, 2);
     }
 
     gint String::StringUtils::lastIndexOfLatin1(String::BYTES val, gint off, gchar c2, gint count)
     {
+        off = Math::max(off, 0);
         count = Math::max(count, 0);
-        off = Math::clamp(off, 0, count);
 
         if (!isLatin1(c2)) {
             return -1;
         }
 
-        for (int i = off; i > 0; --i) {
-            gchar c1 = readLatin1CharAt(val, i);
-            if (c1 == c2) {
-                return i + off;
-            }
-        }
-        return -1;
+        gint index = StringKernels::lastIndexOf(val + off, count, c2);
+        return index < 0 ? -1 : index + off;
     }
 
     gint String::StringUtils::lastIndexOfLatin1(String::BYTES val, gint off, gint c2, gint count)
     {
-        count = Math::max(count, 0);
-        off = Math::clamp(off, 0, count);
-
         if (!isLatin1(c2)) {
             return -1;
         }
@@ -1031,38 +971,147 @@ namespace core
 
     gint String::StringUtils::lastIndexOfUTF16(String::BYTES val, gint off, gchar c2, gint count)
     {
+        off = Math::max(off, 0);
         count = Math::max(count, 0);
-        off = Math::clamp(off, 0, count);
 
-        for (int i = off; i > 0; --i) {
-            gchar c1 = readUTF16CharAt(val, i);
-            if (c1 == c2) {
-                return i + off;
-            }
-        }
-        return -1;
+        CHARS chars = CORE_FCAST(CHARS, val);
+        gint index = StringKernels::lastIndexOf(chars + off, count, c2);
+        return index < 0 ? -1 : index + off;
     }
 
     gint String::StringUtils::lastIndexOfUTF16(String::BYTES val, gint off, gint c2, gint count)
     {
-        count = Math::max(count, 0);
-        off = Math::clamp(off, 0, count);
-
         if (Character::isBmpCodePoint(c2)) {
             return lastIndexOfUTF16(val, off, (gchar) c2, count);
         }
 
-        for (int i = off; i > 1; --i) {
-            gchar c11 = readUTF16CharAt(val, i);
-            if (Character::isHighSurrogate(c11)) {
-                gchar c12 = readUTF16CharAt(val, i + 1);
-                if (Character::isLowSurrogate(c12)) {
-                    gint c1 = Character::toCodePoint(c11, c12);
-                    if (c1 == c2) {
-                        return i;
-                    }
-                }
-            }
+        if (!Character::isValidCodePoint(c2)) {
+            return -1;
+        }
+
+        // The supplementary characters are searched as surrogate pairs
+        gchar pair[2] = {highSurrogate(c2), lowSurrogate(c2)};
+        return lastIndexOfUTF16(val, off, CORE_FCAST(BYTES, pair), 0, count, 2);
+    }
+
+    gint String::StringUtils::indexOfAnyLatin1(BYTES val1, gint off1, BYTES val2, gint off2, gint count1, gint count2)
+    {
+        off1 = Math::max(off1, 0);
+        off2 = Math::max(off2, 0);
+        count1 = Math::max(count1, 0);
+        count2 = Math::max(count2, 0);
+
+        gint index = StringKernels::indexOfAny(val1 + off1, count1, val2 + off2, count2);
+        return index < 0 ? -1 : index + off1;
+    }
+
+    gint String::StringUtils::indexOfAnyLatin1$UTF16(BYTES val1, gint off1, BYTES val2, gint off2, gint count1,
+                                                     gint count2)
+    {
+        off1 = Math::max(off1, 0);
+        off2 = Math::max(off2, 0);
+        count1 = Math::max(count1, 0);
+        count2 = Math::max(count2, 0);
+
+        CHARS chars1 = CORE_FCAST(CHARS, val1);
+        gint index = StringKernels::indexOfAny(chars1 + off1, count1, val2 + off2, count2);
+        return index < 0 ? -1 : index + off1;
+    }
+
+    gint String::StringUtils::indexOfAnyUTF16(BYTES val1, gint off1, BYTES val2, gint off2, gint count1, gint count2)
+    {
+        off1 = Math::max(off1, 0);
+        off2 = Math::max(off2, 0);
+        count1 = Math::max(count1, 0);
+        count2 = Math::max(count2, 0);
+
+        CHARS chars1 = CORE_FCAST(CHARS, val1);
+        CHARS chars2 = CORE_FCAST(CHARS, val2);
+        gint index = StringKernels::indexOfAny(chars1 + off1, count1, chars2 + off2, count2);
+        return index < 0 ? -1 : index + off1;
+    }
+
+    gint String::StringUtils::indexOfAnyUTF16$Latin1(BYTES val1, gint off1, BYTES val2, gint off2, gint count1,
+                                                     gint count2)
+    {
+        off1 = Math::max(off1, 0);
+        off2 = Math::max(off2, 0);
+        count1 = Math::max(count1, 0);
+        count2 = Math::max(count2, 0);
+
+        CHARS chars2 = CORE_FCAST(CHARS, val2);
+        gint index = StringKernels::indexOfAny(val1 + off1, count1, chars2 + off2, count2);
+        return index < 0 ? -1 : index + off1;
+    }
+
+    gint String::StringUtils::indexOfNonSpaceLatin1(BYTES val, gint off, gint count)
+    {
+        gint index = StringKernels::indexOfNonSpace(val + off, count);
+        return index < 0 ? -1 : index + off;
+    }
+
+    gint String::StringUtils::indexOfNonSpaceUTF16(BYTES val, gint off, gint count)
+    {
+        CHARS chars = CORE_FCAST(CHARS, val);
+        gint index = StringKernels::indexOfNonSpace(chars + off, count);
+        return index < 0 ? -1 : index + off;
+    }
+
+    gint String::StringUtils::lastIndexOfNonSpaceLatin1(BYTES val, gint off, gint count)
+    {
+        gint index = StringKernels::lastIndexOfNonSpace(val + off, count);
+        return index < 0 ? -1 : index + off;
+    }
+
+    gint String::StringUtils::lastIndexOfNonSpaceUTF16(BYTES val, gint off, gint count)
+    {
+        CHARS chars = CORE_FCAST(CHARS, val);
+        gint index = StringKernels::lastIndexOfNonSpace(chars + off, count);
+        return index < 0 ? -1 : index + off;
+    }
+
+    gint String::StringUtils::indexOfNonWhitespaceLatin1(BYTES val, gint off, gint count)
+    {
+        // All the latin1 whitespaces are ascii
+        gint index = StringKernels::indexOfNonWhitespace(val + off, count);
+        return index < 0 ? -1 : index + off;
+    }
+
+    gint String::StringUtils::indexOfNonWhitespaceUTF16(BYTES val, gint off, gint count)
+    {
+        CHARS chars = CORE_FCAST(CHARS, val);
+        gint i = off;
+        gint end = off + count;
+        while (i < end) {
+            gint index = StringKernels::indexOfNonWhitespace(chars + i, end - i);
+            if (index < 0)
+                return -1;
+            i += index;
+            // The characters above 0x7F are classified by the tables
+            if (!Character::isWhitespace(chars[i]))
+                return i;
+            i += 1;
+        }
+        return -1;
+    }
+
+    gint String::StringUtils::lastIndexOfNonWhitespaceLatin1(BYTES val, gint off, gint count)
+    {
+        gint index = StringKernels::lastIndexOfNonWhitespace(val + off, count);
+        return index < 0 ? -1 : index + off;
+    }
+
+    gint String::StringUtils::lastIndexOfNonWhitespaceUTF16(BYTES val, gint off, gint count)
+    {
+        CHARS chars = CORE_FCAST(CHARS, val);
+        gint end = off + count;
+        while (end > off) {
+            gint index = StringKernels::lastIndexOfNonWhitespace(chars + off, end - off);
+            if (index < 0)
+                return -1;
+            end = off + index;
+            if (!Character::isWhitespace(chars[end]))
+                return end;
         }
         return -1;
     }
@@ -1083,6 +1132,9 @@ namespace core
 
     void String::StringUtils::copyUTF32ToUTF16(String::INTS val1, gint off1, String::BYTES val2, gint off2, gint count)
     {
-        //
+        if (count > 0) {
+            CHARS chars = CORE_FCAST(CHARS, val2);
+            StringKernels::fromCodePoints(val1 + off1, count, chars + off2);
+        }
     }
 } // core
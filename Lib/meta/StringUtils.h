@@ -68,10 +68,30 @@ namespace core
 
         static BYTES copyOfUTF32ToUTF16(INTS val, gint off, gint count, gint &length);
 
+        static BYTES copyOfUTF32(INTS val, gint off, gint count, Coder &coder, gint &length);
+
         static BYTES newLatin1String(gint count);
 
         static BYTES newUTF16String(gint count);
 
+        static BYTES shareString(BYTES val);
+
+        static gbool tryShareString(BYTES val);
+
+        static gbool markInternedString(BYTES val, gint hash);
+
+        static gbool markSensitiveString(BYTES val);
+
+        static void enableSecureWipe(gbool enabled);
+
+        static gbool isSecureWipeEnabled();
+
+        static void wipeString(BYTES val, glong size);
+
+        static gbool isSharedString(BYTES val);
+
+        static glong capacityOfString(BYTES val);
+
         static gchar readLatin1CharAt(BYTES val, gint index);
 
         static gchar readLatin1CharAt(BYTES val, gint index, gint count);
@@ -130,6 +150,14 @@ namespace core
 
         static gint compareLatin1ToUTF16(BYTES val1, gint off1, BYTES val2, gint off2, gint count);
 
+        static gint compareToIgnoreCaseLatin1(BYTES val1, gint off1, BYTES val2, gint off2, gint count);
+
+        static gint compareToIgnoreCaseUTF16(BYTES val1, gint off1, BYTES val2, gint off2, gint count);
+
+        static gint compareUTF16ToLatin1IgnoreCase(BYTES val1, gint off1, BYTES val2, gint off2, gint count);
+
+        static gint compareLatin1ToUTF16IgnoreCase(BYTES val1, gint off1, BYTES val2, gint off2, gint count);
+
         static gint readUTF32CharAt(BYTES val, gint index);
 
         static gint readUTF32CharAt(BYTES val, gint index, gint count);
@@ -184,6 +212,30 @@ namespace core
 
         static gint lastIndexOfUTF16(BYTES val, gint off, gint c, gint count);
 
+        static gint indexOfAnyLatin1(BYTES val1, gint off1, BYTES val2, gint off2, gint count1, gint count2);
+
+        static gint indexOfAnyLatin1$UTF16(BYTES val1, gint off1, BYTES val2, gint off2, gint count1, gint count2);
+
+        static gint indexOfAnyUTF16(BYTES val1, gint off1, BYTES val2, gint off2, gint count1, gint count2);
+
+        static gint indexOfAnyUTF16$Latin1(BYTES val1, gint off1, BYTES val2, gint off2, gint count1, gint count2);
+
+        static gint indexOfNonSpaceLatin1(BYTES val, gint off, gint count);
+
+        static gint indexOfNonSpaceUTF16(BYTES val, gint off, gint count);
+
+        static gint lastIndexOfNonSpaceLatin1(BYTES val, gint off, gint count);
+
+        static gint lastIndexOfNonSpaceUTF16(BYTES val, gint off, gint count);
+
+        static gint indexOfNonWhitespaceLatin1(BYTES val, gint off, gint count);
+
+        static gint indexOfNonWhitespaceUTF16(BYTES val, gint off, gint count);
+
+        static gint lastIndexOfNonWhitespaceLatin1(BYTES val, gint off, gint count);
+
+        static gint lastIndexOfNonWhitespaceUTF16(BYTES val, gint off, gint count);
+
         static void shiftLatin1(BYTES val, gint off, gint n, gint count);
 
         static void shiftUTF16(BYTES val, gint off, gint n, gint count);